@@ -0,0 +1,242 @@
+#include <cstdio>
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <cstdlib>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <dirent.h>
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/Threading.h"
+#include "../common/AnalysisTools.h"
+#include "../common/OutputRedirect.h"
+#include "../common/ResultFormat.h"
+#include "../common/Stats.h"
+
+using namespace std;
+
+// One input file; output is kept until every earlier file has been written.
+// error holds what the analysis threw, if it gave up on the file.
+struct Job {
+    string path;
+    ostringstream output;
+    int status = 0;
+    string error;
+    bool done = false;
+};
+
+vector<string> collectInputs(const string &arg);
+void runWorker(
+    AnalysisEntry tool,
+    const string &toolName,
+    const vector<string> &options,
+    vector<Job> &jobs,
+    atomic<size_t> &nextJob,
+    mutex &doneMutex,
+    condition_variable &doneSignal);
+
+int main(int argc, char **argv)
+{
+    // usage: batchAnalysis <taint|difference|interval> [-j N] <input>... [-- option...]
+    // An input is an IR file, a directory of .ll/.bc files or @FILE listing
+    // one input per line. Options after -- go to the analysis of every file.
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <taint|difference|interval> [-j N] <file|dir|@list>... [-- option...]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    AnalysisEntry tool = nullptr;
+    string toolName;
+    if (strcmp(argv[1], "taint") == 0) {
+        tool = taint::runLoopAnalysis;
+        toolName = "taintLoopAnalysis";
+    } else if (strcmp(argv[1], "difference") == 0) {
+        tool = difference::runLoopAnalysis;
+        toolName = "diffLoopAnalysis";
+    } else if (strcmp(argv[1], "interval") == 0) {
+        tool = interval::runLoopAnalysis;
+        toolName = "intervalLoopAnalysis";
+    } else {
+        fprintf(stderr, "error: unknown analysis \"%s\"\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    unsigned numWorkers = thread::hardware_concurrency();
+    vector<string> inputs;
+    vector<string> options;
+    for (int i = 2; i < argc; ++i) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            numWorkers = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--") == 0) {
+            options.assign(argv + i + 1, argv + argc);
+            break;
+        } else {
+            vector<string> found = collectInputs(argv[i]);
+            inputs.insert(inputs.end(), found.begin(), found.end());
+        }
+    }
+    if (numWorkers == 0) {
+        numWorkers = 1;
+    }
+
+    // With a machine-readable format each file starts with a "file" record
+    // naming it instead of the text banner. The last --format wins, as it
+    // does in the tools.
+    ResultPrinter printer(toolName);
+    for (size_t i = 0; i + 1 < options.size(); ++i) {
+        if (options[i] == "--format") {
+            printer.setFormat(options[i + 1].c_str());
+        }
+    }
+
+    vector<Job> jobs(inputs.size());
+    for (unsigned i = 0; i < inputs.size(); ++i) {
+        jobs[i].path = inputs[i];
+    }
+
+#if LLVM_VERSION_MAJOR < 4
+    if (!llvm::llvm_start_multithreaded()) {
+        fprintf(stderr, "error: LLVM was built without thread support\n");
+        return EXIT_FAILURE;
+    }
+#endif
+
+    // From here on cout goes wherever the writing thread points it.
+    streambuf *stdoutBuf = cout.rdbuf(&threadOutput());
+    redirectOutput(stdoutBuf);
+    printer.begin();
+
+    atomic<size_t> nextJob(0);
+    mutex doneMutex;
+    condition_variable doneSignal;
+    vector<thread> workers;
+    for (unsigned i = 0; i < numWorkers && i < jobs.size(); ++i) {
+        workers.push_back(thread(runWorker, tool, cref(toolName), cref(options),
+                                 ref(jobs), ref(nextJob), ref(doneMutex), ref(doneSignal)));
+    }
+
+    // Write each file's output as soon as it and everything before it is done.
+    int failed = 0;
+    for (auto &job: jobs) {
+        {
+            unique_lock<mutex> lock(doneMutex);
+            doneSignal.wait(lock, [&job] { return job.done; });
+        }
+        if (printer.text()) {
+            cout << "=========== " << job.path << " ===========\n";
+        } else {
+            ResultItem item;
+            item.id = job.path;
+            printer.write("file", 0, vector<ResultItem>(1, item));
+        }
+        cout << job.output.str();
+        cout.flush();
+        job.output.str(string());
+        if (!job.error.empty()) {
+            fprintf(stderr, "error: %s: %s\n", job.path.c_str(), job.error.c_str());
+        }
+        if (job.status != 0) {
+            ++failed;
+        }
+    }
+
+    for (auto &worker: workers) {
+        worker.join();
+    }
+    redirectOutput(nullptr);
+    cout.rdbuf(stdoutBuf);
+
+    if (failed != 0) {
+        fprintf(stderr, "error: %d of %u files failed\n", failed, (unsigned) jobs.size());
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
+
+vector<string> collectInputs(const string &arg)
+{
+    vector<string> inputs;
+    if (arg[0] == '@') {
+        ifstream list(arg.substr(1).c_str());
+        if (!list) {
+            fprintf(stderr, "error: cannot read input list \"%s\"\n", arg.c_str() + 1);
+            exit(EXIT_FAILURE);
+        }
+        string line;
+        while (getline(list, line)) {
+            if (!line.empty()) {
+                vector<string> found = collectInputs(line);
+                inputs.insert(inputs.end(), found.begin(), found.end());
+            }
+        }
+        return inputs;
+    }
+
+    DIR *dir = opendir(arg.c_str());
+    if (dir == nullptr) {
+        inputs.push_back(arg);
+        return inputs;
+    }
+    while (struct dirent *entry = readdir(dir)) {
+        string name = entry->d_name;
+        if (name.size() > 3 && (name.compare(name.size() - 3, 3, ".ll") == 0 ||
+                                name.compare(name.size() - 3, 3, ".bc") == 0)) {
+            inputs.push_back(arg + "/" + name);
+        }
+    }
+    closedir(dir);
+    std::sort(inputs.begin(), inputs.end());
+    return inputs;
+}
+
+// Takes files off the shared counter until none are left. Each run builds
+// its own LLVMContext inside the analysis, and prints into its job. A file
+// the analysis gives up on fails alone; the worker goes on with the next.
+void runWorker(
+    AnalysisEntry tool,
+    const string &toolName,
+    const vector<string> &options,
+    vector<Job> &jobs,
+    atomic<size_t> &nextJob,
+    mutex &doneMutex,
+    condition_variable &doneSignal)
+{
+    for (size_t i = nextJob++; i < jobs.size(); i = nextJob++) {
+        Job &job = jobs[i];
+
+        vector<string> args;
+        args.push_back(toolName);
+        args.push_back(job.path);
+        args.insert(args.end(), options.begin(), options.end());
+        vector<char*> argv;
+        for (auto &arg: args) {
+            argv.push_back(&arg[0]);
+        }
+        argv.push_back(nullptr);
+
+        redirectOutput(job.output.rdbuf());
+        int status;
+        string error;
+        try {
+            status = tool(args.size(), argv.data());
+        } catch (const AnalysisError &e) {
+            status = EXIT_FAILURE;
+            error = e.what();
+            // The run left its counters pointing into its own frame.
+            activeStats() = nullptr;
+        }
+        redirectOutput(nullptr);
+
+        lock_guard<mutex> lock(doneMutex);
+        job.status = status;
+        job.error = error;
+        job.done = true;
+        doneSignal.notify_all();
+    }
+}
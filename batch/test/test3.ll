@@ -0,0 +1,19 @@
+define i32 @main(i32 %n) {
+entry:
+  %x = alloca i32
+  store i32 0, i32* %x
+  br label %loop
+
+loop:
+  %v = load i32, i32* %x
+  %cmp = icmp slt i32 %v, 10
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %inc = add i32 %v, 2
+  store i32 %inc, i32* %x
+  br label %loop
+
+exit:
+  ret i32 %v
+}
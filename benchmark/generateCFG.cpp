@@ -0,0 +1,264 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "llvm/Config/llvm-config.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/Support/raw_ostream.h"
+#if LLVM_VERSION_MAJOR >= 4
+#include "llvm/Bitcode/BitcodeWriter.h"
+#else
+#include "llvm/Bitcode/ReaderWriter.h"
+#endif
+
+using namespace llvm;
+using namespace std;
+
+// Shape of the generated module. Each function is a chain of loop nests;
+// a loop body holds the next loop down, then a chain of if/else diamonds.
+struct CFGShape {
+    int vars = 8;
+    int loops = 4;
+    int depth = 2;
+    int diamonds = 4;
+    int functions = 1;
+    int bound = 100;
+    unsigned seed = 1;
+};
+
+bool parseCount(const char *text, int minimum, int &count);
+void generateFunction(Module &M, const string &name, const CFGShape &shape, mt19937 &random);
+BasicBlock *generateLoop(
+    Function *F,
+    IRBuilder<> &builder,
+    const vector<Value*> &vars,
+    const CFGShape &shape,
+    int level,
+    const string &prefix,
+    mt19937 &random);
+BasicBlock *generateDiamond(
+    Function *F,
+    IRBuilder<> &builder,
+    const vector<Value*> &vars,
+    const string &prefix,
+    mt19937 &random);
+Value *loadVar(IRBuilder<> &builder, Value *var, const string &name);
+
+int main(int argc, char **argv)
+{
+    // usage: generateCFG [--vars N] [--loops N] [--depth N] [--diamonds N]
+    //                    [--functions N] [--bound N] [--seed N] [-o FILE]
+    // Writes textual IR, or bitcode when FILE ends in .bc, to FILE or to
+    // standard output. The functions are named main, main1, main2, ... so
+    // every analyzer picks all of them up. With --loops 0 the function is a
+    // single chain of diamonds, which the non-loop analyzers can handle.
+    CFGShape shape;
+    string outPath = "-";
+    for (int i = 1; i < argc; ++i) {
+        bool valid = i + 1 < argc;
+        if (valid && strcmp(argv[i], "--vars") == 0) {
+            valid = parseCount(argv[++i], 2, shape.vars);
+        } else if (valid && strcmp(argv[i], "--loops") == 0) {
+            valid = parseCount(argv[++i], 0, shape.loops);
+        } else if (valid && strcmp(argv[i], "--depth") == 0) {
+            valid = parseCount(argv[++i], 1, shape.depth);
+        } else if (valid && strcmp(argv[i], "--diamonds") == 0) {
+            valid = parseCount(argv[++i], 0, shape.diamonds);
+        } else if (valid && strcmp(argv[i], "--functions") == 0) {
+            valid = parseCount(argv[++i], 1, shape.functions);
+        } else if (valid && strcmp(argv[i], "--bound") == 0) {
+            valid = parseCount(argv[++i], 1, shape.bound);
+        } else if (valid && strcmp(argv[i], "--seed") == 0) {
+            int seed = 0;
+            valid = parseCount(argv[++i], 0, seed);
+            shape.seed = seed;
+        } else if (valid && strcmp(argv[i], "-o") == 0) {
+            outPath = argv[++i];
+        } else {
+            fprintf(stderr, "error: unknown option \"%s\"\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+        if (!valid) {
+            fprintf(stderr, "error: bad value \"%s\" for %s\n", argv[i], argv[i - 1]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    LLVMContext Context;
+    Module M("generated", Context);
+    mt19937 random(shape.seed);
+    for (int k = 0; k < shape.functions; ++k) {
+        generateFunction(M, k == 0 ? "main" : "main" + to_string(k), shape, random);
+    }
+
+    string contents;
+    raw_string_ostream out(contents);
+    bool bitcode = outPath.size() > 3 && outPath.compare(outPath.size() - 3, 3, ".bc") == 0;
+    if (bitcode) {
+#if LLVM_VERSION_MAJOR >= 4
+        WriteBitcodeToFile(M, out);
+#else
+        WriteBitcodeToFile(&M, out);
+#endif
+    } else {
+        M.print(out, nullptr);
+    }
+    out.flush();
+
+    if (outPath == "-") {
+        cout.write(contents.data(), contents.size());
+        return 0;
+    }
+    ofstream file(outPath.c_str(), ios::binary);
+    file.write(contents.data(), contents.size());
+    if (!file) {
+        fprintf(stderr, "error: cannot write \"%s\"\n", outPath.c_str());
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
+
+bool parseCount(const char *text, int minimum, int &count)
+{
+    char *end = nullptr;
+    long value = strtol(text, &end, 10);
+    if (*text == '\0' || *end != '\0' || value < minimum || value > 1000000) {
+        return false;
+    }
+    count = value;
+    return true;
+}
+
+// One function: the variables live in allocas, as clang -O0 leaves them.
+// The first is named source and the last sink, for the taint analyzers.
+void generateFunction(Module &M, const string &name, const CFGShape &shape, mt19937 &random)
+{
+    LLVMContext &Context = M.getContext();
+    FunctionType *type = FunctionType::get(Type::getInt32Ty(Context), false);
+    Function *F = Function::Create(type, Function::ExternalLinkage, name, &M);
+    IRBuilder<> builder(BasicBlock::Create(Context, "entry", F));
+
+    vector<Value*> vars;
+    for (int v = 0; v < shape.vars; ++v) {
+        string varName = v == 0 ? "source" : v == shape.vars - 1 ? "sink" : "v" + to_string(v);
+        vars.push_back(builder.CreateAlloca(builder.getInt32Ty(), nullptr, varName));
+    }
+    for (int v = 0; v < shape.vars; ++v) {
+        builder.CreateStore(builder.getInt32(v), vars[v]);
+    }
+
+    if (shape.loops == 0) {
+        for (int d = 0; d < shape.diamonds; ++d) {
+            generateDiamond(F, builder, vars, "d" + to_string(d), random);
+        }
+    }
+    for (int l = 0; l < shape.loops; ++l) {
+        generateLoop(F, builder, vars, shape, 1, "l" + to_string(l), random);
+    }
+
+    // Flow from source into sink, so taint reaches the end.
+    Value *tainted = loadVar(builder, vars[0], "taint");
+    builder.CreateStore(builder.CreateAdd(tainted, loadVar(builder, vars.back(), "old"), "flow"), vars.back());
+    builder.CreateRet(loadVar(builder, vars.back(), "result"));
+}
+
+// A counted loop at the builder's insertion point, nested down to the
+// requested depth; returns the exit block, where the builder is left.
+BasicBlock *generateLoop(
+    Function *F,
+    IRBuilder<> &builder,
+    const vector<Value*> &vars,
+    const CFGShape &shape,
+    int level,
+    const string &prefix,
+    mt19937 &random)
+{
+    LLVMContext &Context = F->getContext();
+    BasicBlock *preheader = builder.GetInsertBlock();
+    Value *counter = nullptr;
+    {
+        // Counters are allocas too, placed with the others in the entry.
+        IRBuilder<> entryBuilder(&F->getEntryBlock(), F->getEntryBlock().begin());
+        counter = entryBuilder.CreateAlloca(builder.getInt32Ty(), nullptr, prefix + ".i");
+    }
+    BasicBlock *header = BasicBlock::Create(Context, prefix + ".header", F);
+    BasicBlock *body = BasicBlock::Create(Context, prefix + ".body", F);
+    BasicBlock *exit = BasicBlock::Create(Context, prefix + ".exit", F);
+
+    builder.SetInsertPoint(preheader);
+    builder.CreateStore(builder.getInt32(0), counter);
+    builder.CreateBr(header);
+
+    builder.SetInsertPoint(header);
+    Value *index = loadVar(builder, counter, prefix + ".index");
+    Value *inRange = builder.CreateICmpSLT(index, builder.getInt32(shape.bound), prefix + ".cond");
+    builder.CreateCondBr(inRange, body, exit);
+
+    builder.SetInsertPoint(body);
+    if (level < shape.depth) {
+        generateLoop(F, builder, vars, shape, level + 1, prefix + ".l", random);
+    }
+    for (int d = 0; d < shape.diamonds; ++d) {
+        generateDiamond(F, builder, vars, prefix + ".d" + to_string(d), random);
+    }
+    Value *current = loadVar(builder, counter, prefix + ".current");
+    builder.CreateStore(builder.CreateAdd(current, builder.getInt32(1), prefix + ".next"), counter);
+    builder.CreateBr(header);
+
+    builder.SetInsertPoint(exit);
+    return exit;
+}
+
+// if (a > c) b = b + k; else b = b - k; with a, b, c and k drawn at random.
+// Returns the join block, where the builder is left.
+BasicBlock *generateDiamond(
+    Function *F,
+    IRBuilder<> &builder,
+    const vector<Value*> &vars,
+    const string &prefix,
+    mt19937 &random)
+{
+    LLVMContext &Context = F->getContext();
+    Value *tested = vars[random() % vars.size()];
+    Value *updated = vars[random() % vars.size()];
+    int threshold = random() % 64;
+    int step = 1 + random() % 8;
+
+    BasicBlock *thenBlock = BasicBlock::Create(Context, prefix + ".then", F);
+    BasicBlock *elseBlock = BasicBlock::Create(Context, prefix + ".else", F);
+    BasicBlock *join = BasicBlock::Create(Context, prefix + ".join", F);
+
+    Value *value = loadVar(builder, tested, prefix + ".a");
+    Value *taken = builder.CreateICmpSGT(value, builder.getInt32(threshold), prefix + ".cond");
+    builder.CreateCondBr(taken, thenBlock, elseBlock);
+
+    builder.SetInsertPoint(thenBlock);
+    Value *before = loadVar(builder, updated, prefix + ".b1");
+    builder.CreateStore(builder.CreateAdd(before, builder.getInt32(step), prefix + ".add"), updated);
+    builder.CreateBr(join);
+
+    builder.SetInsertPoint(elseBlock);
+    before = loadVar(builder, updated, prefix + ".b2");
+    builder.CreateStore(builder.CreateSub(before, builder.getInt32(step), prefix + ".sub"), updated);
+    builder.CreateBr(join);
+
+    builder.SetInsertPoint(join);
+    return join;
+}
+
+Value *loadVar(IRBuilder<> &builder, Value *var, const string &name)
+{
+#if LLVM_VERSION_MAJOR >= 4
+    return builder.CreateLoad(builder.getInt32Ty(), var, name);
+#else
+    return builder.CreateLoad(var, name);
+#endif
+}
@@ -0,0 +1,369 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include <utility>
+#include <vector>
+#include "../interval-analysis/Interval.h"
+#include "../interval-analysis/IntervalKernels.h"
+
+using namespace std;
+
+#define DEFAULT_COUNT 4096
+#define DEFAULT_ROUNDS 2000
+
+// Lanes per block of the kernels, and per leaf in the leaf join: the width
+// of an IntervalMap leaf (PERSISTENT_WIDTH).
+#define BLOCK_LANES 256
+#define LEAF_LANES 32
+
+typedef IntervalLanes<BLOCK_LANES> Block;
+
+// An IntervalMap leaf entry, with a key that is only tested for null.
+typedef pair<const void*, Interval64> Entry;
+
+// One operation measured both ways: on a vector of Interval64s and with
+// its kernel on the same intervals in blocks of lanes.
+struct KernelCase {
+    const char *name;
+    void (*scalar)(vector<Interval64> &out, const vector<Interval64> &a, const vector<Interval64> &b);
+    void (*kernel)(const Block &a, const Block &b, Block &out);
+};
+
+vector<Interval64> randomIntervals(size_t count, mt19937 &random);
+vector<Block> toBlocks(const vector<Interval64> &intervals);
+bool sameResult(const vector<Interval64> &scalar, const vector<Block> &blocks);
+bool checkCompare(const vector<Interval64> &a, const vector<Interval64> &b);
+vector<Entry> toEntries(const vector<Interval64> &intervals, mt19937 &random);
+bool scalarJoinLeaf(Entry *mine, const Entry *theirs);
+bool kernelJoinLeaf(Entry *mine, const Entry *theirs);
+double timeScalar(const KernelCase &op, vector<Interval64> &out, const vector<Interval64> &a, const vector<Interval64> &b, int rounds);
+double timeKernel(const KernelCase &op, vector<Block> &out, const vector<Block> &a, const vector<Block> &b, int rounds);
+double timeLeafJoin(bool (*join)(Entry*, const Entry*), const vector<Entry> &a, const vector<Entry> &b, int rounds);
+
+void scalarAdd(vector<Interval64> &out, const vector<Interval64> &a, const vector<Interval64> &b)
+{
+    for (size_t i = 0; i < out.size(); ++i) {
+        out[i] = Interval64(a[i]) + b[i];
+    }
+}
+
+void scalarSub(vector<Interval64> &out, const vector<Interval64> &a, const vector<Interval64> &b)
+{
+    for (size_t i = 0; i < out.size(); ++i) {
+        out[i] = Interval64(a[i]) - b[i];
+    }
+}
+
+void scalarMul(vector<Interval64> &out, const vector<Interval64> &a, const vector<Interval64> &b)
+{
+    for (size_t i = 0; i < out.size(); ++i) {
+        out[i] = Interval64(a[i]) * b[i];
+    }
+}
+
+void scalarJoin(vector<Interval64> &out, const vector<Interval64> &a, const vector<Interval64> &b)
+{
+    for (size_t i = 0; i < out.size(); ++i) {
+        out[i] = a[i];
+        out[i].unionWith(b[i]);
+    }
+}
+
+void scalarMeet(vector<Interval64> &out, const vector<Interval64> &a, const vector<Interval64> &b)
+{
+    for (size_t i = 0; i < out.size(); ++i) {
+        out[i] = a[i];
+        out[i].meetWith(b[i]);
+    }
+}
+
+void scalarWiden(vector<Interval64> &out, const vector<Interval64> &a, const vector<Interval64> &b)
+{
+    for (size_t i = 0; i < out.size(); ++i) {
+        out[i] = a[i];
+        out[i].widenWith(b[i]);
+    }
+}
+
+void scalarNarrow(vector<Interval64> &out, const vector<Interval64> &a, const vector<Interval64> &b)
+{
+    for (size_t i = 0; i < out.size(); ++i) {
+        out[i] = a[i];
+        out[i].narrowWith(b[i]);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    // usage: intervalKernels [--count N] [--rounds N] [--seed N]
+    // Runs each operation over N random interval pairs rounds times, on
+    // Interval64 and with the kernels of IntervalKernels.h, and prints the
+    // throughput of each; then the same for the join of IntervalMap leaves,
+    // scalar and loaded into lanes as the solver joins states. Every kernel
+    // is checked against Interval64 first, bounds hidden by an infinite flag
+    // included, on intervals with finite INT64_MIN and INT64_MAX bounds
+    // among them.
+    size_t count = DEFAULT_COUNT;
+    int rounds = DEFAULT_ROUNDS;
+    unsigned seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (hasValue && strcmp(argv[i], "--count") == 0) {
+            count = strtoul(argv[++i], nullptr, 10);
+        } else if (hasValue && strcmp(argv[i], "--rounds") == 0) {
+            rounds = atoi(argv[++i]);
+        } else if (hasValue && strcmp(argv[i], "--seed") == 0) {
+            seed = strtoul(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "error: unknown option \"%s\"\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (count < 1 || rounds < 1) {
+        fprintf(stderr, "error: --count and --rounds must be positive\n");
+        return EXIT_FAILURE;
+    }
+    // Whole blocks, which whole leaves fill too.
+    count = (count + BLOCK_LANES - 1) / BLOCK_LANES * BLOCK_LANES;
+
+    mt19937 random(seed);
+    vector<Interval64> a = randomIntervals(count, random);
+    vector<Interval64> b = randomIntervals(count, random);
+    vector<Block> blocksA = toBlocks(a);
+    vector<Block> blocksB = toBlocks(b);
+    vector<Interval64> scalarOut(count);
+    vector<Block> kernelOut(count / BLOCK_LANES);
+
+    KernelCase cases[] = {
+        {"add", scalarAdd, addLanes<BLOCK_LANES>},
+        {"sub", scalarSub, subLanes<BLOCK_LANES>},
+        {"mul", scalarMul, mulLanes<BLOCK_LANES>},
+        {"join", scalarJoin, joinLanes<BLOCK_LANES>},
+        {"meet", scalarMeet, meetLanes<BLOCK_LANES>},
+        {"widen", scalarWiden, widenLanes<BLOCK_LANES>},
+        {"narrow", scalarNarrow, narrowLanes<BLOCK_LANES>},
+    };
+
+    int failed = 0;
+    if (!checkCompare(a, b)) {
+        fprintf(stderr, "error: compareLanes disagrees with Interval64's operator==\n");
+        ++failed;
+    }
+
+    printf("%-10s %14s %14s %8s\n", "op", "scalar M/s", "kernel M/s", "speedup");
+    double operations = (double) count * rounds / 1e6;
+    for (auto &op: cases) {
+        op.scalar(scalarOut, a, b);
+        for (size_t k = 0; k < kernelOut.size(); ++k) {
+            op.kernel(blocksA[k], blocksB[k], kernelOut[k]);
+        }
+        if (!sameResult(scalarOut, kernelOut)) {
+            fprintf(stderr, "error: %s kernel disagrees with Interval64\n", op.name);
+            ++failed;
+        }
+
+        double scalarSeconds = timeScalar(op, scalarOut, a, b, rounds);
+        double kernelSeconds = timeKernel(op, kernelOut, blocksA, blocksB, rounds);
+        printf("%-10s %14.1f %14.1f %7.1fx\n", op.name, operations / scalarSeconds,
+               operations / kernelSeconds, scalarSeconds / kernelSeconds);
+    }
+
+    vector<Entry> entriesA = toEntries(a, random);
+    vector<Entry> entriesB = toEntries(b, random);
+    vector<Entry> scalarEntries = entriesA, kernelEntries = entriesA;
+    for (size_t k = 0; k < count; k += LEAF_LANES) {
+        bool scalarChanged = scalarJoinLeaf(&scalarEntries[k], &entriesB[k]);
+        bool kernelChanged = kernelJoinLeaf(&kernelEntries[k], &entriesB[k]);
+        for (size_t i = k; i < k + LEAF_LANES; ++i) {
+            if (scalarEntries[i].first != kernelEntries[i].first
+                || !scalarEntries[i].second.identical(kernelEntries[i].second)) {
+                scalarChanged = !kernelChanged;
+            }
+        }
+        if (scalarChanged != kernelChanged) {
+            fprintf(stderr, "error: leaf join disagrees with Interval64 at %zu\n", k);
+            ++failed;
+            break;
+        }
+    }
+    double scalarSeconds = timeLeafJoin(scalarJoinLeaf, entriesA, entriesB, rounds);
+    double kernelSeconds = timeLeafJoin(kernelJoinLeaf, entriesA, entriesB, rounds);
+    printf("%-10s %14.1f %14.1f %7.1fx\n", "leaf join", operations / scalarSeconds,
+           operations / kernelSeconds, scalarSeconds / kernelSeconds);
+    return failed == 0 ? 0 : EXIT_FAILURE;
+}
+
+// Bounds of three kinds, picked at random for each: small ones, which no
+// operation overflows; ones near the ends of int64_t, finite INT64_MIN and
+// INT64_MAX among them, whose sums and products do; and infinite ones, one
+// bound in four, as after widening. An infinite flag keeps the bound it
+// hides, which operator* reads. One interval in sixteen is empty.
+vector<Interval64> randomIntervals(size_t count, mt19937 &random)
+{
+    uniform_int_distribution<int64_t> small(-1000, 1000);
+    uniform_int_distribution<int64_t> edge(0, 3);
+    vector<Interval64> intervals;
+    for (size_t i = 0; i < count; ++i) {
+        int64_t bounds[2];
+        for (auto &bound: bounds) {
+            switch (random() % 4) {
+            case 0:
+                bound = INT64_MIN + edge(random);
+                break;
+            case 1:
+                bound = INT64_MAX - edge(random);
+                break;
+            default:
+                bound = small(random);
+                break;
+            }
+        }
+        int64_t low = min(bounds[0], bounds[1]), high = max(bounds[0], bounds[1]);
+        intervals.push_back(Interval64::fromFields(low, high, random() % 4 == 0, random() % 4 == 0, random() % 16 == 0));
+    }
+    return intervals;
+}
+
+vector<Block> toBlocks(const vector<Interval64> &intervals)
+{
+    vector<Block> blocks(intervals.size() / BLOCK_LANES);
+    for (size_t i = 0; i < intervals.size(); ++i) {
+        blocks[i / BLOCK_LANES].load(i % BLOCK_LANES, intervals[i]);
+    }
+    return blocks;
+}
+
+// Field for field, as interning compares them.
+bool sameResult(const vector<Interval64> &scalar, const vector<Block> &blocks)
+{
+    for (size_t i = 0; i < scalar.size(); ++i) {
+        if (!scalar[i].identical(blocks[i / BLOCK_LANES].get(i % BLOCK_LANES))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// a against b, and a against itself with the bound under each infinite
+// flag changed and empty flipped, neither of which operator== looks at.
+bool checkCompare(const vector<Interval64> &a, const vector<Interval64> &b)
+{
+    vector<Interval64> hidden;
+    for (auto &interval: a) {
+        hidden.push_back(Interval64::fromFields(
+            interval.lowerInfinite() ? ~interval.lower() : interval.lower(),
+            interval.upperInfinite() ? ~interval.upper() : interval.upper(),
+            interval.lowerInfinite(), interval.upperInfinite(), !interval.isEmpty()));
+    }
+    vector<Block> blocksA = toBlocks(a);
+    const vector<Interval64> *others[] = {&b, &hidden};
+    for (const vector<Interval64> *other: others) {
+        vector<Block> blocksOther = toBlocks(*other);
+        int64_t differ[BLOCK_LANES];
+        for (size_t k = 0; k < blocksA.size(); ++k) {
+            compareLanes(blocksA[k], blocksOther[k], differ);
+            for (size_t i = 0; i < BLOCK_LANES; ++i) {
+                Interval64 interval = a[k * BLOCK_LANES + i];
+                if ((differ[i] != 0) != (interval != (*other)[k * BLOCK_LANES + i])) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// One entry in eight without a key, as for values a state has not reached.
+vector<Entry> toEntries(const vector<Interval64> &intervals, mt19937 &random)
+{
+    static const char key = 0;
+    vector<Entry> entries;
+    for (auto &interval: intervals) {
+        entries.push_back(Entry(random() % 8 == 0 ? nullptr : &key, interval));
+    }
+    return entries;
+}
+
+// theirs joined into mine an entry at a time, as PersistentArray::mergeWith
+// runs a merge: an entry mine lacks is taken over.
+bool scalarJoinLeaf(Entry *mine, const Entry *theirs)
+{
+    bool changed = false;
+    for (size_t i = 0; i < LEAF_LANES; ++i) {
+        if (theirs[i].first == nullptr) {
+            continue;
+        }
+        if (mine[i].first == nullptr) {
+            mine[i] = theirs[i];
+            changed = true;
+            continue;
+        }
+        Interval64 before = mine[i].second;
+        mine[i].second.unionWith(theirs[i].second);
+        if (before != mine[i].second) {
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+// The same through the lanes, as the solver joins a leaf of two states.
+bool kernelJoinLeaf(Entry *mine, const Entry *theirs)
+{
+    IntervalLanes<LEAF_LANES> mines, theirLanes, joined;
+    int64_t minePresent[LEAF_LANES], theirPresent[LEAF_LANES];
+    int64_t take[LEAF_LANES], update[LEAF_LANES];
+    loadEntries(mine, mines, minePresent);
+    loadEntries(theirs, theirLanes, theirPresent);
+    joinLanes(mines, theirLanes, joined);
+    compareLanes(mines, joined, update);
+    for (size_t i = 0; i < LEAF_LANES; ++i) {
+        take[i] = theirPresent[i] & ~minePresent[i];
+        update[i] &= theirPresent[i] & minePresent[i];
+    }
+    return storeEntries(mine, theirs, joined, take, update);
+}
+
+// The results are read after every round, so no round can be dropped.
+double timeScalar(const KernelCase &op, vector<Interval64> &out, const vector<Interval64> &a, const vector<Interval64> &b, int rounds)
+{
+    volatile int64_t sink = 0;
+    auto start = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        op.scalar(out, a, b);
+        sink = sink + out[r % out.size()].lower();
+    }
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+double timeKernel(const KernelCase &op, vector<Block> &out, const vector<Block> &a, const vector<Block> &b, int rounds)
+{
+    volatile int64_t sink = 0;
+    auto start = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (size_t k = 0; k < out.size(); ++k) {
+            op.kernel(a[k], b[k], out[k]);
+        }
+        sink = sink + out[r % out.size()].low[r % BLOCK_LANES];
+    }
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Each round joins b into a fresh copy of a; only the joins are timed.
+double timeLeafJoin(bool (*join)(Entry*, const Entry*), const vector<Entry> &a, const vector<Entry> &b, int rounds)
+{
+    volatile int64_t sink = 0;
+    vector<Entry> entries;
+    chrono::steady_clock::duration spent(0);
+    for (int r = 0; r < rounds; ++r) {
+        entries = a;
+        auto start = chrono::steady_clock::now();
+        for (size_t k = 0; k < entries.size(); k += LEAF_LANES) {
+            sink = sink + join(&entries[k], &b[k]);
+        }
+        spent += chrono::steady_clock::now() - start;
+    }
+    return chrono::duration<double>(spent).count();
+}
@@ -0,0 +1,293 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+#define DEFAULT_TIMEOUT 60
+#define DEFAULT_REPEAT 3
+
+// Arguments of generateCFG for one input size.
+struct BenchSize {
+    int vars;
+    int loops;
+    int depth;
+    int diamonds;
+    int functions;
+};
+
+// One analyzer run: how it ended, its wall time, its peak resident set and
+// the "Block N" lines it printed, which every analyzer prints once per visit.
+struct RunResult {
+    string status;
+    double seconds = 0;
+    long peakKB = 0;
+    long blockVisits = 0;
+};
+
+bool parseSize(const string &text, BenchSize &size);
+RunResult runProgram(const vector<string> &args, int timeout, bool captureVisits);
+string sizeLabel(const BenchSize &size);
+
+int main(int argc, char **argv)
+{
+    // usage: runBenchmarks [--bin DIR] [--label NAME] [--size V,L,D,K,F]...
+    //                      [--tool NAME]... [--timeout SECONDS] [--repeat N]
+    //                      [-o FILE]
+    // Generates one input per size with DIR/generateCFG (vars, loops, loop
+    // depth, diamonds per body, functions) and times every analyzer in DIR
+    // on it. Each run keeps the best wall time and the largest peak RSS of
+    // its repeats. Rows are appended to FILE, so runs of several revisions,
+    // told apart by --label, end up in one CSV.
+    string binDir = ".";
+    string label = "current";
+    string outPath = "-";
+    int timeout = DEFAULT_TIMEOUT;
+    int repeat = DEFAULT_REPEAT;
+    vector<BenchSize> sizes;
+    vector<string> tools;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (hasValue && strcmp(argv[i], "--bin") == 0) {
+            binDir = argv[++i];
+        } else if (hasValue && strcmp(argv[i], "--label") == 0) {
+            label = argv[++i];
+        } else if (hasValue && strcmp(argv[i], "--size") == 0) {
+            BenchSize size;
+            if (!parseSize(argv[++i], size)) {
+                fprintf(stderr, "error: bad size \"%s\", expected V,L,D,K,F\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+            sizes.push_back(size);
+        } else if (hasValue && strcmp(argv[i], "--tool") == 0) {
+            tools.push_back(argv[++i]);
+        } else if (hasValue && strcmp(argv[i], "--timeout") == 0) {
+            timeout = atoi(argv[++i]);
+        } else if (hasValue && strcmp(argv[i], "--repeat") == 0) {
+            repeat = atoi(argv[++i]);
+        } else if (hasValue && strcmp(argv[i], "-o") == 0) {
+            outPath = argv[++i];
+        } else {
+            fprintf(stderr, "error: unknown option \"%s\"\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (timeout < 1 || repeat < 1) {
+        fprintf(stderr, "error: --timeout and --repeat must be positive\n");
+        return EXIT_FAILURE;
+    }
+
+    // The first size has no loops, so the non-loop analyzers finish too;
+    // on the others they are expected to time out or run out of stack.
+    if (sizes.empty()) {
+        sizes.push_back({8, 0, 1, 12, 1});
+        sizes.push_back({8, 2, 1, 2, 1});
+        sizes.push_back({16, 8, 2, 4, 1});
+        sizes.push_back({32, 16, 2, 8, 1});
+        sizes.push_back({32, 16, 3, 8, 8});
+    }
+    if (tools.empty()) {
+        const char *all[] = {"taintAnalysis", "taintLoopAnalysis", "diffAnalysis",
+                             "diffLoopAnalysis", "intervalAnalysis", "intervalLoopAnalysis"};
+        tools.assign(all, all + 6);
+    }
+
+    // Append to an existing CSV; only a new one gets the header.
+    bool newFile = true;
+    struct stat info;
+    if (outPath != "-" && stat(outPath.c_str(), &info) == 0 && info.st_size > 0) {
+        newFile = false;
+    }
+    ofstream file;
+    if (outPath != "-") {
+        file.open(outPath.c_str(), ios::app);
+        if (!file) {
+            fprintf(stderr, "error: cannot write \"%s\"\n", outPath.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+    ostream &csv = outPath == "-" ? cout : file;
+    if (newFile) {
+        csv << "label,tool,vars,loops,depth,diamonds,functions,status,wall_seconds,peak_rss_kb,block_visits\n";
+    }
+
+    char inputPath[] = "/tmp/runBenchmarks.XXXXXX.ll";
+    int fd = mkstemps(inputPath, 3);
+    if (fd < 0) {
+        fprintf(stderr, "error: cannot create a temporary input file\n");
+        return EXIT_FAILURE;
+    }
+    close(fd);
+
+    int failed = 0;
+    for (auto &size: sizes) {
+        vector<string> generate;
+        generate.push_back(binDir + "/generateCFG");
+        const char *flags[] = {"--vars", "--loops", "--depth", "--diamonds", "--functions"};
+        int values[] = {size.vars, size.loops, size.depth, size.diamonds, size.functions};
+        for (int k = 0; k < 5; ++k) {
+            generate.push_back(flags[k]);
+            generate.push_back(to_string(values[k]));
+        }
+        generate.push_back("-o");
+        generate.push_back(inputPath);
+        if (runProgram(generate, timeout, false).status != "ok") {
+            fprintf(stderr, "error: generateCFG failed for size %s\n", sizeLabel(size).c_str());
+            unlink(inputPath);
+            return EXIT_FAILURE;
+        }
+
+        for (auto &tool: tools) {
+            vector<string> args;
+            args.push_back(binDir + "/" + tool);
+            args.push_back(inputPath);
+
+            RunResult best;
+            for (int r = 0; r < repeat; ++r) {
+                RunResult run = runProgram(args, timeout, true);
+                long peakKB = max(best.peakKB, run.peakKB);
+                if (r == 0 || run.status != "ok" || run.seconds < best.seconds) {
+                    best = run;
+                }
+                best.peakKB = peakKB;
+                // A failed run would only fail the same way again.
+                if (run.status != "ok") {
+                    break;
+                }
+            }
+            if (best.status != "ok") {
+                ++failed;
+            }
+
+            char seconds[32];
+            snprintf(seconds, sizeof(seconds), "%.4f", best.seconds);
+            csv << label << "," << tool << "," << size.vars << "," << size.loops << ","
+                << size.depth << "," << size.diamonds << "," << size.functions << ","
+                << best.status << "," << seconds << "," << best.peakKB << ","
+                << best.blockVisits << "\n";
+            csv.flush();
+            fprintf(stderr, "%s %s: %s, %ss, %ld KB, %ld block visits\n", tool.c_str(),
+                    sizeLabel(size).c_str(), best.status.c_str(), seconds, best.peakKB,
+                    best.blockVisits);
+        }
+    }
+    unlink(inputPath);
+
+    // Analyzers failing on loops are expected; the CSV says which did.
+    if (failed != 0) {
+        fprintf(stderr, "%d runs did not finish cleanly\n", failed);
+    }
+    return 0;
+}
+
+bool parseSize(const string &text, BenchSize &size)
+{
+    int *fields[] = {&size.vars, &size.loops, &size.depth, &size.diamonds, &size.functions};
+    istringstream in(text);
+    for (int k = 0; k < 5; ++k) {
+        char comma = ',';
+        if ((k > 0 && !(in >> comma)) || comma != ',' || !(in >> *fields[k]) || *fields[k] < 0) {
+            return false;
+        }
+    }
+    return in.peek() == EOF;
+}
+
+string sizeLabel(const BenchSize &size)
+{
+    return to_string(size.vars) + "," + to_string(size.loops) + "," + to_string(size.depth) + "," +
+           to_string(size.diamonds) + "," + to_string(size.functions);
+}
+
+// Runs args[0] with the rest as its arguments, killing it after timeout
+// seconds. With captureVisits its output is read and its "Block N" lines
+// counted; otherwise it goes to /dev/null like its error output always does.
+RunResult runProgram(const vector<string> &args, int timeout, bool captureVisits)
+{
+    RunResult result;
+    int pipeFds[2] = {-1, -1};
+    if (captureVisits && pipe(pipeFds) != 0) {
+        result.status = "pipe-failed";
+        return result;
+    }
+
+    auto start = chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid < 0) {
+        result.status = "fork-failed";
+        return result;
+    }
+    if (pid == 0) {
+        int devNull = open("/dev/null", O_WRONLY);
+        dup2(captureVisits ? pipeFds[1] : devNull, STDOUT_FILENO);
+        dup2(devNull, STDERR_FILENO);
+        if (captureVisits) {
+            close(pipeFds[0]);
+            close(pipeFds[1]);
+        }
+        // The alarm outlives exec and ends the analyzer with SIGALRM.
+        alarm(timeout);
+        vector<char*> argv;
+        for (auto &arg: args) {
+            argv.push_back(const_cast<char*>(arg.c_str()));
+        }
+        argv.push_back(nullptr);
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+
+    if (captureVisits) {
+        close(pipeFds[1]);
+        // Matches "Block " and a digit at the start of a line across reads.
+        const char *prefix = "Block ";
+        size_t matched = 0;
+        bool lineStart = true;
+        char buffer[1 << 16];
+        ssize_t n;
+        while ((n = read(pipeFds[0], buffer, sizeof(buffer))) > 0) {
+            for (ssize_t i = 0; i < n; ++i) {
+                char c = buffer[i];
+                if (lineStart || matched > 0) {
+                    if (matched < 6 && c == prefix[matched]) {
+                        ++matched;
+                    } else {
+                        if (matched == 6 && isdigit((unsigned char) c)) {
+                            ++result.blockVisits;
+                        }
+                        matched = 0;
+                    }
+                }
+                lineStart = (c == '\n');
+            }
+        }
+        close(pipeFds[0]);
+    }
+
+    int status = 0;
+    struct rusage usage;
+    wait4(pid, &status, 0, &usage);
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    result.peakKB = usage.ru_maxrss;
+    if (WIFEXITED(status)) {
+        result.status = WEXITSTATUS(status) == 0 ? "ok" : "exit-" + to_string(WEXITSTATUS(status));
+    } else if (WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM) {
+        result.status = "timeout";
+    } else {
+        result.status = "signal-" + to_string(WTERMSIG(status));
+    }
+    return result;
+}
@@ -0,0 +1,258 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "../difference-analysis/Zone.h"
+
+using namespace std;
+
+#define DEFAULT_MAX_VARS 512
+
+// Relaxations each measurement runs at least, so the small sizes repeat.
+#define MIN_WORK (1 << 26)
+
+// Unbounded in the reference matrices.
+#define REFERENCE_INFINITY INT64_MAX
+
+// A difference-bound matrix that holds: the bounds of values picked at
+// random, each loosened a little, one in four of them present.
+struct RandomDBM {
+    unsigned dim;
+    vector<int64_t> bounds;
+    vector<int64_t> values;
+};
+
+RandomDBM randomDBM(unsigned vars, mt19937 &random);
+Zone toZone(const RandomDBM &dbm);
+void referenceClose(vector<int64_t> &bounds, unsigned dim);
+bool sameBounds(const vector<int64_t> &reference, const Zone &zone);
+bool checkChain(unsigned vars);
+double timeReference(const RandomDBM &dbm, int rounds);
+double timeClose(const Zone &open, int rounds);
+double timeAddConstraint(const Zone &closed, unsigned i, unsigned j, int64_t c, int rounds);
+
+int main(int argc, char **argv)
+{
+    // usage: zoneClosure [--max N] [--seed N]
+    // Closes random zones of 16, 32, ... up to N variables with scalar
+    // Floyd-Warshall and with Zone::close, then adds one constraint to the
+    // closed zone with Zone::addConstraint, and prints the time each takes.
+    // The results are compared with the scalar closure first, and a chain
+    // of large negative bounds is closed before any timing (see
+    // checkChain).
+    unsigned maxVars = DEFAULT_MAX_VARS;
+    unsigned seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (hasValue && strcmp(argv[i], "--max") == 0) {
+            maxVars = strtoul(argv[++i], nullptr, 10);
+        } else if (hasValue && strcmp(argv[i], "--seed") == 0) {
+            seed = strtoul(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "error: unknown option \"%s\"\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (maxVars < 16) {
+        fprintf(stderr, "error: --max must be at least 16\n");
+        return EXIT_FAILURE;
+    }
+
+    int failed = 0;
+    for (unsigned vars: {3u, 2u * ZONE_BAND + 5}) {
+        if (!checkChain(vars)) {
+            fprintf(stderr, "error: close of a chain of %u variables bounds what it should not\n", vars);
+            ++failed;
+        }
+    }
+
+    mt19937 random(seed);
+    printf("%6s %12s %12s %8s %14s\n", "vars", "scalar ms", "close ms", "speedup", "add one us");
+    for (unsigned vars = 16; vars <= maxVars; vars *= 2) {
+        RandomDBM dbm = randomDBM(vars, random);
+        Zone open = toZone(dbm);
+
+        vector<int64_t> reference = dbm.bounds;
+        referenceClose(reference, dbm.dim);
+        Zone closed = open;
+        closed.close();
+        if (closed.isEmpty() || !sameBounds(reference, closed)) {
+            fprintf(stderr, "error: close disagrees with Floyd-Warshall on %u variables\n", vars);
+            ++failed;
+        }
+
+        // The exact difference of two of the values, which still holds and
+        // is tighter than the closure unless the slack was 0 all the way.
+        unsigned i = 1 + random() % vars;
+        unsigned j = 1 + (i + random() % (vars - 1)) % vars;
+        int64_t c = dbm.values[j] - dbm.values[i];
+        Zone added = closed;
+        added.addConstraint(i, j, c);
+        reference[(size_t) i * dbm.dim + j] = min(reference[(size_t) i * dbm.dim + j], c);
+        referenceClose(reference, dbm.dim);
+        if (added.isEmpty() || !sameBounds(reference, added)) {
+            fprintf(stderr, "error: addConstraint disagrees with Floyd-Warshall on %u variables\n", vars);
+            ++failed;
+        }
+
+        double cube = (double) dbm.dim * dbm.dim * dbm.dim;
+        int rounds = cube >= MIN_WORK ? 1 : (int) (MIN_WORK / cube);
+        double scalarSeconds = timeReference(dbm, rounds) / rounds;
+        double closeSeconds = timeClose(open, rounds) / rounds;
+        int addRounds = rounds * dbm.dim;
+        double addSeconds = timeAddConstraint(closed, i, j, c, addRounds) / addRounds;
+        printf("%6u %12.3f %12.3f %7.1fx %14.2f\n", vars, scalarSeconds * 1e3, closeSeconds * 1e3,
+               scalarSeconds / closeSeconds, addSeconds * 1e6);
+    }
+    return failed == 0 ? 0 : EXIT_FAILURE;
+}
+
+RandomDBM randomDBM(unsigned vars, mt19937 &random)
+{
+    uniform_int_distribution<int> value(-1000, 1000);
+    uniform_int_distribution<int> slack(0, 100);
+    RandomDBM dbm;
+    dbm.dim = vars + 1;
+    dbm.values.push_back(0);
+    for (unsigned k = 0; k < vars; ++k) {
+        dbm.values.push_back(value(random));
+    }
+    dbm.bounds.assign((size_t) dbm.dim * dbm.dim, REFERENCE_INFINITY);
+    for (unsigned i = 0; i < dbm.dim; ++i) {
+        for (unsigned j = 0; j < dbm.dim; ++j) {
+            if (i == j) {
+                dbm.bounds[(size_t) i * dbm.dim + j] = 0;
+            } else if (random() % 4 == 0) {
+                dbm.bounds[(size_t) i * dbm.dim + j] = dbm.values[j] - dbm.values[i] + slack(random);
+            }
+        }
+    }
+    return dbm;
+}
+
+Zone toZone(const RandomDBM &dbm)
+{
+    Zone zone(dbm.dim - 1);
+    for (unsigned i = 0; i < dbm.dim; ++i) {
+        for (unsigned j = 0; j < dbm.dim; ++j) {
+            int64_t bound = dbm.bounds[(size_t) i * dbm.dim + j];
+            if (i != j && bound != REFERENCE_INFINITY) {
+                zone.constrain(i, j, bound);
+            }
+        }
+    }
+    return zone;
+}
+
+// Floyd-Warshall as in a textbook, one element at a time.
+void referenceClose(vector<int64_t> &bounds, unsigned dim)
+{
+    for (unsigned k = 0; k < dim; ++k) {
+        for (unsigned i = 0; i < dim; ++i) {
+            int64_t through = bounds[(size_t) i * dim + k];
+            if (through == REFERENCE_INFINITY) {
+                continue;
+            }
+            for (unsigned j = 0; j < dim; ++j) {
+                int64_t other = bounds[(size_t) k * dim + j];
+                if (other != REFERENCE_INFINITY && through + other < bounds[(size_t) i * dim + j]) {
+                    bounds[(size_t) i * dim + j] = through + other;
+                }
+            }
+        }
+    }
+}
+
+bool sameBounds(const vector<int64_t> &reference, const Zone &zone)
+{
+    unsigned dim = zone.variables() + 1;
+    for (unsigned i = 0; i < dim; ++i) {
+        for (unsigned j = 0; j < dim; ++j) {
+            int64_t expected = reference[(size_t) i * dim + j];
+            int32_t bound = zone.bound(i, j);
+            if (expected == REFERENCE_INFINITY ? bound != ZONE_INFINITY : bound != expected) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// v_k - v_{k+1} <= c for each k, with c = -0.6 * ZONE_LIMIT, so that the
+// sum of two bounds is already past ZONE_LIMIT, and with that no bound.
+// Only v_i - v_j for i < j is bounded, by (j - i) * c raised to
+// -ZONE_LIMIT + 1; every other bound, the ones against 0 in particular,
+// must stay infinite.
+bool checkChain(unsigned vars)
+{
+    int64_t c = -(int64_t) ZONE_LIMIT * 3 / 5;
+    Zone zone(vars);
+    for (unsigned k = 1; k < vars; ++k) {
+        zone.constrain(k + 1, k, c);
+    }
+    zone.close();
+    if (zone.isEmpty()) {
+        return false;
+    }
+    for (unsigned i = 0; i <= vars; ++i) {
+        for (unsigned j = 0; j <= vars; ++j) {
+            int64_t expected = ZONE_INFINITY;
+            if (i == j) {
+                expected = 0;
+            } else if (i != 0 && j != 0 && j < i) {
+                expected = max((int64_t) (i - j) * c, (int64_t) -ZONE_LIMIT + 1);
+            }
+            if (zone.bound(i, j) != expected) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Each round closes a fresh copy; both sides pay for the copy.
+double timeReference(const RandomDBM &dbm, int rounds)
+{
+    volatile int64_t sink = 0;
+    auto start = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        vector<int64_t> bounds = dbm.bounds;
+        referenceClose(bounds, dbm.dim);
+        sink = sink + bounds[r % bounds.size()];
+    }
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+double timeClose(const Zone &open, int rounds)
+{
+    volatile int64_t sink = 0;
+    unsigned dim = open.variables() + 1;
+    auto start = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        Zone zone = open;
+        zone.close();
+        sink = sink + zone.bound(r % dim, (r + 1) % dim);
+    }
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// The copy is taken out of the time here, as it costs as much as the
+// O(n^2) update measured.
+double timeAddConstraint(const Zone &closed, unsigned i, unsigned j, int64_t c, int rounds)
+{
+    volatile int64_t sink = 0;
+    unsigned dim = closed.variables() + 1;
+    Zone zone = closed;
+    chrono::steady_clock::duration spent(0);
+    for (int r = 0; r < rounds; ++r) {
+        zone = closed;
+        auto start = chrono::steady_clock::now();
+        zone.addConstraint(i, j, c);
+        spent += chrono::steady_clock::now() - start;
+        sink = sink + zone.bound(r % dim, (r + 1) % dim);
+    }
+    return chrono::duration<double>(spent).count();
+}
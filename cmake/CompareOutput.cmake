@@ -0,0 +1,58 @@
+# Runs TOOL on INPUT with ARGS and compares what it prints on standard
+# output with the file EXPECTED, or with what it prints given OTHER_ARGS
+# instead. ARGS and OTHER_ARGS are separated by spaces. The tool must exit
+# with STATUS, 0 by default. With FIRST the tool runs on that input with
+# ARGS beforehand, e.g. to fill a cache the compared run reads. @SCRATCH@ in
+# ARGS stands for the directory SCRATCH, emptied before any run. With
+# STDERR set, what the tool prints on standard error is compared instead,
+# for opt, whose print passes write there. Used by the tests in
+# CMakeLists.txt:
+#   cmake -DTOOL=... -DINPUT=... [-DARGS=...] [-DSTATUS=...] [-DFIRST=...]
+#         [-DSCRATCH=...] [-DSTDERR=ON] (-DEXPECTED=... | -DOTHER_ARGS=...)
+#         -P CompareOutput.cmake
+
+cmake_minimum_required(VERSION 3.13)
+
+if (NOT DEFINED STATUS)
+    set(STATUS 0)
+endif()
+if (DEFINED SCRATCH)
+    file(REMOVE_RECURSE ${SCRATCH})
+    file(MAKE_DIRECTORY ${SCRATCH})
+    string(REPLACE "@SCRATCH@" "${SCRATCH}" ARGS "${ARGS}")
+endif()
+
+function(run_tool input args result)
+    separate_arguments(args UNIX_COMMAND "${args}")
+    if (STDERR)
+        execute_process(
+            COMMAND ${TOOL} ${input} ${args}
+            OUTPUT_QUIET
+            ERROR_VARIABLE output
+            RESULT_VARIABLE status)
+    else()
+        execute_process(
+            COMMAND ${TOOL} ${input} ${args}
+            OUTPUT_VARIABLE output
+            RESULT_VARIABLE status)
+    endif()
+    if (NOT status EQUAL STATUS)
+        message(FATAL_ERROR "${TOOL} ${input} ${args} exited with ${status}:\n${output}")
+    endif()
+    set(${result} "${output}" PARENT_SCOPE)
+endfunction()
+
+if (DEFINED FIRST)
+    run_tool("${FIRST}" "${ARGS}" ignored)
+endif()
+run_tool("${INPUT}" "${ARGS}" actual)
+if (DEFINED EXPECTED)
+    file(READ ${EXPECTED} expected)
+    set(what "${EXPECTED}")
+else()
+    run_tool("${INPUT}" "${OTHER_ARGS}" expected)
+    set(what "the output with \"${OTHER_ARGS}\"")
+endif()
+if (NOT actual STREQUAL expected)
+    message(FATAL_ERROR "${TOOL} ${INPUT} ${ARGS} differs from ${what}:\n${actual}")
+endif()
@@ -0,0 +1,46 @@
+#ifndef ANALYSIS_TOOLS_H
+#define ANALYSIS_TOOLS_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+// Input an analysis cannot handle, e.g. an instruction it has no transfer
+// function for. The analyses throw it instead of exiting, so batchAnalysis
+// fails the one file and goes on with the others.
+class AnalysisError : public std::runtime_error {
+    public:
+        explicit AnalysisError(const std::string &message): std::runtime_error(message) {}
+};
+
+// The loop analyses, compiled into analysiscore. Each takes the command line
+// of its tool, argv[1] being the IR file, prints its results to cout and
+// returns the tool's exit status; input it cannot analyze throws
+// AnalysisError.
+typedef int (*AnalysisEntry)(int argc, char **argv);
+
+namespace taint {
+int runLoopAnalysis(int argc, char **argv);
+}
+
+namespace difference {
+int runLoopAnalysis(int argc, char **argv);
+}
+
+namespace interval {
+int runLoopAnalysis(int argc, char **argv);
+}
+
+// The main of a tool built around one of the entry points above.
+inline int runAnalysisMain(AnalysisEntry entry, int argc, char **argv)
+{
+    try {
+        return entry(argc, argv);
+    } catch (const AnalysisError &error) {
+        fprintf(stderr, "error: %s\n", error.what());
+        return EXIT_FAILURE;
+    }
+}
+
+#endif
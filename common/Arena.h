@@ -0,0 +1,240 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <new>
+#include <set>
+#include <type_traits>
+#include <vector>
+#include "Stats.h"
+
+// Size of the blocks an arena takes from malloc.
+#define ARENA_BLOCK_SIZE (256 * 1024)
+
+// Allocations are rounded up to this, which also aligns every one for any
+// type the analyses store.
+#define ARENA_GRAIN 16
+
+// Largest allocation the arena recycles; bigger ones, rare in an analysis,
+// stay put until the arena is released, up to ARENA_MAX_PIECE.
+#define ARENA_MAX_RECYCLED 1024
+
+// Allocations above this, e.g. the matrix of a zone, get blocks of their
+// own, which go back to malloc as soon as they are freed.
+#define ARENA_MAX_PIECE (ARENA_BLOCK_SIZE / 4)
+
+// Memory for the analysis of one function. It hands out pieces of large
+// blocks taken from malloc and gives all of them back at once when released,
+// instead of one free per tree node or state. A piece given back before
+// then goes on a free list for its size and is handed out again, so the
+// states a fixpoint computation drops do not pile up.
+//
+// Not thread-safe: each thread analyzes with its own arena (see
+// activeArena).
+class Arena {
+    public:
+        Arena() {}
+        Arena(const Arena &) = delete;
+        Arena &operator=(const Arena &) = delete;
+
+        ~Arena()
+        {
+            release();
+        }
+
+        void *allocate(size_t size)
+        {
+            size = (size + ARENA_GRAIN - 1) / ARENA_GRAIN * ARENA_GRAIN;
+            if (size <= ARENA_MAX_RECYCLED) {
+                FreePiece *&head = freeLists[size / ARENA_GRAIN];
+                if (head != nullptr) {
+                    FreePiece *piece = head;
+                    head = piece->next;
+                    return piece;
+                }
+            }
+            if (size > ARENA_MAX_PIECE) {
+                void *block = newBlock(size);
+                large.push_back(block);
+                return block;
+            }
+            if (size > (size_t) (end - next)) {
+                next = static_cast<char*>(newBlock(ARENA_BLOCK_SIZE));
+                blocks.push_back(next);
+                end = next + ARENA_BLOCK_SIZE;
+            }
+            void *piece = next;
+            next += size;
+            return piece;
+        }
+
+        void deallocate(void *pointer, size_t size)
+        {
+            size = (size + ARENA_GRAIN - 1) / ARENA_GRAIN * ARENA_GRAIN;
+            if (size <= ARENA_MAX_RECYCLED) {
+                FreePiece *piece = static_cast<FreePiece*>(pointer);
+                piece->next = freeLists[size / ARENA_GRAIN];
+                freeLists[size / ARENA_GRAIN] = piece;
+            } else if (size > ARENA_MAX_PIECE) {
+                // The latest are the likeliest to go first.
+                for (size_t i = large.size(); i-- > 0; ) {
+                    if (large[i] == pointer) {
+                        large[i] = large.back();
+                        large.pop_back();
+                        break;
+                    }
+                }
+                free(pointer);
+            }
+        }
+
+        // Frees every block; nothing allocated from the arena may be used
+        // after this.
+        void release()
+        {
+            for (auto block: blocks) {
+                free(block);
+            }
+            for (auto block: large) {
+                free(block);
+            }
+            blocks.clear();
+            large.clear();
+            next = end = nullptr;
+            for (auto &head: freeLists) {
+                head = nullptr;
+            }
+        }
+
+        size_t blockCount() const
+        {
+            return blocks.size() + large.size();
+        }
+
+        size_t bytesReserved() const
+        {
+            return reserved;
+        }
+
+    private:
+        struct FreePiece {
+            FreePiece *next;
+        };
+
+        void *newBlock(size_t size)
+        {
+            void *block = malloc(size);
+            if (block == nullptr) {
+                throw std::bad_alloc();
+            }
+            reserved += size;
+            return block;
+        }
+
+        std::vector<void*> blocks;
+        std::vector<void*> large;
+        char *next = nullptr;
+        char *end = nullptr;
+        size_t reserved = 0;
+        FreePiece *freeLists[ARENA_MAX_RECYCLED / ARENA_GRAIN + 1] = {};
+};
+
+// The arena of the function this thread is analyzing, or null to use the
+// heap as before.
+inline Arena *&activeArena()
+{
+    static thread_local Arena *arena = nullptr;
+    return arena;
+}
+
+// Makes a fresh arena active for one function's analysis and releases it,
+// all in one step, when the scope ends. Declare it before the states of
+// the function so they are destroyed first.
+class ArenaScope {
+    public:
+        ArenaScope(): saved(activeArena())
+        {
+            activeArena() = &arena;
+        }
+
+        ArenaScope(const ArenaScope &) = delete;
+        ArenaScope &operator=(const ArenaScope &) = delete;
+
+        ~ArenaScope()
+        {
+            countStat("arena blocks", arena.blockCount());
+            countStat("arena kilobytes", arena.bytesReserved() / 1024);
+            activeArena() = saved;
+        }
+
+    private:
+        Arena arena;
+        Arena *saved;
+};
+
+// Allocates from the arena active when the container was made, or from the
+// heap when there was none. The arena is fixed at construction and copies
+// take the one active then, so a container built outside a function's
+// scope never holds memory from it, even when assigned from one inside.
+template <typename T>
+class ArenaAllocator {
+    public:
+        typedef T value_type;
+        typedef std::true_type propagate_on_container_swap;
+
+        ArenaAllocator(): arena(activeArena()) {}
+
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U> &other): arena(other.arena) {}
+
+        T *allocate(size_t n)
+        {
+            if (arena != nullptr) {
+                return static_cast<T*>(arena->allocate(n * sizeof(T)));
+            }
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+
+        void deallocate(T *pointer, size_t n)
+        {
+            if (arena != nullptr) {
+                arena->deallocate(pointer, n * sizeof(T));
+            } else {
+                ::operator delete(pointer);
+            }
+        }
+
+        ArenaAllocator select_on_container_copy_construction() const
+        {
+            return ArenaAllocator();
+        }
+
+        template <typename U>
+        bool operator==(const ArenaAllocator<U> &rhs) const
+        {
+            return arena == rhs.arena;
+        }
+
+        template <typename U>
+        bool operator!=(const ArenaAllocator<U> &rhs) const
+        {
+            return arena != rhs.arena;
+        }
+
+        Arena *arena;
+};
+
+// The containers of the analyses' states, worklists and temporaries.
+template <typename K, typename V, typename Compare = std::less<K>>
+using ArenaMap = std::map<K, V, Compare, ArenaAllocator<std::pair<const K, V>>>;
+
+template <typename T, typename Compare = std::less<T>>
+using ArenaSet = std::set<T, Compare, ArenaAllocator<T>>;
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+#endif
@@ -0,0 +1,51 @@
+#include <algorithm>
+#include <set>
+#include <utility>
+#include <vector>
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/InstrTypes.h"
+#include "llvm/IR/Instructions.h"
+#include "CFG.h"
+
+using namespace llvm;
+using namespace std;
+
+vector<BasicBlock*> reversePostOrder(Function &F)
+{
+    // Iterative DFS so deep CFGs cannot overflow the stack.
+    vector<BasicBlock*> postOrder;
+    set<BasicBlock*> visited;
+    vector<pair<BasicBlock*, unsigned>> stack;
+
+    BasicBlock *entry = dyn_cast<BasicBlock>(F.begin());
+    visited.insert(entry);
+    stack.push_back(make_pair(entry, 0));
+    while (!stack.empty()) {
+        BasicBlock *BB = stack.back().first;
+        unsigned succIdx = stack.back().second;
+        const Terminator *TInst = BB->getTerminator();
+        if (succIdx < TInst->getNumSuccessors()) {
+            ++stack.back().second;
+            BasicBlock *Succ = TInst->getSuccessor(succIdx);
+            if (visited.insert(Succ).second) {
+                stack.push_back(make_pair(Succ, 0));
+            }
+        } else {
+            postOrder.push_back(BB);
+            stack.pop_back();
+        }
+    }
+    reverse(postOrder.begin(), postOrder.end());
+    return postOrder;
+}
+
+bool isLayoutBackEdge(BasicBlock *BB, BasicBlock *Succ)
+{
+    for (Function::iterator iter(*Succ); iter != BB->getParent()->end(); ++iter) {
+        if (&*iter == BB) {
+            return true;
+        }
+    }
+    return false;
+}
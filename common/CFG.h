@@ -0,0 +1,27 @@
+#ifndef CFG_H
+#define CFG_H
+
+#include <vector>
+#include "llvm/Config/llvm-config.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/InstrTypes.h"
+#include "llvm/IR/Instruction.h"
+
+// What BasicBlock::getTerminator returns. LLVM 8 folded TerminatorInst into
+// Instruction, which answers getNumSuccessors and getSuccessor itself.
+#if LLVM_VERSION_MAJOR >= 8
+typedef llvm::Instruction Terminator;
+#else
+typedef llvm::TerminatorInst Terminator;
+#endif
+
+// Blocks of F reachable from its entry, in reverse post-order: every block
+// comes after all of its predecessors except those reaching it by a back edge.
+std::vector<llvm::BasicBlock*> reversePostOrder(llvm::Function &F);
+
+// Whether the edge BB -> Succ goes to a block no later in F's layout. Front
+// ends lay loops out header first, so for their output this is a back edge.
+bool isLayoutBackEdge(llvm::BasicBlock *BB, llvm::BasicBlock *Succ);
+
+#endif
@@ -0,0 +1,55 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "llvm/Config/llvm-config.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/Support/SourceMgr.h"
+#if LLVM_VERSION_MAJOR >= 4
+#include "llvm/Support/Error.h"
+#endif
+#include "IRInput.h"
+
+using namespace llvm;
+using namespace std;
+
+Module *loadModule(const char *path, SMDiagnostic &Err, LLVMContext &Context)
+{
+#if LLVM_VERSION_MAJOR >= 4
+    return getLazyIRFileModule(path, Err, Context).release();
+#else
+    return getLazyIRFileModule(path, Err, Context);
+#endif
+}
+
+bool materialize(Function &F)
+{
+#if LLVM_VERSION_MAJOR >= 4
+    if (Error E = F.materialize()) {
+        consumeError(move(E));
+#else
+    string ErrInfo;
+    if (F.Materialize(&ErrInfo)) {
+#endif
+        fprintf(stderr, "error: failed to read function \"%s\"\n", F.getName().str().c_str());
+        return false;
+    }
+    return true;
+}
+
+bool materializeAll(Module &M)
+{
+#if LLVM_VERSION_MAJOR >= 4
+    if (Error E = M.materializeAll()) {
+        consumeError(move(E));
+#else
+    string ErrInfo;
+    if (M.MaterializeAll(&ErrInfo)) {
+#endif
+        fprintf(stderr, "error: failed to read module \"%s\"\n", M.getModuleIdentifier().c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,22 @@
+#ifndef IR_INPUT_H
+#define IR_INPUT_H
+
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Support/SourceMgr.h"
+
+// Opens textual IR or bitcode, from a file or from standard input when path
+// is "-". Bitcode is read lazily: a function body is only decoded once
+// materialize() asks for it, so analyzing main does not pay for the rest of
+// the module. Textual IR has no lazy form and is parsed whole.
+llvm::Module *loadModule(const char *path, llvm::SMDiagnostic &Err, llvm::LLVMContext &Context);
+
+// Reads the body of F if it has not been read yet. On malformed input it
+// prints an error and returns false.
+bool materialize(llvm::Function &F);
+
+// For analyses that look past the function at hand, e.g. into callees.
+bool materializeAll(llvm::Module &M);
+
+#endif
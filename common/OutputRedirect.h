@@ -0,0 +1,65 @@
+#ifndef OUTPUT_REDIRECT_H
+#define OUTPUT_REDIRECT_H
+
+#include <iostream>
+#include <streambuf>
+
+// Stream buffer that forwards each write to a buffer chosen per thread, so
+// analyses running side by side (see batch/batchAnalysis.cpp) can all print
+// to cout. It keeps no put area of its own; a thread without a target
+// discards its output.
+class ThreadOutputBuf : public std::streambuf {
+    public:
+        std::streambuf *swapTarget(std::streambuf *newTarget)
+        {
+            std::streambuf *previous = target();
+            target() = newTarget;
+            return previous;
+        }
+
+    protected:
+        int overflow(int c) override
+        {
+            if (target() == nullptr || c == traits_type::eof()) {
+                return traits_type::not_eof(c);
+            }
+            return target()->sputc(traits_type::to_char_type(c));
+        }
+
+        std::streamsize xsputn(const char *s, std::streamsize n) override
+        {
+            return target() == nullptr ? n : target()->sputn(s, n);
+        }
+
+        int sync() override
+        {
+            return target() == nullptr ? 0 : target()->pubsync();
+        }
+
+    private:
+        static std::streambuf *&target()
+        {
+            static thread_local std::streambuf *current = nullptr;
+            return current;
+        }
+};
+
+inline ThreadOutputBuf &threadOutput()
+{
+    static ThreadOutputBuf output;
+    return output;
+}
+
+// Sends cout to target, or nowhere if it is null, and returns where it went
+// before. Once cout writes through threadOutput() this only redirects the
+// calling thread, which is why tools use it instead of cout.rdbuf().
+inline std::streambuf *redirectOutput(std::streambuf *target)
+{
+    if (std::cout.rdbuf() == &threadOutput()) {
+        return threadOutput().swapTarget(target);
+    }
+    // rdbuf() also clears the error state a null buffer leaves behind.
+    return std::cout.rdbuf(target);
+}
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <cstdio>
+#include <cstdint>
+#include <cerrno>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Support/raw_ostream.h"
+
+// 64-bit FNV-1a, stable across runs and platforms.
+inline uint64_t fnv1a(const std::string &text)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (char c: text) {
+        hash ^= (unsigned char) c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Content-addressed store of per-function analysis output. An entry is keyed
+// by a hash of the tool, its result version, the options that affect the
+// result, any state carried in from earlier functions and the function's IR
+// text, so an unchanged function is answered from disk without a fixpoint.
+// An entry holds the state carried out (e.g. a block counter) on its first
+// line, followed by the printed result.
+class ResultCache {
+    public:
+        ResultCache(const std::string &tool, int version): tool(tool), version(version) {}
+
+        // Turns the cache on; results are stored as one file per key in dir.
+        bool open(const std::string &cacheDir)
+        {
+            if (mkdir(cacheDir.c_str(), 0755) != 0 && errno != EEXIST) {
+                return false;
+            }
+            dir = cacheDir;
+            return true;
+        }
+
+        bool enabled() const
+        {
+            return !dir.empty();
+        }
+
+        void addOption(const std::string &option)
+        {
+            options += option + " ";
+        }
+
+        const std::string &optionList() const
+        {
+            return options;
+        }
+
+        std::string key(llvm::Function &F, const std::string &carried) const
+        {
+            std::string text;
+            llvm::raw_string_ostream os(text);
+            F.print(os);
+            return hashKey(os.str(), carried);
+        }
+
+        // For results that depend on other functions as well, e.g. callees.
+        std::string key(llvm::Module &M, llvm::Function &F, const std::string &carried) const
+        {
+            std::string text;
+            llvm::raw_string_ostream os(text);
+            M.print(os, nullptr);
+            return hashKey(os.str(), carried + " @" + F.getName().str());
+        }
+
+        bool lookup(const std::string &key, std::string &carriedOut, std::string &result)
+        {
+            std::ifstream in((dir + "/" + key).c_str(), std::ios::binary);
+            if (!in || !std::getline(in, carriedOut)) {
+                ++misses;
+                return false;
+            }
+            std::ostringstream contents;
+            contents << in.rdbuf();
+            result = contents.str();
+            ++hits;
+            return true;
+        }
+
+        // Written under a temporary name and renamed, so concurrent runs
+        // sharing a directory never read a partial entry.
+        void store(const std::string &key, const std::string &carriedOut, const std::string &result)
+        {
+            std::string path = dir + "/" + key;
+            std::ostringstream tmpPath;
+            tmpPath << path << ".tmp." << getpid();
+            std::ofstream out(tmpPath.str().c_str(), std::ios::binary);
+            out << carriedOut << '\n' << result;
+            out.close();
+            if (!out || std::rename(tmpPath.str().c_str(), path.c_str()) != 0) {
+                std::remove(tmpPath.str().c_str());
+            }
+        }
+
+        int hits = 0;
+        int misses = 0;
+
+    private:
+        std::string hashKey(const std::string &text, const std::string &carried) const
+        {
+            std::ostringstream material;
+            material << tool << '\0' << version << '\0' << options << '\0' << carried << '\0' << text;
+
+            char hex[17];
+            snprintf(hex, sizeof(hex), "%016llx", (unsigned long long) fnv1a(material.str()));
+            return tool + "-" + hex;
+        }
+
+        std::string tool;
+        int version;
+        std::string options;
+        std::string dir;
+};
+
+#endif
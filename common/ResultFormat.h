@@ -0,0 +1,229 @@
+#ifndef RESULT_FORMAT_H
+#define RESULT_FORMAT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "llvm/IR/GlobalValue.h"
+#include "llvm/IR/Value.h"
+
+// Output formats selected with --format. Records are written to cout like
+// the text is, so capturing, muting and caching output work the same way;
+// nothing is flushed per record, the stream is written out as it fills.
+enum class ResultFormat { Text, JsonLines, Binary };
+
+// One entry of a record: a variable, or a pair of them for sep, named the
+// way the IR does (%local, @global) so names are stable between runs.
+struct ResultItem {
+    enum Kind { Member, Unknown, Bounds, Empty, Count };
+
+    std::string id;
+    Kind kind = Member;
+    bool lowInfinite = false;
+    bool highInfinite = false;
+    long long low = 0;
+    long long high = 0;
+
+    static ResultItem bounds(const std::string &id, bool lowInfinite, long long low, bool highInfinite, long long high)
+    {
+        ResultItem item;
+        item.id = id;
+        item.kind = Bounds;
+        item.lowInfinite = lowInfinite;
+        item.low = low;
+        item.highInfinite = highInfinite;
+        item.high = high;
+        return item;
+    }
+
+    static ResultItem count(const std::string &id, long long n)
+    {
+        ResultItem item;
+        item.id = id;
+        item.kind = Count;
+        item.low = n;
+        return item;
+    }
+
+    bool operator<(const ResultItem &rhs) const
+    {
+        return id < rhs.id;
+    }
+};
+
+// Stable id of a named value, in the IR's own notation.
+inline std::string resultId(llvm::Value *V)
+{
+    return (llvm::isa<llvm::GlobalValue>(V) ? "@" : "%") + V->getName().str();
+}
+
+// Writes one tool's records. JSON Lines gives one object per record:
+//   {"tool":T,"function":F,"kind":K,"block":N,"values":{ID:VALUE,...}}
+// where VALUE is [low,high] with null for an infinite bound, "empty",
+// true for set membership, null when unknown or a number for counters.
+// The binary form starts with "PARB", a version byte and the tool name,
+// then per record the byte 'R', function, kind, block, item count and per
+// item its id, a tag byte (kind, 0x10 low infinite, 0x20 high infinite) and
+// the finite bounds or the count as zigzag varints. Strings are a varint
+// length and bytes. Items are sorted by id in both. Concatenated streams,
+// as batchAnalysis writes, repeat the header where a record could start.
+class ResultPrinter {
+    public:
+        explicit ResultPrinter(const std::string &tool): tool(tool) {}
+
+        bool setFormat(const char *name)
+        {
+            if (strcmp(name, "text") == 0) {
+                format = ResultFormat::Text;
+            } else if (strcmp(name, "jsonl") == 0) {
+                format = ResultFormat::JsonLines;
+            } else if (strcmp(name, "binary") == 0) {
+                format = ResultFormat::Binary;
+            } else {
+                return false;
+            }
+            return true;
+        }
+
+        bool text() const
+        {
+            return format == ResultFormat::Text;
+        }
+
+        // The binary stream header; call once before any record.
+        void begin() const
+        {
+            if (format == ResultFormat::Binary) {
+                std::string header = "PARB";
+                header += char(1);
+                appendString(header, tool);
+                std::cout.write(header.data(), header.size());
+            }
+        }
+
+        void write(const std::string &kind, int block, std::vector<ResultItem> items) const
+        {
+            std::sort(items.begin(), items.end());
+            if (format == ResultFormat::JsonLines) {
+                writeJson(kind, block, items);
+            } else if (format == ResultFormat::Binary) {
+                writeBinary(kind, block, items);
+            }
+        }
+
+        ResultFormat format = ResultFormat::Text;
+        std::string function;
+
+    private:
+        void writeJson(const std::string &kind, int block, const std::vector<ResultItem> &items) const
+        {
+            std::string out = "{\"tool\":";
+            appendQuoted(out, tool);
+            out += ",\"function\":";
+            appendQuoted(out, function);
+            out += ",\"kind\":";
+            appendQuoted(out, kind);
+            out += ",\"block\":" + std::to_string(block) + ",\"values\":{";
+            for (size_t i = 0; i < items.size(); ++i) {
+                const ResultItem &item = items[i];
+                if (i != 0) {
+                    out += ',';
+                }
+                appendQuoted(out, item.id);
+                out += ':';
+                switch (item.kind) {
+                    case ResultItem::Member:
+                        out += "true";
+                        break;
+                    case ResultItem::Unknown:
+                        out += "null";
+                        break;
+                    case ResultItem::Empty:
+                        out += "\"empty\"";
+                        break;
+                    case ResultItem::Count:
+                        out += std::to_string(item.low);
+                        break;
+                    case ResultItem::Bounds:
+                        out += '[';
+                        out += item.lowInfinite ? "null" : std::to_string(item.low);
+                        out += ',';
+                        out += item.highInfinite ? "null" : std::to_string(item.high);
+                        out += ']';
+                        break;
+                }
+            }
+            out += "}}\n";
+            std::cout.write(out.data(), out.size());
+        }
+
+        void writeBinary(const std::string &kind, int block, const std::vector<ResultItem> &items) const
+        {
+            std::string out = "R";
+            appendString(out, function);
+            appendString(out, kind);
+            appendVarint(out, block);
+            appendVarint(out, items.size());
+            for (auto &item: items) {
+                appendString(out, item.id);
+                out += char(item.kind | (item.lowInfinite ? 0x10 : 0) | (item.highInfinite ? 0x20 : 0));
+                if (item.kind == ResultItem::Count) {
+                    appendVarint(out, zigzag(item.low));
+                } else if (item.kind == ResultItem::Bounds) {
+                    if (!item.lowInfinite) {
+                        appendVarint(out, zigzag(item.low));
+                    }
+                    if (!item.highInfinite) {
+                        appendVarint(out, zigzag(item.high));
+                    }
+                }
+            }
+            std::cout.write(out.data(), out.size());
+        }
+
+        static void appendQuoted(std::string &out, const std::string &text)
+        {
+            out += '"';
+            for (char c: text) {
+                if (c == '"' || c == '\\') {
+                    out += '\\';
+                    out += c;
+                } else if ((unsigned char) c < 0x20) {
+                    char escaped[8];
+                    snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out += escaped;
+                } else {
+                    out += c;
+                }
+            }
+            out += '"';
+        }
+
+        static uint64_t zigzag(long long n)
+        {
+            return (uint64_t(n) << 1) ^ uint64_t(n >> 63);
+        }
+
+        static void appendVarint(std::string &out, uint64_t n)
+        {
+            while (n >= 0x80) {
+                out += char((n & 0x7f) | 0x80);
+                n >>= 7;
+            }
+            out += char(n);
+        }
+
+        static void appendString(std::string &out, const std::string &text)
+        {
+            appendVarint(out, text.size());
+            out += text;
+        }
+
+        std::string tool;
+};
+
+#endif
@@ -0,0 +1,181 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+#include "CFG.h"
+#include "ResultFormat.h"
+
+// Counters and phase timers reported by --stats. An analysis records into
+// activeStats(), which is null unless --stats was given, so without it each
+// probe costs one test of a thread-local pointer.
+class AnalysisStats {
+    public:
+        void count(const std::string &name, long n = 1)
+        {
+            counters[name] += n;
+        }
+
+        void countOpcode(const char *opcode)
+        {
+            opcodes[opcode] += 1;
+        }
+
+        void countHeadVisit(llvm::BasicBlock *head)
+        {
+            headVisits[blockName(head)] += 1;
+        }
+
+        // For tools without an order of their own: an edge going back in
+        // the block layout counts as a visit of the loop head it enters.
+        void countEdge(llvm::BasicBlock *BB, llvm::BasicBlock *Succ)
+        {
+            if (isLayoutBackEdge(BB, Succ)) {
+                countHeadVisit(Succ);
+            }
+        }
+
+        void addIterations(const std::string &function, long n)
+        {
+            iterations[function] += n;
+        }
+
+        // Rounds of the component headed by head in a weak topological
+        // order (see WTO.h), summed over the runs of its enclosing ones.
+        void addComponentIterations(llvm::BasicBlock *head, long n)
+        {
+            components[blockName(head)] += n;
+        }
+
+        void addTime(const std::string &phase, std::chrono::steady_clock::duration elapsed)
+        {
+            Phase &entry = phases[phase];
+            entry.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+            entry.calls += 1;
+        }
+
+        // Phases nest (a join runs inside solving), so each time includes
+        // the phases below it.
+        void print(const ResultPrinter &printer) const
+        {
+            if (printer.text()) {
+                std::cout << "=========== Statistics ===========\n";
+                for (auto &entry: phases) {
+                    char millis[32];
+                    snprintf(millis, sizeof(millis), "%.3f", entry.second.nanoseconds / 1e6);
+                    std::cout << "time " << entry.first << ": " << millis << " ms in "
+                              << entry.second.calls << " calls\n";
+                }
+                printCounts("count", counters);
+                printCounts("transfer", opcodes);
+                printCounts("loop head", headVisits);
+                printCounts("iterations", iterations);
+                printCounts("component", components);
+                return;
+            }
+            std::vector<ResultItem> times;
+            std::vector<ResultItem> calls;
+            for (auto &entry: phases) {
+                times.push_back(ResultItem::count(entry.first, entry.second.nanoseconds / 1000));
+                calls.push_back(ResultItem::count(entry.first, entry.second.calls));
+            }
+            printer.write("stats-time-us", 0, times);
+            printer.write("stats-time-calls", 0, calls);
+            printer.write("stats-counts", 0, countItems(counters));
+            printer.write("stats-transfers", 0, countItems(opcodes));
+            printer.write("stats-loop-heads", 0, countItems(headVisits));
+            printer.write("stats-iterations", 0, countItems(iterations));
+            printer.write("stats-components", 0, countItems(components));
+        }
+
+        // function/block, or function/#N for the Nth unnamed block.
+        static std::string blockName(llvm::BasicBlock *BB)
+        {
+            std::string name = BB->getParent()->getName().str() + "/";
+            if (BB->hasName()) {
+                return name + BB->getName().str();
+            }
+            int position = 0;
+            for (auto &other: *BB->getParent()) {
+                if (&other == BB) {
+                    break;
+                }
+                ++position;
+            }
+            return name + "#" + std::to_string(position);
+        }
+
+    private:
+        struct Phase {
+            long long nanoseconds = 0;
+            long calls = 0;
+        };
+
+        static void printCounts(const char *label, const std::map<std::string, long> &counts)
+        {
+            for (auto &entry: counts) {
+                std::cout << label << " " << entry.first << ": " << entry.second << "\n";
+            }
+        }
+
+        static std::vector<ResultItem> countItems(const std::map<std::string, long> &counts)
+        {
+            std::vector<ResultItem> items;
+            for (auto &entry: counts) {
+                items.push_back(ResultItem::count(entry.first, entry.second));
+            }
+            return items;
+        }
+
+        std::map<std::string, Phase> phases;
+        std::map<std::string, long> counters;
+        std::map<std::string, long> opcodes;
+        std::map<std::string, long> headVisits;
+        std::map<std::string, long> iterations;
+        std::map<std::string, long> components;
+};
+
+// The statistics of the run on this thread, or null when not collecting.
+inline AnalysisStats *&activeStats()
+{
+    static thread_local AnalysisStats *stats = nullptr;
+    return stats;
+}
+
+inline void countStat(const char *name, long n = 1)
+{
+    if (AnalysisStats *stats = activeStats()) {
+        stats->count(name, n);
+    }
+}
+
+// Adds the time until the end of the scope to a phase, on a monotonic clock.
+class PhaseTimer {
+    public:
+        explicit PhaseTimer(const char *phase): phase(phase), stats(activeStats())
+        {
+            if (stats != nullptr) {
+                start = std::chrono::steady_clock::now();
+            }
+        }
+
+        ~PhaseTimer()
+        {
+            if (stats != nullptr) {
+                stats->addTime(phase, std::chrono::steady_clock::now() - start);
+            }
+        }
+
+    private:
+        const char *phase;
+        AnalysisStats *stats;
+        std::chrono::steady_clock::time_point start;
+};
+
+#endif
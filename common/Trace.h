@@ -0,0 +1,60 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstring>
+
+// Trace levels; each includes the ones before it.
+//   summary      once per function (banners, per-function totals)
+//   block        each block visit: its states, loop and fixpoint notes
+//   instruction  the value of each instruction after its transfer
+#define TRACE_OFF 0
+#define TRACE_SUMMARY 1
+#define TRACE_BLOCK 2
+#define TRACE_INSTRUCTION 3
+
+// Highest level compiled in. Build with -DTRACE_MAX_LEVEL=0 to drop every
+// TRACE statement from the binary, or with a lower level to drop the noisier
+// ones; the rest stay selectable with --trace.
+#ifndef TRACE_MAX_LEVEL
+#define TRACE_MAX_LEVEL TRACE_INSTRUCTION
+#endif
+
+// What the tools printed before levels existed.
+#define TRACE_DEFAULT TRACE_BLOCK
+
+// The level selected at run time. It is per thread, so runs side by side in
+// batchAnalysis each keep their own.
+inline int &traceLevel()
+{
+    static thread_local int level = TRACE_DEFAULT;
+    return level;
+}
+
+// Parses an off|summary|block|instruction name into level.
+inline bool parseTraceLevel(const char *name, int &level)
+{
+    const char *names[] = {"off", "summary", "block", "instruction"};
+    for (int i = TRACE_OFF; i <= TRACE_INSTRUCTION; ++i) {
+        if (strcmp(name, names[i]) == 0) {
+            level = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// TRACE(level, statements) runs the statements when level is selected. A
+// level above TRACE_MAX_LEVEL is a constant false test the compiler drops,
+// and with TRACE_MAX_LEVEL at TRACE_OFF the statements are not compiled.
+#if TRACE_MAX_LEVEL > TRACE_OFF
+#define TRACE(level, ...) \
+    do { \
+        if ((level) <= TRACE_MAX_LEVEL && (level) <= traceLevel()) { \
+            __VA_ARGS__; \
+        } \
+    } while (0)
+#else
+#define TRACE(level, ...) do {} while (0)
+#endif
+
+#endif
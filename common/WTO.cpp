@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <climits>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/InstrTypes.h"
+#include "llvm/IR/Instructions.h"
+#include "CFG.h"
+#include "WTO.h"
+
+using namespace llvm;
+using namespace std;
+
+// Done with, so no longer on the stack of open blocks.
+#define WTO_FINISHED UINT_MAX
+
+// A call of visit or component in Bourdoncle's recursive algorithm, kept on
+// an explicit stack so deep CFGs cannot overflow the native one. A visit
+// whose block turns out to head a loop becomes the component call in place.
+// target is the frame whose body the result goes into, -1 for the top level.
+struct WTOFrame {
+    BasicBlock *block;
+    unsigned succIdx;
+    unsigned head;
+    bool loop;
+    bool component;
+    int target;
+    vector<WTOElement> body;
+};
+
+WeakTopologicalOrder::WeakTopologicalOrder(Function &F)
+{
+    map<BasicBlock*, unsigned> dfn;
+    vector<BasicBlock*> open;
+    vector<WTOFrame> frames;
+    unsigned num = 0;
+
+    // Partitions are built back to front, as the algorithm prepends to
+    // them, and reversed once complete.
+    auto partition = [&](int target) -> vector<WTOElement>& {
+        return target < 0 ? top : frames[target].body;
+    };
+    auto visit = [&](BasicBlock *BB, int target) {
+        dfn[BB] = ++num;
+        open.push_back(BB);
+        frames.push_back(WTOFrame{BB, 0, num, false, false, target, vector<WTOElement>()});
+    };
+
+    visit(dyn_cast<BasicBlock>(F.begin()), -1);
+    while (!frames.empty()) {
+        WTOFrame &frame = frames.back();
+        const Terminator *TInst = frame.block->getTerminator();
+        if (frame.succIdx < TInst->getNumSuccessors()) {
+            BasicBlock *Succ = TInst->getSuccessor(frame.succIdx++);
+            unsigned succNum = dfn[Succ];
+            if (frame.component) {
+                if (succNum == 0) {
+                    visit(Succ, frames.size() - 1);
+                }
+            } else if (succNum == 0) {
+                visit(Succ, frame.target);
+            } else if (succNum <= frame.head) {
+                frame.head = succNum;
+                frame.loop = true;
+            }
+            continue;
+        }
+
+        unsigned head = frame.head;
+        if (frame.component) {
+            reverse(frame.body.begin(), frame.body.end());
+            WTOElement element{frame.block, true, move(frame.body)};
+            int target = frame.target;
+            frames.pop_back();
+            partition(target).push_back(move(element));
+        } else if (head == dfn[frame.block]) {
+            dfn[frame.block] = WTO_FINISHED;
+            BasicBlock *last = open.back();
+            open.pop_back();
+            if (frame.loop) {
+                // The blocks of the loop are visited again inside it.
+                while (last != frame.block) {
+                    dfn[last] = 0;
+                    last = open.back();
+                    open.pop_back();
+                }
+                heads.insert(frame.block);
+                frame.component = true;
+                frame.succIdx = 0;
+                continue;
+            }
+            int target = frame.target;
+            frames.pop_back();
+            partition(target).push_back(WTOElement{last, false, vector<WTOElement>()});
+        } else {
+            frames.pop_back();
+        }
+
+        // What visit returns goes to the visit that called it.
+        if (!frames.empty() && !frames.back().component && head <= frames.back().head) {
+            frames.back().head = head;
+            frames.back().loop = true;
+        }
+    }
+    reverse(top.begin(), top.end());
+}
+
+vector<BasicBlock*> WeakTopologicalOrder::blocks() const
+{
+    // Elements still to list, innermost last, so nesting needs no recursion.
+    vector<BasicBlock*> order;
+    vector<pair<const vector<WTOElement>*, size_t>> stack(1, make_pair(&top, (size_t) 0));
+    while (!stack.empty()) {
+        const vector<WTOElement> &elements = *stack.back().first;
+        size_t i = stack.back().second;
+        if (i == elements.size()) {
+            stack.pop_back();
+            continue;
+        }
+        ++stack.back().second;
+        order.push_back(elements[i].block);
+        if (elements[i].component) {
+            stack.push_back(make_pair(&elements[i].body, (size_t) 0));
+        }
+    }
+    return order;
+}
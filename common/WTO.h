@@ -0,0 +1,50 @@
+#ifndef WTO_H
+#define WTO_H
+
+#include <set>
+#include <vector>
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+
+// One element of a weak topological order: a single block, or a component,
+// a loop whose head is block and whose nested elements are body.
+struct WTOElement {
+    llvm::BasicBlock *block;
+    bool component;
+    std::vector<WTOElement> body;
+};
+
+// Bourdoncle's weak topological order of the blocks reachable from F's
+// entry: a topological order in which every cycle is a component. Its
+// recursive iteration strategy runs each element in order and repeats a
+// component, head then body, until the state at its head is stable, so
+// widening and stabilization checks are only needed at component heads.
+class WeakTopologicalOrder {
+    public:
+        explicit WeakTopologicalOrder(llvm::Function &F);
+
+        const std::vector<WTOElement> &elements() const
+        {
+            return top;
+        }
+
+        // Every block once, a head before its body, as the iteration
+        // strategy first reaches them.
+        std::vector<llvm::BasicBlock*> blocks() const;
+
+        bool isHead(llvm::BasicBlock *BB) const
+        {
+            return heads.count(BB) != 0;
+        }
+
+        bool hasLoops() const
+        {
+            return !heads.empty();
+        }
+
+    private:
+        std::vector<WTOElement> top;
+        std::set<llvm::BasicBlock*> heads;
+};
+
+#endif
@@ -0,0 +1,318 @@
+#ifndef ZONE_H
+#define ZONE_H
+
+#include <cstddef>
+#include <cstdint>
+#include "../common/Arena.h"
+
+// An unbounded difference. Every finite bound lies strictly between
+// -ZONE_LIMIT and ZONE_LIMIT; a bound past that is dropped, or raised to
+// -ZONE_LIMIT + 1, which only loses precision.
+#define ZONE_INFINITY INT32_MAX
+#define ZONE_LIMIT (1 << 29)
+
+// Rows of the band the closure relaxes over together, 32 rows of 2KB for
+// 512 variables, which stay in a level-two cache while every other row
+// goes past them once.
+#define ZONE_BAND 32
+
+// row[j] = min(row[j], through + other[j]) for j < n: the paths from row's
+// variable over the one of other, through being the finite bound between
+// the two. Any bound of ZONE_LIMIT or more is infinite, ZONE_INFINITY or a
+// sum an earlier relaxation of the same pass left there, and counts as
+// 2 * ZONE_LIMIT, so a path over it stays at least ZONE_LIMIT, infinite
+// too, without overflowing; Zone::normalize turns those back into
+// ZONE_INFINITY once the pass is over. A straight loop of min, add and max
+// over two contiguous rows, which the compiler vectorizes.
+inline void relaxRow(int32_t *row, int32_t through, const int32_t *other, size_t n)
+{
+    for (size_t j = 0; j < n; ++j) {
+        int32_t path = through + (other[j] < ZONE_LIMIT ? other[j] : 2 * ZONE_LIMIT);
+        path = path > -ZONE_LIMIT ? path : -ZONE_LIMIT + 1;
+        row[j] = path < row[j] ? path : row[j];
+    }
+}
+
+// bound + offset, saturated into the finite range; an infinite bound stays.
+inline int32_t shiftBound(int32_t bound, int64_t offset)
+{
+    if (bound == ZONE_INFINITY) {
+        return ZONE_INFINITY;
+    }
+    int64_t shifted = bound + offset;
+    if (shifted >= ZONE_LIMIT) {
+        return ZONE_INFINITY;
+    }
+    return shifted <= -ZONE_LIMIT ? -ZONE_LIMIT + 1 : (int32_t) shifted;
+}
+
+// A conjunction of constraints v_j - v_i <= c over variables 1..n, with
+// variable 0 standing for the constant 0: bound(0, x) is the upper bound of
+// x and -bound(x, 0) its lower one. The bounds are a difference-bound
+// matrix in one contiguous row-major array.
+//
+// Reads expect the matrix closed, every bound the tightest the others
+// imply, which makes each one a single lookup. The assignments keep it
+// closed in O(n) and addConstraint in O(n^2); only widening leaves a
+// matrix that is not, and the next change closes it first, in O(n^3) by
+// Floyd-Warshall over bands of rows. Printing first calls close, which costs
+// nothing on a closed matrix.
+class Zone {
+    public:
+        Zone() {}
+        explicit Zone(unsigned variables): dim(variables + 1), bounds((size_t) dim * dim, ZONE_INFINITY)
+        {
+            for (unsigned i = 0; i < dim; ++i) {
+                at(i, i) = 0;
+            }
+        }
+
+        unsigned variables() const
+        {
+            return dim - 1;
+        }
+
+        // Whether the constraints contradict each other, as a closure that
+        // finds a negative cycle tells.
+        bool isEmpty() const
+        {
+            return empty;
+        }
+
+        // Whether every bound is the tightest the others imply.
+        bool isClosed() const
+        {
+            return closed;
+        }
+
+        // The upper bound of v_j - v_i, ZONE_INFINITY if there is none.
+        int32_t bound(unsigned i, unsigned j) const
+        {
+            return bounds[(size_t) i * dim + j];
+        }
+
+        int32_t upper(unsigned x) const
+        {
+            return bound(0, x);
+        }
+
+        // -ZONE_INFINITY if x has no lower bound.
+        int32_t lower(unsigned x) const
+        {
+            return bound(x, 0) == ZONE_INFINITY ? -ZONE_INFINITY : -bound(x, 0);
+        }
+
+        // The largest |v_x - v_y|, ZONE_INFINITY if it has no bound.
+        int32_t sep(unsigned x, unsigned y) const
+        {
+            int32_t ahead = bound(x, y);
+            int32_t behind = bound(y, x);
+            if (ahead == ZONE_INFINITY || behind == ZONE_INFINITY) {
+                return ZONE_INFINITY;
+            }
+            return ahead > behind ? ahead : behind;
+        }
+
+        // Floyd-Warshall a band of ZONE_BAND steps at a time: the band's
+        // own rows over its steps first, which leaves them as they will be
+        // after the band, then every other row over the same steps against
+        // them. Each row is relaxed whole, which gives the vector loop long
+        // runs.
+        void close()
+        {
+            if (closed) {
+                return;
+            }
+            closed = true;
+            for (unsigned band = 0; band < dim; band += ZONE_BAND) {
+                unsigned bandEnd = band + ZONE_BAND < dim ? band + ZONE_BAND : dim;
+                for (unsigned step = band; step < bandEnd; ++step) {
+                    for (unsigned row = band; row < bandEnd; ++row) {
+                        relaxOver(row, step);
+                    }
+                }
+                for (unsigned row = 0; row < dim; ++row) {
+                    for (unsigned step = band; step < bandEnd && (row < band || row >= bandEnd); ++step) {
+                        relaxOver(row, step);
+                    }
+                }
+            }
+            normalize();
+            for (unsigned i = 0; i < dim; ++i) {
+                empty = empty || at(i, i) < 0;
+                at(i, i) = 0;
+            }
+        }
+
+        // Adds v_j - v_i <= c and leaves closing to the next read or
+        // change: many constraints at once are cheaper so, with one close
+        // after them, than each through addConstraint.
+        void constrain(unsigned i, unsigned j, int64_t c)
+        {
+            int32_t edge = shiftBound(0, c);
+            if (edge < bound(i, j)) {
+                at(i, j) = edge;
+                closed = false;
+            }
+        }
+
+        // Adds v_j - v_i <= c and closes the matrix again incrementally:
+        // the only new paths are the ones over the new edge, so a <= b
+        // becomes at most a <= i, then c, then j <= b, one row at a time.
+        void addConstraint(unsigned i, unsigned j, int64_t c)
+        {
+            close();
+            int32_t edge = shiftBound(0, c);
+            if (empty || edge >= bound(i, j)) {
+                return;
+            }
+            if (bound(j, i) != ZONE_INFINITY && (int64_t) bound(j, i) + edge < 0) {
+                empty = true;
+                return;
+            }
+            // Row j and column i stay as they are: a path over the edge
+            // from j or to i would close a cycle, which is not negative.
+            const int32_t *target = &at(j, 0);
+            for (unsigned a = 0; a < dim; ++a) {
+                int32_t through = shiftBound(at(a, i), edge);
+                if (a != j && through != ZONE_INFINITY) {
+                    relaxRow(&at(a, 0), through, target, dim);
+                }
+            }
+            normalize();
+        }
+
+        // x loses every constraint.
+        void forget(unsigned x)
+        {
+            close();
+            for (unsigned k = 0; k < dim; ++k) {
+                at(x, k) = ZONE_INFINITY;
+                at(k, x) = ZONE_INFINITY;
+            }
+            at(x, x) = 0;
+        }
+
+        // x := v_y + c, with y = 0 for the constant c. x's row and column
+        // become y's, shifted; a closed matrix stays closed.
+        void assign(unsigned x, unsigned y, int64_t c)
+        {
+            close();
+            if (x == y) {
+                for (unsigned k = 0; k < dim; ++k) {
+                    if (k != x) {
+                        at(x, k) = shiftBound(at(x, k), -c);
+                        at(k, x) = shiftBound(at(k, x), c);
+                    }
+                }
+                return;
+            }
+            for (unsigned k = 0; k < dim; ++k) {
+                at(x, k) = shiftBound(at(y, k), -c);
+                at(k, x) = shiftBound(at(k, y), c);
+            }
+            at(x, x) = 0;
+        }
+
+        // x := some value in [low, high], -ZONE_INFINITY and ZONE_INFINITY
+        // leaving a side open. x is bound to the others only over
+        // variable 0, which keeps the matrix closed.
+        void assignRange(unsigned x, int64_t low, int64_t high)
+        {
+            forget(x);
+            int32_t lowBound = low <= -ZONE_LIMIT ? ZONE_INFINITY : shiftBound(0, -low);
+            int32_t highBound = shiftBound(0, high);
+            if (lowBound != ZONE_INFINITY && highBound != ZONE_INFINITY && highBound + lowBound < 0) {
+                empty = true;
+                return;
+            }
+            for (unsigned k = 0; k < dim; ++k) {
+                if (k != x) {
+                    at(x, k) = lowBound == ZONE_INFINITY ? ZONE_INFINITY : shiftBound(at(0, k), lowBound);
+                    at(k, x) = highBound == ZONE_INFINITY ? ZONE_INFINITY : shiftBound(at(k, 0), highBound);
+                }
+            }
+        }
+
+        // Standard widening, with this as the new state and old the last
+        // one: a bound that grew goes to infinity, the rest is old's. The
+        // result is left as it is, not closed, as closing it could bring
+        // back bounds it dropped and keep a loop from stabilizing.
+        //
+        // Returns whether the result differs from old, which the same pass
+        // tells: it is old exactly when no bound grew, and otherwise some
+        // finite bound of old became infinite. So a widened state needs no
+        // comparison of its own, and since bounds only ever go to
+        // infinity, a run of widenings stops changing after at most one
+        // round per bound.
+        bool widenWith(const Zone &old)
+        {
+            int32_t *next = bounds.data();
+            const int32_t *last = old.bounds.data();
+            size_t n = bounds.size();
+            int32_t grew = 0;
+            for (size_t e = 0; e < n; ++e) {
+                grew |= next[e] > last[e];
+                next[e] = next[e] > last[e] ? ZONE_INFINITY : last[e];
+            }
+            bool changed = grew != 0 || (old.empty && !empty);
+            closed = old.closed && grew == 0;
+            empty = empty && old.empty;
+            return changed;
+        }
+
+        // Whether both hold the same bounds, without stopping at the first
+        // difference so the loop vectorizes.
+        bool operator==(const Zone &other) const
+        {
+            if (dim != other.dim || empty != other.empty) {
+                return false;
+            }
+            const int32_t *mine = bounds.data();
+            const int32_t *theirs = other.bounds.data();
+            size_t n = bounds.size();
+            int32_t diff = 0;
+            for (size_t e = 0; e < n; ++e) {
+                diff |= mine[e] ^ theirs[e];
+            }
+            return diff == 0;
+        }
+
+        bool operator!=(const Zone &other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+        int32_t &at(unsigned i, unsigned j)
+        {
+            return bounds[(size_t) i * dim + j];
+        }
+
+        // Row over step, in Floyd-Warshall's order.
+        void relaxOver(unsigned row, unsigned step)
+        {
+            int32_t through = at(row, step);
+            if (row != step && through < ZONE_LIMIT) {
+                relaxRow(&at(row, 0), through, &at(step, 0), dim);
+            }
+        }
+
+        // Every bound relaxRow left at ZONE_LIMIT or above back to
+        // ZONE_INFINITY.
+        void normalize()
+        {
+            int32_t *bound = bounds.data();
+            size_t n = bounds.size();
+            for (size_t e = 0; e < n; ++e) {
+                bound[e] = bound[e] >= ZONE_LIMIT ? ZONE_INFINITY : bound[e];
+            }
+        }
+
+        unsigned dim = 1;
+        ArenaVector<int32_t> bounds = ArenaVector<int32_t>(1, 0);
+        bool closed = true;
+        bool empty = false;
+};
+
+#endif
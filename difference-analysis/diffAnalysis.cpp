@@ -16,6 +16,10 @@
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/InstrTypes.h"
 #include "llvm/IR/Type.h"
+#include "../common/IRInput.h"
+#include "../common/CFG.h"
+#include "../common/ResultFormat.h"
+#include "../common/Stats.h"
 
 using namespace llvm;
 using namespace std;
@@ -29,30 +33,72 @@ map<Value*, Value*> initVars(BasicBlock *BB);
 
 int main(int argc, char **argv)
 {
-    // Read the IR file.
-    LLVMContext &Context = getGlobalContext();
+    // Read the IR file, textual or bitcode; "-" reads standard input. The
+    // context is owned by this run, so runs on other threads never share one.
+    LLVMContext Context;
     SMDiagnostic Err;
-    Module *M = ParseIRFile(argv[1], Err, Context);
+    auto parseStart = chrono::steady_clock::now();
+    Module *M = loadModule(argv[1], Err, Context);
+    auto parseTime = chrono::steady_clock::now() - parseStart;
     if (M == nullptr)
     {
         fprintf(stderr, "error: failed to load LLVM IR file \"%s\"", argv[1]);
         return EXIT_FAILURE;
     }
 
+    // --stats reports phase times and counters after the results (see
+    // common/Stats.h), as the loop analyses do.
+    bool wantStats = false;
+    for (int i = 2; i < argc; ++i) {
+        if (strcmp(argv[i], "--stats") == 0) {
+            wantStats = true;
+        } else {
+            fprintf(stderr, "error: unknown option \"%s\"\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    AnalysisStats stats;
+    activeStats() = wantStats ? &stats : nullptr;
+    if (wantStats) {
+        stats.addTime("parse", parseTime);
+    }
+
     map<Value*, Value*> varMap;
 
     int blkCount = 1;
     for (auto &F: *M)
         if (strncmp(F.getName().str().c_str(), "main", 4) == 0) {
+            {
+                PhaseTimer timer("parse");
+                if (!materialize(F)) {
+                    return EXIT_FAILURE;
+                }
+            }
             BasicBlock* BB = dyn_cast<BasicBlock>(F.begin());
             varMap = initVars(BB);
-            traverseCFG(BB, blkCount, varMap);
+            int startCount = blkCount;
+            {
+                PhaseTimer timer("solve");
+                traverseCFG(BB, blkCount, varMap);
+            }
+            if (wantStats) {
+                stats.addIterations(F.getName().str(), blkCount - startCount);
+            }
         }
+
+    if (wantStats) {
+        stats.print(ResultPrinter("diffAnalysis"));
+        activeStats() = nullptr;
+    }
     return 0;
 }
 
 void updateVars(Instruction &I, map<Value*, Value*> &varMap)
 {
+    PhaseTimer timer("transfer");
+    if (AnalysisStats *stats = activeStats()) {
+        stats->countOpcode(I.getOpcodeName());
+    }
     if (isa<LoadInst>(&I)) {
         Value *inst = dyn_cast<Value>(&I);
         Value *op = I.getOperand(0);
@@ -84,7 +130,7 @@ void updateVars(Instruction &I, map<Value*, Value*> &varMap)
         ConstantInt *result;
         int const1;
         int const2;
-        IntegerType *globalType = Type::getInt32Ty(getGlobalContext());
+        IntegerType *globalType = Type::getInt32Ty(I.getContext());
 
         if (iter1 != varMap.end() && iter2 != varMap.end()) {
             constInt1 = dyn_cast<ConstantInt>(iter1->second);
@@ -167,16 +213,23 @@ void traverseCFG(
     for (auto &I: *BB) {
         updateVars(I, varMap);
     }
+    countStat("block visits");
 
-    cout << "Block " << blkCount << ":" << endl;
-    printResult(varMap);
+    {
+        PhaseTimer timer("print");
+        cout << "Block " << blkCount << ":" << endl;
+        printResult(varMap);
+    }
 
     ++blkCount;
 
-    const TerminatorInst *TInst = BB->getTerminator();
+    const Terminator *TInst = BB->getTerminator();
     unsigned int NSucc = TInst->getNumSuccessors();
     for (unsigned i = 0; i < NSucc; ++i) {
         BasicBlock *Succ = TInst->getSuccessor(i);
+        if (AnalysisStats *stats = activeStats()) {
+            stats->countEdge(BB, Succ);
+        }
         traverseCFG(Succ, blkCount, varMap);
     }
 }
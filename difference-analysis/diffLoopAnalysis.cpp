@@ -5,6 +5,10 @@
 #include <algorithm>
 #include <cstring>
 #include <map>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cstdlib>
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Function.h"
@@ -12,637 +16,600 @@
 #include "llvm/IR/Instructions.h"
 #include "llvm/IRReader/IRReader.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_ostream.h"
 #include "llvm/IR/Value.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/InstrTypes.h"
 #include "llvm/IR/Type.h"
-
-#define EXTRA_ITERATION 4
+#include "../common/IRInput.h"
+#include "../common/CFG.h"
+#include "../common/WTO.h"
+#include "../common/ResultCache.h"
+#include "../common/OutputRedirect.h"
+#include "../common/ResultFormat.h"
+#include "../common/Trace.h"
+#include "../common/Arena.h"
+#include "Zone.h"
+#include "../common/Stats.h"
+#include "../common/AnalysisTools.h"
+
+// Number of rounds of a loop before its head's state is widened.
+#define WIDEN_DELAY 3
+
+// Bump whenever the printed result for the same IR changes.
+#define RESULT_VERSION 4
 
 using namespace llvm;
 using namespace std;
 
-void printResult(map<Value*, pair<Value*, Value*>> intervalMap);
+namespace difference {
+
+// The variables of a function, its entry block's allocas, in pointer order
+// as the old interval map kept them; variable k is v_{k+1} of the zone.
+struct DiffNumbering {
+    ArenaMap<Value*, unsigned> index;
+    ArenaVector<Value*> vars;
+};
+
+// What a loaded or computed value is: v_var + offset when var is not 0,
+// else some value in [low, high], ZONE_INFINITY standing for no bound. Only
+// variables live in the zone; these never outlive their block in the IR the
+// tool reads, and relate to the variables through var.
+struct Term {
+    unsigned var;
+    int64_t offset;
+    int64_t low;
+    int64_t high;
+};
+
+// The state flowing through the blocks: the zone over the variables and
+// the terms of the values computed so far.
+struct DiffState {
+    Zone zone;
+    ArenaMap<Value*, Term> terms;
+};
+
+// The zone each block last left with, once the loops around it are stable.
+typedef ArenaMap<BasicBlock*, Zone> BlockZones;
+
+DiffNumbering numberVars(BasicBlock *BB);
+void printResult(Zone &zone, const DiffNumbering &numbering);
+vector<ResultItem> resultItems(Zone &zone, const DiffNumbering &numbering);
+void printFinal(Function &F, BlockZones &exits, const DiffNumbering &numbering, const ResultPrinter &printer);
 void traverseCFG(
-    BasicBlock* BB,
+    Function &F,
+    int &blkCount,
+    DiffState &state,
+    BlockZones &exits,
+    const DiffNumbering &numbering,
+    const ResultPrinter &printer);
+void traverseElement(
+    const WTOElement &element,
+    int &blkCount,
+    DiffState &state,
+    BlockZones &exits,
+    const DiffNumbering &numbering,
+    const ResultPrinter &printer);
+void visitBlock(
+    BasicBlock *BB,
     int &blkCount,
-    int &reachedCount,
-    map<Value*, pair<Value*, Value*>> &intervalMap);
-map<Value*, pair<Value*, Value*>> initVars(BasicBlock *BB);
-pair<Value*, Value*> compareIntervals(pair<Value*, Value*> p1, pair<Value*, Value*> p2);
-bool reachFixedPoint(
-    map<Value*, pair<Value*, Value*>> oldMap,
-    map<Value*, pair<Value*, Value*>> newMap);
-
-int main(int argc, char **argv)
+    DiffState &state,
+    BlockZones &exits,
+    const DiffNumbering &numbering,
+    const ResultPrinter &printer);
+Term operandTerm(Value *V, const DiffState &state);
+void termRange(const Term &term, Zone &zone, int64_t &low, int64_t &high);
+bool reachFixedPoint(const Zone &oldZone, const Zone &newZone);
+
+int runLoopAnalysis(int argc, char **argv)
 {
-    // Read the IR file.
-    LLVMContext &Context = getGlobalContext();
+    // Read the IR file, textual or bitcode; "-" reads standard input. The
+    // context is owned by this run, so runs on other threads never share one.
+    LLVMContext Context;
     SMDiagnostic Err;
-    Module *M = ParseIRFile(argv[1], Err, Context);
+    auto parseStart = chrono::steady_clock::now();
+    Module *M = loadModule(argv[1], Err, Context);
+    auto parseTime = chrono::steady_clock::now() - parseStart;
     if (M == nullptr)
     {
         fprintf(stderr, "error: failed to load LLVM IR file \"%s\"", argv[1]);
         return EXIT_FAILURE;
     }
 
-    map<Value*, Value*> valMap;
-    map<Value*, pair<Value*, Value*>> intervalMap;
+    // --cache-dir DIR reuses results of unchanged functions from earlier runs.
+    // --format text|jsonl|binary picks how results are written (see
+    // common/ResultFormat.h); text is the default.
+    // --trace off|summary|block|instruction picks how much of the solving is
+    // shown besides the results (see common/Trace.h); block is the default.
+    // --stats reports phase times and solver counters after the results
+    // (see common/Stats.h).
+    traceLevel() = TRACE_DEFAULT;
+    bool wantStats = false;
+    ResultCache resultCache("diffLoopAnalysis", RESULT_VERSION);
+    ResultPrinter printer("diffLoopAnalysis");
+    for (int i = 2; i < argc; ++i) {
+        if (strcmp(argv[i], "--cache-dir") == 0 && i + 1 < argc) {
+            if (!resultCache.open(argv[++i])) {
+                fprintf(stderr, "error: cannot create cache directory \"%s\"\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            if (!printer.setFormat(argv[++i])) {
+                fprintf(stderr, "error: unknown format \"%s\"\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+            resultCache.addOption(argv[i - 1]);
+            resultCache.addOption(argv[i]);
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            if (!parseTraceLevel(argv[++i], traceLevel())) {
+                fprintf(stderr, "error: unknown trace level \"%s\"\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+            resultCache.addOption(argv[i - 1]);
+            resultCache.addOption(argv[i]);
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            wantStats = true;
+        } else {
+            fprintf(stderr, "error: unknown option \"%s\"\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // The report comes after all functions, so it never enters the cache.
+    AnalysisStats stats;
+    activeStats() = wantStats ? &stats : nullptr;
+    if (wantStats) {
+        stats.addTime("parse", parseTime);
+    }
+    printer.begin();
 
     int blkCount = 1;
-    int reachedCount = 0;
     for (auto &F: *M)
         if (strncmp(F.getName().str().c_str(), "main", 4) == 0) {
+            // The states of F, a matrix over its variables each, come from
+            // one arena freed at the end of the iteration.
+            ArenaScope arena;
+            {
+                PhaseTimer timer("parse");
+                if (!materialize(F)) {
+                    return EXIT_FAILURE;
+                }
+            }
+            printer.function = F.getName().str();
+            string key;
+            if (resultCache.enabled()) {
+                key = resultCache.key(F, to_string(blkCount));
+                string carriedOut, cached;
+                if (resultCache.lookup(key, carriedOut, cached)) {
+                    istringstream(carriedOut) >> blkCount;
+                    cout << cached;
+                    continue;
+                }
+            }
+            ostringstream captured;
+            streambuf *uncaptured = nullptr;
+            if (resultCache.enabled()) {
+                uncaptured = redirectOutput(captured.rdbuf());
+            }
+
             BasicBlock* BB = dyn_cast<BasicBlock>(F.begin());
-            intervalMap = initVars(BB);
-            traverseCFG(BB, blkCount, reachedCount, intervalMap);
+            DiffNumbering numbering = numberVars(BB);
+            DiffState state;
+            state.zone = Zone(numbering.vars.size());
+            BlockZones exits;
+            int startCount = blkCount;
+            {
+                PhaseTimer timer("solve");
+                traverseCFG(F, blkCount, state, exits, numbering, printer);
+            }
+            {
+                PhaseTimer timer("print");
+                printFinal(F, exits, numbering, printer);
+            }
+            if (wantStats) {
+                stats.addIterations(F.getName().str(), blkCount - startCount);
+            }
+
+            if (resultCache.enabled()) {
+                redirectOutput(uncaptured);
+                resultCache.store(key, to_string(blkCount), captured.str());
+                cout << captured.str();
+            }
+        }
+
+    if (resultCache.enabled()) {
+        if (printer.text()) {
+            cout << "Result cache: " << resultCache.hits << " hits, "
+                 << resultCache.misses << " misses\n";
+        } else {
+            vector<ResultItem> items;
+            items.push_back(ResultItem::count("hits", resultCache.hits));
+            items.push_back(ResultItem::count("misses", resultCache.misses));
+            printer.function.clear();
+            printer.write("result-cache", 0, items);
         }
+    }
+    if (wantStats) {
+        printer.function.clear();
+        stats.print(printer);
+        activeStats() = nullptr;
+    }
     return 0;
 }
 
-int multiMin(int a, int b, int c, int d) {
-    int array[4] = {a, b, c, d};
-    sort(array, array + 4);
-    return array[0];
+// a + b for two lower or two upper bounds; an infinite one wins.
+int64_t addBounds(int64_t a, int64_t b)
+{
+    if (a == ZONE_INFINITY || a == -ZONE_INFINITY) {
+        return a;
+    }
+    if (b == ZONE_INFINITY || b == -ZONE_INFINITY) {
+        return b;
+    }
+    return a + b;
 }
 
-int multiMax(int a, int b, int c, int d) {
-    int array[4] = {a, b, c, d};
-    sort(array, array + 4);
-    return array[3];
+// [low, high], without a bound the zone cannot hold.
+Term rangeTerm(int64_t low, int64_t high)
+{
+    Term term = {0, 0, -ZONE_INFINITY, ZONE_INFINITY};
+    if (low > -ZONE_LIMIT && low < ZONE_LIMIT) {
+        term.low = low;
+    }
+    if (high > -ZONE_LIMIT && high < ZONE_LIMIT) {
+        term.high = high;
+    }
+    return term;
+}
+
+Term varTerm(unsigned var, int64_t offset, Zone &zone)
+{
+    Term term = {var, offset, 0, 0};
+    if (offset <= -ZONE_LIMIT || offset >= ZONE_LIMIT) {
+        int64_t low, high;
+        termRange(term, zone, low, high);
+        return rangeTerm(low, high);
+    }
+    return term;
 }
 
-void updateVars(Instruction &I, map<Value*, pair<Value*, Value*>> &intervalMap)
+void updateVars(Instruction &I, DiffState &state, const DiffNumbering &numbering)
 {
-    IntegerType *globalType = Type::getInt32Ty(getGlobalContext());
+    PhaseTimer timer("transfer");
+    if (AnalysisStats *stats = activeStats()) {
+        stats->countOpcode(I.getOpcodeName());
+    }
+    Zone &zone = state.zone;
     if (isa<LoadInst>(&I)) {
-        Value *inst = dyn_cast<Value>(&I);
-        Value *op = I.getOperand(0);
-        auto iter = intervalMap.find(op);
-        pair<Value*, pair<Value*, Value*>> newPair = make_pair(inst, iter->second);
-        intervalMap.insert(newPair);
+        auto var = numbering.index.find(I.getOperand(0));
+        if (var != numbering.index.end()) {
+            state.terms[&I] = varTerm(var->second + 1, 0, zone);
+        } else {
+            state.terms[&I] = rangeTerm(-ZONE_INFINITY, ZONE_INFINITY);
+        }
     }
 
     if (isa<StoreInst>(&I)) {
-        Value *from = I.getOperand(0);
-        Value *to = I.getOperand(1);
-        auto iter = intervalMap.find(to);
-        ConstantInt *constInt = dyn_cast<ConstantInt>(from);
-        if (constInt == nullptr) {
-            auto jter = intervalMap.find(from);
-            ConstantInt *ic1 = dyn_cast<ConstantInt>(iter->second.first);
-            ConstantInt *ic2 = dyn_cast<ConstantInt>(iter->second.second);
-            ConstantInt *jc1 = dyn_cast<ConstantInt>(jter->second.first);
-            ConstantInt *jc2 = dyn_cast<ConstantInt>(jter->second.second);
-
-            if (jc1 != nullptr && jc2 != nullptr) {
-                if (ic1 != nullptr && ic2 != nullptr) {
-                    int minto = ic1->getSExtValue();
-                    int maxto = ic2->getSExtValue();
-                    int minfrom = jc1->getSExtValue();
-                    int maxfrom = jc2->getSExtValue();
-                    if (minfrom != minto && maxfrom != maxto && minfrom - minto == maxfrom - maxto) {
-                        iter->second.second = dyn_cast<Value>(ConstantFP::getInfinity(globalType));
-                    } else {
-                        iter->second = jter->second;
-                    }
-                }
-                if (ic1 == nullptr && ic2 == nullptr) {
-                    iter->second = jter->second;
-                }
-            }
-
-            if (jc1 == nullptr && jc2 == nullptr) {
-                iter->second = jter->second;
+        auto var = numbering.index.find(I.getOperand(1));
+        if (var == numbering.index.end()) {
+            return;
+        }
+        unsigned x = var->second + 1;
+        Term from = operandTerm(I.getOperand(0), state);
+
+        // Values read from x before keep what they were.
+        for (auto &entry: state.terms) {
+            if (entry.second.var == x) {
+                int64_t low, high;
+                termRange(entry.second, zone, low, high);
+                entry.second = rangeTerm(low, high);
             }
         }
-
-        if (constInt != nullptr) {
-            iter->second = make_pair(dyn_cast<Value>(constInt), dyn_cast<Value>(constInt));
+        if (from.var != 0) {
+            zone.assign(x, from.var, from.offset);
+        } else {
+            zone.assignRange(x, from.low, from.high);
         }
     }
 
     if (I.isBinaryOp()) {
-        Value *op1 = I.getOperand(0);
-        Value *op2 = I.getOperand(1);
-        auto iter1 = intervalMap.find(op1);
-        auto iter2 = intervalMap.find(op2);
-        pair<Value*, Value*> interval1;
-        pair<Value*, Value*> interval2;
-
-        if (iter1 != intervalMap.end() && iter2 != intervalMap.end()) {
-            interval1 = iter1->second;
-            interval2 = iter2->second;
-        }
-
-        if (iter1 != intervalMap.end() && iter2 == intervalMap.end()) {
-            interval1 = iter1->second;
-            interval2 = make_pair(op2, op2);
-        }
-
-        if (iter1 == intervalMap.end() && iter2 != intervalMap.end()) {
-            interval1 = make_pair(op1, op1);
-            interval2 = iter2->second;
-        }
-
-        IntegerType *globalType = Type::getInt32Ty(getGlobalContext());
-        ConstantFP *min1 = dyn_cast<ConstantFP>(interval1.first);
-        ConstantFP *max1 = dyn_cast<ConstantFP>(interval1.second);
-        ConstantFP *min2 = dyn_cast<ConstantFP>(interval2.first);
-        ConstantFP *max2 = dyn_cast<ConstantFP>(interval2.second);
-
-
-
-
-        Value *newMin;
-        Value *newMax;
-
-
-
+        Term term1 = operandTerm(I.getOperand(0), state);
+        Term term2 = operandTerm(I.getOperand(1), state);
+        int64_t min1, max1, min2, max2;
+        termRange(term1, zone, min1, max1);
+        termRange(term2, zone, min2, max2);
+        bool const1 = min1 == max1;
+        bool const2 = min2 == max2;
+
+        Term result = rangeTerm(-ZONE_INFINITY, ZONE_INFINITY);
         switch(I.getOpcode()) {
             case Instruction::Add:
-                if (min1 == nullptr && min2 == nullptr && max1 == nullptr && max2 == nullptr) {
-                    int minInt1 = dyn_cast<ConstantInt>(interval1.first)->getSExtValue();
-                    int minInt2 = dyn_cast<ConstantInt>(interval2.first)->getSExtValue();
-                    int maxInt1 = dyn_cast<ConstantInt>(interval1.second)->getSExtValue();
-                    int maxInt2 = dyn_cast<ConstantInt>(interval2.second)->getSExtValue();
-                    newMin = dyn_cast<Value>(ConstantInt::getSigned(globalType, minInt1 + minInt2));
-                    newMax = dyn_cast<Value>(ConstantInt::getSigned(globalType, maxInt1 + maxInt2));
-                } else if ((min1 != nullptr && min2 == nullptr && max1 == nullptr && max2 == nullptr) ||
-                    (min1 == nullptr && min2 != nullptr && max1 == nullptr && max2 == nullptr) ||
-                    (min1 != nullptr && min2 != nullptr && max1 == nullptr && max2 == nullptr)) {
-                    int maxInt1 = dyn_cast<ConstantInt>(interval1.second)->getSExtValue();
-                    int maxInt2 = dyn_cast<ConstantInt>(interval2.second)->getSExtValue();
-                    newMin = dyn_cast<Value>(min1);
-                    newMax = dyn_cast<Value>(ConstantInt::getSigned(globalType, maxInt1 + maxInt2));
-                } else if ((min1 == nullptr && min2 == nullptr && max1 != nullptr && max2 == nullptr) ||
-                    (min1 == nullptr && min2 == nullptr && max1 == nullptr && max2 != nullptr) ||
-                    (min1 == nullptr && min2 == nullptr && max1 != nullptr && max2 != nullptr)) {
-                    int minInt1 = dyn_cast<ConstantInt>(interval1.first)->getSExtValue();
-                    int minInt2 = dyn_cast<ConstantInt>(interval2.first)->getSExtValue();
-                    newMin = dyn_cast<Value>(ConstantInt::getSigned(globalType, minInt1 + minInt2));
-                    newMax = dyn_cast<Value>(max1);
-                } else if (min1 != nullptr && min2 == nullptr && max1 != nullptr && max2 == nullptr) {
-                    newMin = dyn_cast<Value>(min1);
-                    newMax = dyn_cast<Value>(max1);
-                } else if (min1 == nullptr && min2 != nullptr && max1 == nullptr && max2 != nullptr) {
-                    newMin = dyn_cast<Value>(min2);
-                    newMax = dyn_cast<Value>(max2);
+                if (term1.var != 0 && const2) {
+                    result = varTerm(term1.var, term1.offset + min2, zone);
+                } else if (const1 && term2.var != 0) {
+                    result = varTerm(term2.var, term2.offset + min1, zone);
                 } else {
-                    newMin = dyn_cast<Value>(min1);
-                    newMax = dyn_cast<Value>(max1);
+                    result = rangeTerm(addBounds(min1, min2), addBounds(max1, max2));
                 }
-
                 break;
             case Instruction::Sub:
-                if (min1 == nullptr && min2 == nullptr && max1 == nullptr && max2 == nullptr) {
-                    int minInt1 = dyn_cast<ConstantInt>(interval1.first)->getSExtValue();
-                    int minInt2 = dyn_cast<ConstantInt>(interval2.first)->getSExtValue();
-                    int maxInt1 = dyn_cast<ConstantInt>(interval1.second)->getSExtValue();
-                    int maxInt2 = dyn_cast<ConstantInt>(interval2.second)->getSExtValue();
-                    newMin = dyn_cast<Value>(ConstantInt::getSigned(globalType, minInt1 - maxInt2));
-                    newMax = dyn_cast<Value>(ConstantInt::getSigned(globalType, maxInt1 - minInt2));
-                }
-
-                if (min1 != nullptr && min2 == nullptr && max1 == nullptr && max2 == nullptr) {
-                    int minInt2 = dyn_cast<ConstantInt>(interval2.first)->getSExtValue();
-                    int maxInt1 = dyn_cast<ConstantInt>(interval1.second)->getSExtValue();
-                    newMin = dyn_cast<Value>(min1);
-                    newMax = dyn_cast<Value>(ConstantInt::getSigned(globalType, maxInt1 - minInt2));
-                }
-
-                if (min1 == nullptr && min2 != nullptr && max1 == nullptr && max2 == nullptr) {
-                    int minInt1 = dyn_cast<ConstantInt>(interval1.first)->getSExtValue();
-                    int maxInt2 = dyn_cast<ConstantInt>(interval2.second)->getSExtValue();
-                    newMin = dyn_cast<Value>(ConstantInt::getSigned(globalType, minInt1 - maxInt2));
-                    newMax = dyn_cast<Value>(ConstantFP::getInfinity(globalType));
-                }
-
-                if (min1 == nullptr && min2 == nullptr && max1 != nullptr && max2 == nullptr) {
-                    int minInt1 = dyn_cast<ConstantInt>(interval1.first)->getSExtValue();
-                    int maxInt2 = dyn_cast<ConstantInt>(interval2.second)->getSExtValue();
-                    newMin = dyn_cast<Value>(ConstantInt::getSigned(globalType, minInt1 - maxInt2));
-                    newMax = dyn_cast<Value>(max1);
-                }
-
-                if (min1 == nullptr && min2 == nullptr && max1 == nullptr && max2 != nullptr) {
-                    int minInt2 = dyn_cast<ConstantInt>(interval2.first)->getSExtValue();
-                    int maxInt1 = dyn_cast<ConstantInt>(interval1.second)->getSExtValue();
-                    newMin = dyn_cast<Value>(ConstantFP::getInfinity(globalType, true));
-                    newMax = dyn_cast<Value>(ConstantInt::getSigned(globalType, maxInt1 - minInt2));
-                }
-
-                if (min1 != nullptr && min2 == nullptr && max1 != nullptr && max2 == nullptr) {
-                    newMin = dyn_cast<Value>(min1);
-                    newMax = dyn_cast<Value>(max1);
-                }
-
-                if (min1 == nullptr && min2 != nullptr && max1 == nullptr && max2 != nullptr) {
-                    newMin = dyn_cast<Value>(min2);
-                    newMax = dyn_cast<Value>(max2);
-                }
-
-                if (min1 != nullptr && min2 != nullptr && max1 == nullptr && max2 == nullptr) {
-                    int maxInt1 = dyn_cast<ConstantInt>(interval1.second)->getSExtValue();
-                    int maxInt2 = dyn_cast<ConstantInt>(interval2.second)->getSExtValue();
-                    newMin = dyn_cast<Value>(min1);
-                    newMax = dyn_cast<Value>(ConstantInt::getSigned(globalType, max(maxInt1 - maxInt2, maxInt1 - maxInt2)));
-                }
-
-                if (min1 == nullptr && min2 == nullptr && max1 != nullptr && max2 != nullptr) {
-                    int minInt1 = dyn_cast<ConstantInt>(interval1.first)->getSExtValue();
-                    int minInt2 = dyn_cast<ConstantInt>(interval2.first)->getSExtValue();
-                    newMin = dyn_cast<Value>(ConstantInt::getSigned(globalType, min(minInt1 - minInt2, minInt2 - minInt1)));
-                    newMax = dyn_cast<Value>(max1);
-                }
-
-                if ((min1 != nullptr && min2 != nullptr) || (max1 != nullptr && max2 != nullptr) ||
-                    (min1 == nullptr && min2 != nullptr) || (max1 != nullptr && max2 == nullptr)) {
-                    newMin = dyn_cast<Value>(min1);
-                    newMax = dyn_cast<Value>(max1);
+                if (term1.var != 0 && const2) {
+                    result = varTerm(term1.var, term1.offset - min2, zone);
+                } else if (term1.var != 0 && term1.var == term2.var) {
+                    result = rangeTerm(term1.offset - term2.offset, term1.offset - term2.offset);
+                } else if (term1.var != 0 && term2.var != 0) {
+                    // The difference itself is what the zone bounds.
+                    zone.close();
+                    int32_t ahead = zone.bound(term2.var, term1.var);
+                    int32_t behind = zone.bound(term1.var, term2.var);
+                    int64_t offset = term1.offset - term2.offset;
+                    result = rangeTerm(behind == ZONE_INFINITY ? -ZONE_INFINITY : offset - behind,
+                                       ahead == ZONE_INFINITY ? ZONE_INFINITY : offset + ahead);
+                } else {
+                    result = rangeTerm(addBounds(min1, -max2), addBounds(max1, -min2));
                 }
-
                 break;
             case Instruction::Mul:
-                if (min1 == nullptr && min2 == nullptr && max1 == nullptr && max2 == nullptr) {
-                    int minInt1 = dyn_cast<ConstantInt>(interval1.first)->getSExtValue();
-                    int minInt2 = dyn_cast<ConstantInt>(interval2.first)->getSExtValue();
-                    int maxInt1 = dyn_cast<ConstantInt>(interval1.second)->getSExtValue();
-                    int maxInt2 = dyn_cast<ConstantInt>(interval2.second)->getSExtValue();
-                    int min = multiMin(minInt1 * maxInt1, minInt1 * maxInt2, minInt2 * maxInt1, minInt2 * maxInt2);
-                    int max = multiMax(minInt1 * maxInt1, minInt1 * maxInt2, minInt2 * maxInt1, minInt2 * maxInt2);
-                    newMin = dyn_cast<Value>(ConstantInt::getSigned(globalType, min));
-                    newMax = dyn_cast<Value>(ConstantInt::getSigned(globalType, max));
-                }
-
-                if (min1 != nullptr && min2 == nullptr && max1 == nullptr && max2 == nullptr) {
-                    int minInt2 = dyn_cast<ConstantInt>(interval2.first)->getSExtValue();
-                    int maxInt1 = dyn_cast<ConstantInt>(interval1.second)->getSExtValue();
-                    int maxInt2 = dyn_cast<ConstantInt>(interval2.second)->getSExtValue();
-                    if (dyn_cast<ConstantInt>(interval2.first)->isNegative() && dyn_cast<ConstantInt>(interval2.second)->isNegative()) {
-                        newMin = dyn_cast<Value>(ConstantInt::getSigned(globalType, min(maxInt1 * minInt2, maxInt1 * maxInt2)));
-                        newMax = dyn_cast<Value>(ConstantFP::getInfinity(globalType));
-                    }
-
-                    if (dyn_cast<ConstantInt>(interval2.first)->isNegative() && !dyn_cast<ConstantInt>(interval2.second)->isNegative()) {
-                        newMin = dyn_cast<Value>(min1);
-                        newMax = dyn_cast<Value>(ConstantFP::getInfinity(globalType));
-                    }
-
-                    if (!dyn_cast<ConstantInt>(interval2.first)->isNegative() && !dyn_cast<ConstantInt>(interval2.second)->isNegative()) {
-                        newMin = dyn_cast<Value>(min1);
-                        newMax = dyn_cast<Value>(ConstantInt::getSigned(globalType, max(maxInt1 * minInt2, maxInt1 * maxInt2)));
-                    }
-                }
-
-                if (min1 == nullptr && min2 != nullptr && max1 == nullptr && max2 == nullptr) {
-                    int minInt1 = dyn_cast<ConstantInt>(interval2.first)->getSExtValue();
-                    int maxInt1 = dyn_cast<ConstantInt>(interval1.second)->getSExtValue();
-                    int maxInt2 = dyn_cast<ConstantInt>(interval2.second)->getSExtValue();
-                    if (dyn_cast<ConstantInt>(interval1.first)->isNegative() && dyn_cast<ConstantInt>(interval1.second)->isNegative()) {
-                        newMin = dyn_cast<Value>(ConstantInt::getSigned(globalType, min(maxInt2 * minInt1, maxInt2 * maxInt1)));
-                        newMax = dyn_cast<Value>(ConstantFP::getInfinity(globalType));
-                    }
-
-                    if (dyn_cast<ConstantInt>(interval1.first)->isNegative() && !dyn_cast<ConstantInt>(interval1.second)->isNegative()) {
-                        newMin = dyn_cast<Value>(min2);
-                        newMax = dyn_cast<Value>(ConstantFP::getInfinity(globalType));
-                    }
-
-                    if (!dyn_cast<ConstantInt>(interval1.first)->isNegative() && !dyn_cast<ConstantInt>(interval1.second)->isNegative()) {
-                        newMin = dyn_cast<Value>(min2);
-                        newMax = dyn_cast<Value>(ConstantInt::getSigned(globalType, max(maxInt2 * minInt1, maxInt2 * maxInt1)));
-                    }
-                }
-
-                if (min1 == nullptr && min2 == nullptr && max1 != nullptr && max2 == nullptr) {
-                    int minInt1 = dyn_cast<ConstantInt>(interval1.first)->getSExtValue();
-                    int minInt2 = dyn_cast<ConstantInt>(interval2.first)->getSExtValue();
-                    int maxInt2 = dyn_cast<ConstantInt>(interval2.second)->getSExtValue();
-                    if (dyn_cast<ConstantInt>(interval2.first)->isNegative() && dyn_cast<ConstantInt>(interval2.second)->isNegative()) {
-                        newMin = dyn_cast<Value>(ConstantFP::getInfinity(globalType, true));
-                        newMax = dyn_cast<Value>(ConstantInt::getSigned(globalType, max(minInt1 * maxInt2, minInt1 * minInt2)));
-                    }
-
-                    if (dyn_cast<ConstantInt>(interval2.first)->isNegative() && !dyn_cast<ConstantInt>(interval2.second)->isNegative()) {
-                        newMin = dyn_cast<Value>(ConstantFP::getInfinity(globalType, true));
-                        newMax = dyn_cast<Value>(max1);
-                    }
-
-                    if (!dyn_cast<ConstantInt>(interval2.first)->isNegative() && !dyn_cast<ConstantInt>(interval2.second)->isNegative()) {
-                        newMin = dyn_cast<Value>(ConstantInt::getSigned(globalType, min(minInt1 * minInt2, minInt1 * maxInt2)));
-                        newMax = dyn_cast<Value>(max1);
-                    }
-                }
-
-                if (min1 == nullptr && min2 == nullptr && max1 == nullptr && max2 != nullptr) {
-                    int minInt1 = dyn_cast<ConstantInt>(interval1.first)->getSExtValue();
-                    int maxInt1 = dyn_cast<ConstantInt>(interval1.second)->getSExtValue();
-                    int minInt2 = dyn_cast<ConstantInt>(interval2.first)->getSExtValue();
-                    if (dyn_cast<ConstantInt>(interval1.first)->isNegative() && dyn_cast<ConstantInt>(interval1.second)->isNegative()) {
-                        newMin = dyn_cast<Value>(ConstantFP::getInfinity(globalType, true));
-                        newMax = dyn_cast<Value>(ConstantInt::getSigned(globalType, max(minInt1 * minInt2, maxInt1 * minInt2)));
-                    }
-
-                    if (dyn_cast<ConstantInt>(interval1.first)->isNegative() && !dyn_cast<ConstantInt>(interval1.second)->isNegative()) {
-                        newMin = dyn_cast<Value>(ConstantFP::getInfinity(globalType, true));
-                        newMax = dyn_cast<Value>(max2);
-                    }
-
-                    if (!dyn_cast<ConstantInt>(interval1.first)->isNegative() && !dyn_cast<ConstantInt>(interval1.second)->isNegative()) {
-                        newMin = dyn_cast<Value>(ConstantInt::getSigned(globalType, min(minInt1 * minInt2, maxInt1 * minInt2)));
-                        newMax = dyn_cast<Value>(max2);
-                    }
-                }
-
-                if (min1 != nullptr && min2 == nullptr && max1 != nullptr && max2 == nullptr) {
-                    newMin = dyn_cast<Value>(min1);
-                    newMax = dyn_cast<Value>(max1);
-                }
-
-                if (min1 == nullptr && min2 != nullptr && max1 == nullptr && max2 != nullptr) {
-                    newMin = dyn_cast<Value>(min2);
-                    newMax = dyn_cast<Value>(max2);
+                if ((const1 && min1 == 0) || (const2 && min2 == 0)) {
+                    result = rangeTerm(0, 0);
+                } else if (min1 != -ZONE_INFINITY && max1 != ZONE_INFINITY &&
+                           min2 != -ZONE_INFINITY && max2 != ZONE_INFINITY) {
+                    int64_t products[4] = {min1 * min2, min1 * max2, max1 * min2, max1 * max2};
+                    std::sort(products, products + 4);
+                    result = rangeTerm(products[0], products[3]);
                 }
                 break;
             case Instruction::SRem:
-                if (min1 == nullptr && min2 == nullptr && max1 == nullptr && max2 == nullptr) {
-                    int minInt1 = dyn_cast<ConstantInt>(interval1.first)->getSExtValue();
-                    int minInt2 = dyn_cast<ConstantInt>(interval2.first)->getSExtValue();
-                    int maxInt1 = dyn_cast<ConstantInt>(interval1.second)->getSExtValue();
-                    int maxInt2 = dyn_cast<ConstantInt>(interval2.second)->getSExtValue();
-                    if (minInt1 < minInt2 && minInt1 < maxInt2 && maxInt1 < minInt2 && maxInt1 < maxInt2) {
-                        newMin = dyn_cast<Value>(ConstantInt::getSigned(globalType, minInt1));
-                        newMax = dyn_cast<Value>(ConstantInt::getSigned(globalType, maxInt1));
-                        break;
-                    }
-                    int min;
-                    int max;
-                    int result;
-                    bool firstIter = true;
-                    for (int i = minInt1; i <= maxInt1; ++i) {
-                        for (int j = minInt2; j <= maxInt2; ++j) {
-                            result = i % j;
-                            if (firstIter == true) {
-                                min = result;
-                                max = result;
-                                firstIter = false;
-                            }
-                            if (result < min) {
-                                min = result;
-                            }
-                            if (result > max) {
-                                max = result;
-                            }
-                        }
+                // The remainder takes the sign of the dividend and is
+                // smaller than the divisor in magnitude.
+                if (const1 && const2 && min2 != 0) {
+                    result = rangeTerm(min1 % min2, min1 % min2);
+                } else if (min2 != 0 || max2 != 0) {
+                    int64_t limit = ZONE_INFINITY;
+                    if (min2 != -ZONE_INFINITY && max2 != ZONE_INFINITY) {
+                        limit = max(min2 < 0 ? -min2 : min2, max2 < 0 ? -max2 : max2) - 1;
                     }
-                    newMin = dyn_cast<Value>(ConstantInt::getSigned(globalType, min));
-                    newMax = dyn_cast<Value>(ConstantInt::getSigned(globalType, max));
-                }
-                if (min1 != nullptr && min2 == nullptr && max1 != nullptr && max2 == nullptr) {
-                    int maxInt2 = dyn_cast<ConstantInt>(interval2.second)->getSExtValue();
-                    newMin = dyn_cast<Value>(ConstantInt::getSigned(globalType, -(maxInt2 - 1)));
-                    newMax = dyn_cast<Value>(ConstantInt::getSigned(globalType, maxInt2 - 1));
-                }
-
-                if (min1 == nullptr && min2 != nullptr && max1 == nullptr && max2 != nullptr) {
-                    int minInt1 = dyn_cast<ConstantInt>(interval1.first)->getSExtValue();
-                    int maxInt1 = dyn_cast<ConstantInt>(interval1.second)->getSExtValue();
-                    newMin = dyn_cast<Value>(ConstantInt::getSigned(globalType, minInt1));
-                    newMax = dyn_cast<Value>(ConstantInt::getSigned(globalType, maxInt1));
-                }
-
-
-                if (min1 != nullptr && min2 != nullptr && max1 != nullptr && max2 != nullptr) {
-                    cerr << "Undefined Action" << endl;
-                    exit(EXIT_FAILURE);
+                    result = rangeTerm(max(min(min1, (int64_t) 0), -limit), min(max(max1, (int64_t) 0), limit));
                 }
+                break;
         }
-        pair<Value*, Value*> newInterval = make_pair(newMin, newMax);
-        intervalMap.insert(make_pair(dyn_cast<Value>(&I), newInterval));
+        state.terms[&I] = result;
+    }
+}
+
+// The term of an operand: a constant, a value computed before, or else
+// anything.
+Term operandTerm(Value *V, const DiffState &state)
+{
+    ConstantInt *constInt = dyn_cast<ConstantInt>(V);
+    if (constInt != nullptr && constInt->getBitWidth() <= 64) {
+        return rangeTerm(constInt->getSExtValue(), constInt->getSExtValue());
     }
+    auto iter = state.terms.find(V);
+    if (iter != state.terms.end()) {
+        return iter->second;
+    }
+    return rangeTerm(-ZONE_INFINITY, ZONE_INFINITY);
 }
 
-map<Value*, pair<Value*, Value*>> initVars(BasicBlock *BB)
+void termRange(const Term &term, Zone &zone, int64_t &low, int64_t &high)
 {
-    map<Value*, pair<Value*, Value*>> intervalMap;
+    if (term.var == 0) {
+        low = term.low;
+        high = term.high;
+        return;
+    }
+    zone.close();
+    low = addBounds(zone.lower(term.var), term.offset);
+    high = addBounds(zone.upper(term.var), term.offset);
+}
 
+DiffNumbering numberVars(BasicBlock *BB)
+{
+    DiffNumbering numbering;
     for (auto &I: *BB) {
         if (isa<AllocaInst>(I)) {
-            IntegerType *globalType = Type::getInt32Ty(getGlobalContext());
-            Constant *pInfinity = ConstantFP::getInfinity(globalType);
-            Constant *nInfinity = ConstantFP::getInfinity(globalType, true);
-            Value *pVal = dyn_cast<Value>(pInfinity);
-            Value *nVal = dyn_cast<Value>(nInfinity);
-            Value *allocVal = dyn_cast<Value>(&I);
-            pair<Value*, Value*> intPair = make_pair(nVal, pVal);
-            pair<Value*, pair<Value*, Value*>> valPair = make_pair(allocVal, intPair);
-            intervalMap.insert(valPair);
+            numbering.index[&I] = 0;
         }
     }
-    return intervalMap;
+    for (auto &entry: numbering.index) {
+        entry.second = numbering.vars.size();
+        numbering.vars.push_back(entry.first);
+    }
+    return numbering;
 }
 
-int sep(pair<Value*, Value*> p1, pair<Value*, Value*> p2)
+// Runs F's blocks in a weak topological order on the one state, each loop
+// until the state entering its head stops changing.
+void traverseCFG(
+    Function &F,
+    int &blkCount,
+    DiffState &state,
+    BlockZones &exits,
+    const DiffNumbering &numbering,
+    const ResultPrinter &printer)
 {
+    WeakTopologicalOrder order(F);
+    for (auto &element: order.elements()) {
+        traverseElement(element, blkCount, state, exits, numbering, printer);
+    }
+}
 
-    ConstantInt *minV1 = dyn_cast<ConstantInt>(p1.first);
-    ConstantInt *maxV1 = dyn_cast<ConstantInt>(p1.second);
-    ConstantInt *minV2 = dyn_cast<ConstantInt>(p2.first);
-    ConstantInt *maxV2 = dyn_cast<ConstantInt>(p2.second);
-
-    int result, last;
-    bool firstCheck = true;
-
-    for (int v1 = minV1->getSExtValue(); v1 <= maxV1->getSExtValue(); ++v1) {
-        for (int v2 = minV2->getSExtValue(); v2 <= maxV2->getSExtValue(); ++v2) {
-
-            if (firstCheck) {
-                result = v1;
-                firstCheck = false;
-            }
+// A loop runs head and body again until the zone it comes back to the head
+// with is the one it left with; after WIDEN_DELAY rounds that zone is
+// widened, so every loop stops.
+void traverseElement(
+    const WTOElement &element,
+    int &blkCount,
+    DiffState &state,
+    BlockZones &exits,
+    const DiffNumbering &numbering,
+    const ResultPrinter &printer)
+{
+    if (!element.component) {
+        visitBlock(element.block, blkCount, state, exits, numbering, printer);
+        return;
+    }
 
-            last = result;
+    long rounds = 0;
+    while (true) {
+        // A widened zone comes in unclosed; its closure is kept for when
+        // the loop stops, since it then leaves with the zone it came in
+        // with, rather than closed again by the next block.
+        Zone oldZone = state.zone;
+        Zone entered;
+        if (!oldZone.isClosed()) {
+            PhaseTimer timer("close");
+            countStat("closures");
+            state.zone.close();
+            entered = state.zone;
+        }
+        visitBlock(element.block, blkCount, state, exits, numbering, printer);
+        for (auto &inner: element.body) {
+            traverseElement(inner, blkCount, state, exits, numbering, printer);
+        }
+        ++rounds;
+        if (AnalysisStats *stats = activeStats()) {
+            stats->countHeadVisit(element.block);
+        }
 
-            if (v1 >= v2) {
-                result = v1 - v2;
-            } else {
-                result = v2 - v1;
+        bool stable;
+        if (rounds >= WIDEN_DELAY) {
+            PhaseTimer timer("widen");
+            countStat("widenings");
+            stable = !state.zone.widenWith(oldZone);
+        } else {
+            stable = reachFixedPoint(oldZone, state.zone);
+        }
+        if (stable) {
+            countStat("fixpoint hits");
+            if (!oldZone.isClosed()) {
+                state.zone = entered;
             }
-
-            result = max(last, result);
+            TRACE(TRACE_BLOCK, if (printer.text())
+                cout << "<-------- Reached the fixed point after " << rounds << " round(s) -------->\n");
+            break;
         }
     }
-    return result;
+    if (AnalysisStats *stats = activeStats()) {
+        stats->addComponentIterations(element.block, rounds);
+    }
 }
 
-void traverseCFG(
-    BasicBlock* BB,
+void visitBlock(
+    BasicBlock *BB,
     int &blkCount,
-    int &reachedCount,
-    map<Value*, pair<Value*, Value*>> &intervalMap)
+    DiffState &state,
+    BlockZones &exits,
+    const DiffNumbering &numbering,
+    const ResultPrinter &printer)
 {
-
-    map<Value*, pair<Value*, Value*>> oldMap = intervalMap;
-
     for (auto &I: *BB) {
-        updateVars(I, intervalMap);
+        updateVars(I, state, numbering);
     }
+    exits[BB] = state.zone;
 
-    cout << "Block " << blkCount << ":" << endl;
-    printResult(intervalMap);
+    TRACE(TRACE_BLOCK,
+        PhaseTimer timer("print");
+        if (printer.text()) {
+            cout << "Block " << blkCount << ":\n";
+            printResult(state.zone, numbering);
+        } else {
+            printer.write("block", blkCount, resultItems(state.zone, numbering));
+        });
 
     ++blkCount;
+    countStat("block visits");
+}
 
-    bool pointReached = reachFixedPoint(oldMap, intervalMap);
-
-    if (pointReached) {
-        ++reachedCount;
-        cout << "<-------- Reached the fixed point " << reachedCount << " time(s) -------->" << endl;
-    } else {
-        cout << "<---------- Reset the counter of reaching the same fixed point ---------->" << endl;
-        reachedCount = 0;
+// Whatever the trace level, each block F reached with the zone it last
+// left with, in F's order: "Block %label:" in text, a "final" record with
+// the block's position in F, counting from 1, otherwise.
+void printFinal(Function &F, BlockZones &exits, const DiffNumbering &numbering, const ResultPrinter &printer)
+{
+    if (printer.text()) {
+        cout << "=========== Final Result ===========\n";
     }
-
-    if (reachedCount == EXTRA_ITERATION) {
-        return;
+    int position = 0;
+    for (auto &BB: F) {
+        ++position;
+        auto found = exits.find(&BB);
+        if (found == exits.end()) {
+            continue;
+        }
+        if (printer.text()) {
+            string label;
+            raw_string_ostream labelStream(label);
+            BB.printAsOperand(labelStream, false);
+            cout << "Block " << labelStream.str() << ":\n";
+            printResult(found->second, numbering);
+        } else {
+            printer.write("final", position, resultItems(found->second, numbering));
+        }
     }
+}
 
-    const TerminatorInst *TInst = BB->getTerminator();
-    unsigned int NSucc = TInst->getNumSuccessors();
-    for (unsigned i = 0; i < NSucc; ++i) {
-        BasicBlock *Succ = TInst->getSuccessor(i);
-        traverseCFG(Succ, blkCount, reachedCount, intervalMap);
+// sep(a, b) of two named variables is a lookup in the closed zone.
+void printResult(Zone &zone, const DiffNumbering &numbering)
+{
+    zone.close();
+    const ArenaVector<Value*> &vars = numbering.vars;
+    for (unsigned i = 0; i < vars.size(); ++i) {
+        for (unsigned j = i + 1; j < vars.size(); ++j) {
+            if (!vars[i]->hasName() || !vars[j]->hasName()) continue;
+            cout << "sep(" << vars[i]->getName().str().c_str() << ", ";
+            cout << vars[j]->getName().str().c_str() << ") = ";
+
+            int32_t sep = zone.sep(i + 1, j + 1);
+            if (sep == ZONE_INFINITY) {
+                cout << "Infi";
+            } else {
+                cout << sep;
+            }
+            cout << "\n";
+        }
     }
 }
 
-void printResult(map<Value*, pair<Value*, Value*>> map)
+// The pairs printResult prints, as sep(%a,%b) with the ids in order since
+// sep is symmetric; an infinite separation has no upper bound.
+vector<ResultItem> resultItems(Zone &zone, const DiffNumbering &numbering)
 {
-    for (auto it = map.begin(); it != map.end(); ++it) {
-        for (auto jt = it; jt != map.end(); ++jt) {
-            Value *var1 = (*it).first;
-            pair<Value*, Value*> interval1 = (*it).second;
-            Value *var2 = (*jt).first;
-            pair<Value*, Value*> interval2 = (*jt).second;
-
-            if (var1 == var2 || !var1->hasName() || !var2->hasName()) continue;
-            cout << "sep(" << var1->getName().str().c_str() << ", ";
-            cout << var2->getName().str().c_str() << ") = ";
-
-            ConstantFP *minV1 = dyn_cast<ConstantFP>(interval1.first);
-            ConstantFP *maxV1 = dyn_cast<ConstantFP>(interval1.second);
-            ConstantFP *minV2 = dyn_cast<ConstantFP>(interval2.first);
-            ConstantFP *maxV2 = dyn_cast<ConstantFP>(interval2.second);
-
-            if (
-                (minV1 != nullptr && minV1->getValueAPF().isInfinity()) ||
-                (minV2 != nullptr && minV2->getValueAPF().isInfinity()) ||
-                (maxV1 != nullptr && maxV1->getValueAPF().isInfinity()) ||
-                (maxV2 != nullptr && maxV2->getValueAPF().isInfinity())) {
-                    cout << "Infi";
+    zone.close();
+    const ArenaVector<Value*> &vars = numbering.vars;
+    vector<ResultItem> items;
+    for (unsigned i = 0; i < vars.size(); ++i) {
+        for (unsigned j = i + 1; j < vars.size(); ++j) {
+            if (!vars[i]->hasName() || !vars[j]->hasName()) continue;
+
+            string id1 = resultId(vars[i]);
+            string id2 = resultId(vars[j]);
+            if (id2 < id1) {
+                swap(id1, id2);
             }
-
-            if (
-                minV1 == nullptr &&
-                minV2 == nullptr &&
-                maxV1 == nullptr &&
-                maxV2 == nullptr) {
-                    cout << sep(interval1, interval2);
+            string id = "sep(" + id1 + "," + id2 + ")";
+            int32_t sep = zone.sep(i + 1, j + 1);
+            if (sep == ZONE_INFINITY) {
+                items.push_back(ResultItem::bounds(id, false, 0, true, 0));
+            } else {
+                items.push_back(ResultItem::count(id, sep));
             }
-            cout << endl;
         }
     }
+    return items;
 }
 
-pair<Value*, Value*> compareIntervals(pair<Value*, Value*> p1, pair<Value*, Value*> p2)
+// Before widening starts, zones are compared bound by bound. Both are
+// closed then, or the comparison at worst misses a fixpoint for a round;
+// it never finds a false one. Widened rounds are decided by widenWith: the
+// old zone there is the last widening, unclosed, and it is stable exactly
+// when no bound of the new, closed zone exceeds its own, so every state
+// the new zone allows the old one allows too.
+bool reachFixedPoint(const Zone &oldZone, const Zone &newZone)
 {
-    IntegerType *globalType = Type::getInt32Ty(getGlobalContext());
-    ConstantFP *minV1 = dyn_cast<ConstantFP>(p1.first);
-    ConstantFP *maxV1 = dyn_cast<ConstantFP>(p1.second);
-    ConstantFP *minV2 = dyn_cast<ConstantFP>(p2.first);
-    ConstantFP *maxV2 = dyn_cast<ConstantFP>(p2.second);
-    ConstantInt *newMin;
-    ConstantInt *newMax;
-
-    if (minV1 == nullptr && minV2 != nullptr && minV2->getValueAPF().isInfinity()) {
-        newMin = dyn_cast<ConstantInt>(p1.first);
-    }
-
-    if (minV2 == nullptr && minV1 != nullptr && minV1->getValueAPF().isInfinity()) {
-        newMin = dyn_cast<ConstantInt>(p2.first);
-    }
-
-    if (minV1 == nullptr && minV2 == nullptr) {
-        ConstantInt *const1 = dyn_cast<ConstantInt>(p1.first);
-        ConstantInt *const2 = dyn_cast<ConstantInt>(p2.first);
-        int v1 = const1->getSExtValue();
-        int v2 = const2->getSExtValue();
-        newMin = ConstantInt::getSigned(globalType, max(v1, v2));
-    }
-
-    if (maxV1 == nullptr && maxV2 != nullptr && maxV2->getValueAPF().isInfinity()) {
-        newMax = dyn_cast<ConstantInt>(p1.second);
-    }
-
-    if (maxV2 == nullptr &&  maxV1 != nullptr && maxV1->getValueAPF().isInfinity()) {
-        newMax = dyn_cast<ConstantInt>(p2.second);
-    }
-
-    if (maxV1 == nullptr && maxV2 == nullptr) {
-        ConstantInt *const1 = dyn_cast<ConstantInt>(p1.second);
-        ConstantInt *const2 = dyn_cast<ConstantInt>(p2.second);
-        int v1 = const1->getSExtValue();
-        int v2 = const2->getSExtValue();
-        newMax = ConstantInt::getSigned(globalType, max(v1, v2));
-    }
-
-    return make_pair(dyn_cast<Value>(newMin), dyn_cast<Value>(newMax));
+    PhaseTimer timer("fixpoint check");
+    countStat("fixpoint checks");
+    return oldZone == newZone;
 }
 
-
-bool reachFixedPoint(
-    map<Value*, pair<Value*, Value*>> oldMap,
-    map<Value*, pair<Value*, Value*>> newMap) {
-      if (oldMap.size() != newMap.size()) return false;
-
-      for (auto it = newMap.begin(); it != newMap.end(); ++it) {
-          for (auto jt = oldMap.begin(); jt != oldMap.end(); ++jt) {
-              Value *var1 = it->first;
-              Value *var2 = jt->first;
-              if (oldMap.find(var1) == oldMap.end()) return false;
-              if (var1 == var2) {
-                  pair<Value*, Value*> interval1 = it->second;
-                  pair<Value*, Value*> interval2 = jt->second;
-                  ConstantFP *min1 = dyn_cast<ConstantFP>(interval1.first);
-                  ConstantFP *max1 = dyn_cast<ConstantFP>(interval1.second);
-                  ConstantFP *min2 = dyn_cast<ConstantFP>(interval2.first);
-                  ConstantFP *max2 = dyn_cast<ConstantFP>(interval2.second);
-
-                  if (
-                      (min1 == nullptr && min2 != nullptr) ||
-                      (min2 == nullptr && min1 != nullptr) ||
-                      (max1 == nullptr && max2 != nullptr) ||
-                      (max2 == nullptr && max1 != nullptr)) {
-                      return false;
-                  }
-
-                  if (min1 == nullptr && min2 == nullptr) {
-                      ConstantInt *const1 = dyn_cast<ConstantInt>(interval1.first);
-                      ConstantInt *const2 = dyn_cast<ConstantInt>(interval2.first);
-                      int v1 = const1->getSExtValue();
-                      int v2 = const2->getSExtValue();
-                      if (v1 != v2) return false;
-                  }
-
-                  if (max1 == nullptr && max2 == nullptr) {
-                      ConstantInt *const1 = dyn_cast<ConstantInt>(interval1.second);
-                      ConstantInt *const2 = dyn_cast<ConstantInt>(interval2.second);
-                      int v1 = const1->getSExtValue();
-                      int v2 = const2->getSExtValue();
-                      if (v1 != v2) return false;
-                  }
-              }
-          }
-      }
-      return true;
 }
@@ -0,0 +1,7 @@
+#include "../common/AnalysisTools.h"
+
+// The analysis itself is in diffLoopAnalysis.cpp, part of analysiscore.
+int main(int argc, char **argv)
+{
+    return runAnalysisMain(difference::runLoopAnalysis, argc, argv);
+}
@@ -11,7 +11,7 @@ define i32 @main() #0 {
   %d = alloca i32, align 4
   store i32 0, i32* %1
   store i32 0, i32* %d, align 4
-  %2 = load i32* %a, align 4
+  %2 = load i32, i32* %a, align 4
   %3 = icmp sgt i32 %2, 0
   br i1 %3, label %4, label %5
 
@@ -24,7 +24,7 @@ define i32 @main() #0 {
   br label %6
 
 ; <label>:6                                       ; preds = %5, %4
-  %7 = load i32* %b, align 4
+  %7 = load i32, i32* %b, align 4
   %8 = icmp sgt i32 %7, 0
   br i1 %8, label %9, label %10
 
@@ -40,4 +40,4 @@ attributes #0 = { nounwind uwtable "less-precise-fpmad"="false" "no-frame-pointe
 
 !llvm.ident = !{!0}
 
-!0 = metadata !{metadata !"clang version 3.4.2 (tags/RELEASE_34/dot2-final)"}
+!0 = !{!"clang version 3.4.2 (tags/RELEASE_34/dot2-final)"}
@@ -18,31 +18,31 @@ define i32 @main() #0 {
   br label %2
 
 ; <label>:2                                       ; preds = %6, %0
-  %3 = load i32* %i, align 4
-  %4 = load i32* %N, align 4
+  %3 = load i32, i32* %i, align 4
+  %4 = load i32, i32* %N, align 4
   %5 = icmp slt i32 %3, %4
   br i1 %5, label %6, label %25
 
 ; <label>:6                                       ; preds = %2
-  %7 = load i32* %x, align 4
-  %8 = load i32* %y, align 4
+  %7 = load i32, i32* %x, align 4
+  %8 = load i32, i32* %y, align 4
   %9 = mul nsw i32 2, %8
   %10 = mul nsw i32 %9, 3
-  %11 = load i32* %z, align 4
+  %11 = load i32, i32* %z, align 4
   %12 = mul nsw i32 %10, %11
   %13 = add nsw i32 %7, %12
   %14 = srem i32 %13, 3
   %15 = sub nsw i32 0, %14
   store i32 %15, i32* %x, align 4
-  %16 = load i32* %z, align 4
+  %16 = load i32, i32* %z, align 4
   %17 = mul nsw i32 3, %16
-  %18 = load i32* %y, align 4
+  %18 = load i32, i32* %y, align 4
   %19 = mul nsw i32 2, %18
   %20 = add nsw i32 %17, %19
-  %21 = load i32* %x, align 4
+  %21 = load i32, i32* %x, align 4
   %22 = srem i32 %20, %21
   store i32 %22, i32* %y, align 4
-  %23 = load i32* %z, align 4
+  %23 = load i32, i32* %z, align 4
   %24 = add nsw i32 %23, 1
   store i32 %24, i32* %z, align 4
   br label %2
@@ -55,4 +55,4 @@ attributes #0 = { nounwind uwtable "less-precise-fpmad"="false" "no-frame-pointe
 
 !llvm.ident = !{!0}
 
-!0 = metadata !{metadata !"clang version 3.4.2 (tags/RELEASE_34/dot2-final)"}
+!0 = !{!"clang version 3.4.2 (tags/RELEASE_34/dot2-final)"}
@@ -0,0 +1,9 @@
+int main() {
+    int i = 0, j = 2;
+
+    while (i < 10) {
+        i = i + 1;
+        j = i + 2;
+    }
+    return 0;
+}
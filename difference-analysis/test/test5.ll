@@ -0,0 +1,30 @@
+; ModuleID = 'test5.c'
+source_filename = "test5.c"
+
+define i32 @main() {
+entry:
+  %retval = alloca i32, align 4
+  %i = alloca i32, align 4
+  %j = alloca i32, align 4
+  store i32 0, i32* %retval, align 4
+  store i32 0, i32* %i, align 4
+  store i32 2, i32* %j, align 4
+  br label %while.cond
+
+while.cond:
+  %0 = load i32, i32* %i, align 4
+  %cmp = icmp slt i32 %0, 10
+  br i1 %cmp, label %while.body, label %while.end
+
+while.body:
+  %1 = load i32, i32* %i, align 4
+  %add = add nsw i32 %1, 1
+  store i32 %add, i32* %i, align 4
+  %2 = load i32, i32* %i, align 4
+  %add1 = add nsw i32 %2, 2
+  store i32 %add1, i32* %j, align 4
+  br label %while.cond
+
+while.end:
+  ret i32 0
+}
@@ -0,0 +1,711 @@
+#ifndef INTERVAL_H
+#define INTERVAL_H
+
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+// Bound arithmetic for BasicInterval<T>: each operation stores the result
+// and returns whether it overflowed T. Types whose products fit a 64-bit
+// integer, the common int among them, compute there and check the range;
+// the rest use the overflow builtins.
+template <typename T, bool Widened = (sizeof(T) < sizeof(int32_t)
+                                      || (std::is_signed<T>::value && sizeof(T) < sizeof(int64_t)))>
+struct IntervalArithmetic {
+    static bool add(T a, T b, T &result)
+    {
+        return narrow((int64_t) a + (int64_t) b, result);
+    }
+
+    static bool sub(T a, T b, T &result)
+    {
+        return narrow((int64_t) a - (int64_t) b, result);
+    }
+
+    static bool mul(T a, T b, T &result)
+    {
+        return narrow((int64_t) a * (int64_t) b, result);
+    }
+
+    // The hull of x1 * y1, x1 * y2, x2 * y1 and x2 * y2; one range check on
+    // each end covers all four products.
+    static bool mulHull(T x1, T x2, T y1, T y2, T &low, T &high)
+    {
+        int64_t p1 = (int64_t) x1 * y1, p2 = (int64_t) x1 * y2;
+        int64_t p3 = (int64_t) x2 * y1, p4 = (int64_t) x2 * y2;
+        bool overflow = narrow(std::min(std::min(p1, p2), std::min(p3, p4)), low);
+        return narrow(std::max(std::max(p1, p2), std::max(p3, p4)), high) | overflow;
+    }
+
+    static bool narrow(int64_t wide, T &result)
+    {
+        result = (T) wide;
+        return wide < (int64_t) std::numeric_limits<T>::min() || wide > (int64_t) std::numeric_limits<T>::max();
+    }
+};
+
+template <typename T>
+struct IntervalArithmetic<T, false> {
+    static bool add(T a, T b, T &result)
+    {
+        return __builtin_add_overflow(a, b, &result);
+    }
+
+    static bool sub(T a, T b, T &result)
+    {
+        return __builtin_sub_overflow(a, b, &result);
+    }
+
+    static bool mul(T a, T b, T &result)
+    {
+        return __builtin_mul_overflow(a, b, &result);
+    }
+
+    static bool mulHull(T x1, T x2, T y1, T y2, T &low, T &high)
+    {
+        T p1, p2, p3, p4;
+        bool overflow = mul(x1, y1, p1) | mul(x1, y2, p2) | mul(x2, y1, p3) | mul(x2, y2, p4);
+        low = std::min(std::min(p1, p2), std::min(p3, p4));
+        high = std::max(std::max(p1, p2), std::max(p3, p4));
+        return overflow;
+    }
+};
+
+// An interval of T, the integer type of the IR values it describes. A bound
+// whose arithmetic overflows T becomes infinite; when the whole interval
+// would wrap around, e.g. a lower bound past the maximum, nothing is known
+// and it becomes [-INFINITY, INFINITY].
+template <typename T>
+class BasicInterval {
+    public:
+        typedef T value_type;
+        typedef IntervalArithmetic<T> Arithmetic;
+
+        BasicInterval() {
+             nInfinity = true;
+             pInfinity = true;
+        }
+
+        BasicInterval(const bool inf, const bool sup): nInfinity(inf), pInfinity(sup) {}
+        BasicInterval(const T inf, const bool sup): pInfinity(sup), infimum(inf) {}
+        BasicInterval(const bool inf, const T sup): nInfinity(inf), supremum(sup) {}
+        BasicInterval(const T inf, const T sup): infimum(inf), supremum(sup) {}
+
+        // [value, value], or [-INFINITY, INFINITY] for a constant T cannot
+        // hold, e.g. an i64 constant in a 32-bit interval.
+        static BasicInterval constant(const long long value)
+        {
+            if (value < (long long) std::numeric_limits<T>::min() || value > (long long) std::numeric_limits<T>::max()) {
+                return BasicInterval();
+            }
+            return BasicInterval((T) value, (T) value);
+        }
+
+        // The interval with exactly these fields, bounds hidden by an
+        // infinite flag included, as write and read keep them; for storage
+        // that holds the fields apart (see IntervalKernels.h).
+        static BasicInterval fromFields(const T inf, const T sup, const bool nInfi, const bool pInfi, const bool isEmpty)
+        {
+            BasicInterval interval(inf, sup, nInfi, pInfi);
+            interval.empty = isEmpty;
+            return interval;
+        }
+
+        BasicInterval operator+(const BasicInterval &rhs)
+        {
+            const BasicInterval &lhs = *this;
+            T newInf = 0, newSup = 0, bound;
+            bool newNInfinity = lhs.nInfinity || rhs.nInfinity;
+            bool newPInfinity = lhs.pInfinity || rhs.pInfinity;
+
+            if (!newNInfinity) {
+                if (Arithmetic::add(lhs.infimum, rhs.infimum, bound)) {
+                    newNInfinity = true;
+                    newPInfinity |= lhs.infimum > 0;
+                } else {
+                    newInf = bound;
+                }
+            }
+
+            if (!newPInfinity) {
+                if (Arithmetic::add(lhs.supremum, rhs.supremum, bound)) {
+                    newPInfinity = true;
+                    newNInfinity |= lhs.supremum < 0;
+                } else {
+                    newSup = bound;
+                }
+            }
+
+            if (newNInfinity) {
+                newInf = 0;
+            }
+            return BasicInterval(newInf, newSup, newNInfinity, newPInfinity);
+        }
+
+        BasicInterval& operator+=(const BasicInterval &rhs)
+        {
+            *this = *this + rhs;
+            return *this;
+        }
+
+        BasicInterval operator-(const BasicInterval &rhs)
+        {
+            const BasicInterval &lhs = *this;
+            T newInf = 0, newSup = 0, bound;
+            bool newNInfinity = lhs.nInfinity || rhs.pInfinity;
+            bool newPInfinity = lhs.pInfinity || rhs.nInfinity;
+
+            if (!newNInfinity) {
+                if (Arithmetic::sub(lhs.infimum, rhs.supremum, bound)) {
+                    newNInfinity = true;
+                    newPInfinity |= lhs.infimum >= 0;
+                } else {
+                    newInf = bound;
+                }
+            }
+
+            if (!newPInfinity) {
+                if (Arithmetic::sub(lhs.supremum, rhs.infimum, bound)) {
+                    newPInfinity = true;
+                    newNInfinity |= lhs.supremum < 0;
+                } else {
+                    newSup = bound;
+                }
+            }
+
+            if (newNInfinity) {
+                newInf = 0;
+            }
+            return BasicInterval(newInf, newSup, newNInfinity, newPInfinity);
+        }
+
+        BasicInterval& operator-=(const BasicInterval &rhs)
+        {
+            *this = *this - rhs;
+            return *this;
+        }
+
+
+        BasicInterval operator*(const BasicInterval &rhs)
+        {
+            const BasicInterval &lhs = *this;
+            T newInf = 0, newSup = 0;
+            bool newNInfinity = false, newPInfinity = false;
+            if (lhs.nInfinity || rhs.nInfinity) {
+                newNInfinity = true;
+            }
+
+            if (lhs.pInfinity || rhs.pInfinity) {
+                newPInfinity = true;
+            }
+
+            if (lhs.supremum < 0 && rhs.nInfinity) {
+                newPInfinity = true;
+            }
+
+            if (lhs.infimum < 0 && rhs.nInfinity) {
+                newPInfinity = true;
+            }
+
+            if (lhs.nInfinity && rhs.supremum < 0) {
+                newPInfinity = true;
+            }
+
+            if (lhs.nInfinity && rhs.infimum < 0) {
+                newPInfinity = true;
+            }
+
+            if (lhs.supremum < 0 && rhs.pInfinity) {
+                newNInfinity = true;
+            }
+
+            if (lhs.infimum < 0 && rhs.pInfinity) {
+                newNInfinity = true;
+            }
+
+            if (lhs.pInfinity && rhs.supremum < 0) {
+                newNInfinity = true;
+            }
+
+            if (lhs.pInfinity && rhs.infimum < 0) {
+                newNInfinity = true;
+            }
+
+            if (__builtin_expect(Arithmetic::mulHull(lhs.infimum, lhs.supremum, rhs.infimum, rhs.supremum, newInf, newSup), false)) {
+                return multiplyOverflowed(rhs, newNInfinity, newPInfinity);
+            }
+
+            return BasicInterval(newInf, newSup, newNInfinity, newPInfinity);
+        }
+
+        BasicInterval& operator*=(const BasicInterval &rhs)
+        {
+            *this = *this * rhs;
+            return *this;
+        }
+
+        bool operator>(const T rhs)
+        {
+            const BasicInterval &lhs = *this;
+
+            if (lhs.pInfinity) {
+                return true;
+            }
+
+            if (!lhs.nInfinity && lhs.infimum > rhs) {
+                return true;
+            }
+
+            if (!lhs.pInfinity && lhs.supremum > rhs) {
+                return true;
+            }
+
+            return false;
+        }
+
+        bool operator>=(const T rhs)
+        {
+            const BasicInterval &lhs = *this;
+
+            if (lhs.pInfinity) {
+                return true;
+            }
+
+            if (!lhs.nInfinity && lhs.infimum >= rhs) {
+                return true;
+            }
+
+            if (!lhs.pInfinity && lhs.supremum >= rhs) {
+                return true;
+            }
+
+            return false;
+        }
+
+        bool operator<(const T rhs)
+        {
+            const BasicInterval &lhs = *this;
+
+            if (lhs.nInfinity) {
+                return true;
+            }
+
+            if (!lhs.nInfinity && lhs.infimum < rhs) {
+                return true;
+            }
+
+            if (!lhs.pInfinity && lhs.supremum < rhs) {
+                return true;
+            }
+
+            return false;
+        }
+
+        bool operator<=(const T rhs)
+        {
+            const BasicInterval &lhs = *this;
+
+            if (lhs.nInfinity) {
+                return true;
+            }
+
+            if (!lhs.nInfinity && lhs.infimum <= rhs) {
+                return true;
+            }
+
+            if (!lhs.pInfinity && lhs.supremum <= rhs) {
+                return true;
+            }
+
+            return false;
+        }
+
+        bool operator==(const T rhs)
+        {
+            const BasicInterval &lhs = *this;
+
+            if (lhs.nInfinity && lhs.pInfinity) {
+                return true;
+            }
+
+            if (lhs.nInfinity && lhs.supremum >= rhs) {
+                return true;
+            }
+
+            if (lhs.pInfinity && lhs.infimum <= rhs) {
+                return true;
+            }
+
+            if (!lhs.nInfinity && lhs.pInfinity && lhs.infimum <= rhs) {
+                return true;
+            }
+
+            if (!lhs.pInfinity && lhs.nInfinity && lhs.supremum >= rhs) {
+                return true;
+            }
+
+            if (!lhs.pInfinity && !lhs.nInfinity) {
+                if (lhs.infimum <= rhs && lhs.supremum >= rhs) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        bool operator!=(const T rhs)
+        {
+            return !(*this == rhs);
+        }
+
+        bool operator==(const BasicInterval rhs)
+        {
+            const BasicInterval &lhs = *this;
+            if (lhs.nInfinity != rhs.nInfinity) {
+                return false;
+            }
+
+            if (lhs.pInfinity != rhs.pInfinity) {
+                return false;
+            }
+
+            if (!lhs.nInfinity && !rhs.nInfinity) {
+                if (lhs.infimum != rhs.infimum) {
+                    return false;
+                }
+            }
+
+            if (!lhs.pInfinity && !rhs.pInfinity) {
+                if (lhs.supremum != rhs.supremum) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        bool operator!=(const BasicInterval rhs)
+        {
+            return !(*this == rhs);
+        }
+
+        // Strict order consistent with operator==, so intervals can key maps.
+        bool operator<(const BasicInterval &rhs) const
+        {
+            if (nInfinity != rhs.nInfinity) {
+                return nInfinity;
+            }
+            if (!nInfinity && infimum != rhs.infimum) {
+                return infimum < rhs.infimum;
+            }
+            if (pInfinity != rhs.pInfinity) {
+                return rhs.pInfinity;
+            }
+            if (!pInfinity && supremum != rhs.supremum) {
+                return supremum < rhs.supremum;
+            }
+            return false;
+        }
+
+
+        void print() const
+        {
+            if (empty) {
+                std::cout << "EMPTY INTERVAL\n";
+            } else {
+                std::cout << "[";
+                if (nInfinity) {
+                    std::cout << "-INFINITY";
+                } else {
+                    std::cout << (long long) infimum;
+                }
+                std::cout << ", ";
+                if (pInfinity) {
+                    std::cout << "INFINITY";
+                } else {
+                    std::cout << (long long) supremum;
+                }
+                    std::cout << "]\n";
+            }
+        }
+        void widenWith(const BasicInterval &rhs) {
+
+            if (rhs.nInfinity) {
+                this->nInfinity = true;
+            }
+
+            if (rhs.pInfinity) {
+                this->pInfinity = true;
+            }
+
+            if (!rhs.nInfinity && !this->nInfinity && this->infimum > rhs.infimum) {
+                this->nInfinity = true;
+            }
+
+            if (!rhs.pInfinity && !this->pInfinity && this->supremum < rhs.supremum) {
+                this->pInfinity = true;
+            }
+        }
+
+        // widenWith, but a bound that moved outwards stops at the next of the
+        // sorted thresholds past it; only beyond the last one it is infinite.
+        void widenWith(const BasicInterval &rhs, const std::vector<T> &thresholds) {
+
+            if (rhs.nInfinity) {
+                this->nInfinity = true;
+            }
+
+            if (rhs.pInfinity) {
+                this->pInfinity = true;
+            }
+
+            if (!rhs.nInfinity && !this->nInfinity && this->infimum > rhs.infimum) {
+                auto above = std::upper_bound(thresholds.begin(), thresholds.end(), rhs.infimum);
+                if (above == thresholds.begin()) {
+                    this->nInfinity = true;
+                } else {
+                    this->infimum = *(above - 1);
+                }
+            }
+
+            if (!rhs.pInfinity && !this->pInfinity && this->supremum < rhs.supremum) {
+                auto atLeast = std::lower_bound(thresholds.begin(), thresholds.end(), rhs.supremum);
+                if (atLeast == thresholds.end()) {
+                    this->pInfinity = true;
+                } else {
+                    this->supremum = *atLeast;
+                }
+            }
+        }
+
+        void narrowWith(const BasicInterval &rhs) {
+
+            if (!rhs.nInfinity && this->nInfinity) {
+                this->infimum = rhs.infimum;
+                this->nInfinity = false;
+            }
+
+            if (!rhs.pInfinity && this->pInfinity) {
+                this->supremum = rhs.supremum;
+                this->pInfinity = false;
+            }
+        }
+
+        void unionWith(const BasicInterval &rhs) {
+            if (rhs.nInfinity) {
+                this->nInfinity = rhs.nInfinity;
+            }
+
+            if (rhs.pInfinity) {
+                this->pInfinity = rhs.pInfinity;
+            }
+
+            if (!rhs.nInfinity && !this->nInfinity) {
+                this->infimum = std::min(this->infimum, rhs.infimum);
+            }
+
+            if (!rhs.pInfinity && !this->pInfinity) {
+                this->supremum = std::max(this->supremum, rhs.supremum);
+            }
+        }
+
+        void intersectionWith(const BasicInterval &rhs) {
+
+            if (this->nInfinity && !rhs.nInfinity) {
+                this->infimum = rhs.infimum;
+                this->nInfinity = rhs.nInfinity;
+            }
+
+            if (this->pInfinity && !rhs.pInfinity) {
+                this->supremum = rhs.supremum;
+                this->pInfinity = rhs.pInfinity;
+            }
+
+            // if (!this->nInfinity && rhs.nInfinity) {
+            //
+            // }
+            //
+            // if (!this->pInfinity && rhs.pInfinity) {
+            //
+            // }
+
+            if (!this->nInfinity && !this->pInfinity && !rhs.nInfinity && rhs.pInfinity && this->supremum >= rhs.infimum) {
+                this->infimum = std::max(this->infimum, rhs.infimum);
+            }
+
+            if (!this->nInfinity && this->pInfinity && !rhs.nInfinity && !rhs.pInfinity && this->infimum <= rhs.supremum) {
+                this->infimum = std::max(this->infimum, rhs.infimum);
+                this->supremum = rhs.supremum;
+            }
+
+            if (!this->nInfinity && !this->pInfinity && rhs.nInfinity && !rhs.pInfinity && this->infimum <= rhs.supremum) {
+                this->supremum = std::min(this->supremum, rhs.supremum);
+            }
+
+            if (this->nInfinity && !this->pInfinity && !rhs.nInfinity && !rhs.pInfinity && this->supremum >= rhs.infimum) {
+                this->infimum = rhs.infimum;
+                this->supremum = std::min(this->supremum, rhs.supremum);
+            }
+
+            // if (!(this->infimum <= rhs.supremum) || !(this->supremum >= rhs.infimum)) {
+            //     this->empty = true;
+            // }
+
+
+        }
+
+        // Exact intersection: unlike intersectionWith it covers every mix of
+        // infinite bounds, and marks the result empty when the two are disjoint.
+        void meetWith(const BasicInterval &rhs) {
+            if (rhs.empty) {
+                this->empty = true;
+            }
+
+            if (!rhs.nInfinity && (this->nInfinity || this->infimum < rhs.infimum)) {
+                this->infimum = rhs.infimum;
+                this->nInfinity = false;
+            }
+
+            if (!rhs.pInfinity && (this->pInfinity || this->supremum > rhs.supremum)) {
+                this->supremum = rhs.supremum;
+                this->pInfinity = false;
+            }
+
+            if (!this->nInfinity && !this->pInfinity && this->infimum > this->supremum) {
+                this->empty = true;
+            }
+        }
+
+        // Raw fields, so an interval read back compares equal to the one
+        // written. The bounds go through long long so int8_t prints a number.
+        void write(std::ostream &out) const {
+            out << nInfinity << ' ' << pInfinity << ' ' << (long long) infimum << ' ' << (long long) supremum << ' ' << empty;
+        }
+
+        bool read(std::istream &in) {
+            long long inf, sup;
+            if (!(in >> nInfinity >> pInfinity >> inf >> sup >> empty)) {
+                return false;
+            }
+            infimum = (T) inf;
+            supremum = (T) sup;
+            return true;
+        }
+
+        // Raw fields as well, so the bound an infinite flag hides counts:
+        // operator* still reads it, so only identical intervals can stand
+        // in for each other in a hash-consed state.
+        bool identical(const BasicInterval &rhs) const {
+            return nInfinity == rhs.nInfinity && pInfinity == rhs.pInfinity && empty == rhs.empty
+                && infimum == rhs.infimum && supremum == rhs.supremum;
+        }
+
+        size_t hash() const {
+            size_t flags = (size_t) nInfinity | (size_t) pInfinity << 1 | (size_t) empty << 2;
+            return ((size_t) (long long) infimum * 31 + (size_t) (long long) supremum) * 8 + flags;
+        }
+
+        bool isEmpty() const {
+            return empty;
+        }
+
+        bool lowerInfinite() const {
+            return nInfinity;
+        }
+
+        bool upperInfinite() const {
+            return pInfinity;
+        }
+
+        T lower() const {
+            return infimum;
+        }
+
+        T upper() const {
+            return supremum;
+        }
+
+        bool justInitialized() {
+            if (nInfinity && pInfinity) {
+                return true;
+            }
+            return false;
+        }
+
+    private:
+        BasicInterval(const T inf, const T sup, const bool nInfi, const bool pInfi):
+            nInfinity(nInfi), pInfinity(pInfi), infimum(inf), supremum(sup) {}
+        bool nInfinity = false;
+        bool pInfinity = false;
+        bool empty = false;
+        T infimum = 0;
+        T supremum = 0;
+
+        // operator* when a product is past T's range: it stretches the
+        // result to that side's infinity, and the others give the bounds.
+        __attribute__((noinline)) BasicInterval multiplyOverflowed(const BasicInterval &rhs, bool newNInfinity, bool newPInfinity) const
+        {
+            T factors[4][2] = {
+                {infimum, rhs.infimum}, {infimum, rhs.supremum},
+                {supremum, rhs.infimum}, {supremum, rhs.supremum}};
+            T newInf = 0, newSup = 0;
+            bool found = false;
+            for (auto &factor: factors) {
+                T product;
+                if (Arithmetic::mul(factor[0], factor[1], product)) {
+                    if ((factor[0] < 0) != (factor[1] < 0)) {
+                        newNInfinity = true;
+                    } else {
+                        newPInfinity = true;
+                    }
+                } else if (!found) {
+                    newInf = newSup = product;
+                    found = true;
+                } else {
+                    newInf = std::min(newInf, product);
+                    newSup = std::max(newSup, product);
+                }
+            }
+            if (!found) {
+                return BasicInterval();
+            }
+            return BasicInterval(newInf, newSup, newNInfinity, newPInfinity);
+        }
+};
+
+// intervalAnalysis and intervalSSAAnalysis track 32-bit values in Interval.
+// intervalLoopAnalysis keeps every value in an Interval64 and computes each
+// at its IR width, in the interval of that width (see convertInterval).
+typedef BasicInterval<int32_t> Interval;
+typedef BasicInterval<int8_t> Interval8;
+typedef BasicInterval<int16_t> Interval16;
+typedef BasicInterval<int64_t> Interval64;
+
+// interval as an interval of To. A bound To cannot hold is infinite on its
+// side; an interval entirely past To's range, which no value of that width
+// is in, tells nothing and becomes [-INFINITY, INFINITY].
+template <typename To, typename From>
+BasicInterval<To> convertInterval(const BasicInterval<From> &interval)
+{
+    const long long min = std::numeric_limits<To>::min();
+    const long long max = std::numeric_limits<To>::max();
+    bool lowInfinite = interval.lowerInfinite() || (long long) interval.lower() < min;
+    bool highInfinite = interval.upperInfinite() || (long long) interval.upper() > max;
+    if ((!interval.lowerInfinite() && (long long) interval.lower() > max)
+        || (!interval.upperInfinite() && (long long) interval.upper() < min)
+        || (lowInfinite && highInfinite)) {
+        return BasicInterval<To>();
+    }
+    if (lowInfinite) {
+        return BasicInterval<To>(true, (To) interval.upper());
+    }
+    if (highInfinite) {
+        return BasicInterval<To>((To) interval.lower(), true);
+    }
+    return BasicInterval<To>((To) interval.lower(), (To) interval.upper());
+}
+
+#endif
@@ -0,0 +1,276 @@
+#ifndef INTERVAL_KERNELS_H
+#define INTERVAL_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include "Interval.h"
+
+// N Interval64s at once, struct-of-arrays: lane i is [low[i], high[i]], and
+// lowInfinite, highInfinite and empty hold its flags as masks, all ones for
+// true. The flags are kept apart from the bounds because every int64 is a
+// bound an i64 can have: a sentinel standing for an infinity would also
+// stand for a finite INT64_MIN or INT64_MAX. All arrays have 64-bit lanes,
+// so a loop over them keeps one vector width throughout.
+//
+// The kernels compute what the BasicInterval<int64_t> operations compute,
+// down to the bounds an infinite flag hides, which operator* reads and
+// interning compares. They are straight loops of masks and selects with no
+// branches, left to the compiler's vectorizer as the TaintBits word loops
+// are. The 64-bit compares need SSE4.2 on x86, so -DPA_ARCH widens them.
+// mulLanes is branch-free as well, but checks each product with
+// __builtin_mul_overflow, which no x86 vector unit before AVX-512 does, so
+// it runs a lane at a time.
+//
+// Built with -DPA_INTERVAL_KERNELS, intervalLoopAnalysis joins, widens and
+// narrows its states through these a leaf of their trie at a time, with N
+// the leaf width (see IntervalMap::mergeLeavesWith).
+template <size_t N>
+struct IntervalLanes {
+    int64_t low[N];
+    int64_t high[N];
+    int64_t lowInfinite[N];
+    int64_t highInfinite[N];
+    int64_t empty[N];
+
+    void load(size_t i, const Interval64 &interval)
+    {
+        low[i] = interval.lower();
+        high[i] = interval.upper();
+        lowInfinite[i] = -(int64_t) interval.lowerInfinite();
+        highInfinite[i] = -(int64_t) interval.upperInfinite();
+        empty[i] = -(int64_t) interval.isEmpty();
+    }
+
+    Interval64 get(size_t i) const
+    {
+        return Interval64::fromFields(low[i], high[i], lowInfinite[i] != 0, highInfinite[i] != 0, empty[i] != 0);
+    }
+};
+
+// All ones when condition holds, else zero.
+inline int64_t laneMask(bool condition)
+{
+    return -(int64_t) condition;
+}
+
+// mask ? a : b for a mask of all ones or zero.
+inline int64_t laneSelect(int64_t mask, int64_t a, int64_t b)
+{
+    return (a & mask) | (b & ~mask);
+}
+
+// x + y and x - y wrapped around, with a mask of whether they did.
+inline int64_t wrappingAdd(int64_t x, int64_t y, int64_t &overflow)
+{
+    int64_t sum = (int64_t) ((uint64_t) x + (uint64_t) y);
+    overflow = ((x ^ sum) & (y ^ sum)) >> 63;
+    return sum;
+}
+
+inline int64_t wrappingSub(int64_t x, int64_t y, int64_t &overflow)
+{
+    int64_t difference = (int64_t) ((uint64_t) x - (uint64_t) y);
+    overflow = ((x ^ y) & (x ^ difference)) >> 63;
+    return difference;
+}
+
+// out = a + b, lane by lane; out may be a or b.
+template <size_t N>
+void addLanes(const IntervalLanes<N> &a, const IntervalLanes<N> &b, IntervalLanes<N> &out)
+{
+    for (size_t i = 0; i < N; ++i) {
+        int64_t lowInfinite = a.lowInfinite[i] | b.lowInfinite[i];
+        int64_t highInfinite = a.highInfinite[i] | b.highInfinite[i];
+        int64_t overflow;
+        int64_t low = wrappingAdd(a.low[i], b.low[i], overflow);
+        overflow &= ~lowInfinite;
+        lowInfinite |= overflow;
+        highInfinite |= overflow & laneMask(a.low[i] > 0);
+        int64_t high = wrappingAdd(a.high[i], b.high[i], overflow);
+        overflow &= ~highInfinite;
+        highInfinite |= overflow;
+        lowInfinite |= overflow & laneMask(a.high[i] < 0);
+        out.low[i] = laneSelect(lowInfinite, 0, low);
+        out.high[i] = laneSelect(highInfinite, 0, high);
+        out.lowInfinite[i] = lowInfinite;
+        out.highInfinite[i] = highInfinite;
+        out.empty[i] = 0;
+    }
+}
+
+// out = a - b, lane by lane; out may be a or b.
+template <size_t N>
+void subLanes(const IntervalLanes<N> &a, const IntervalLanes<N> &b, IntervalLanes<N> &out)
+{
+    for (size_t i = 0; i < N; ++i) {
+        int64_t lowInfinite = a.lowInfinite[i] | b.highInfinite[i];
+        int64_t highInfinite = a.highInfinite[i] | b.lowInfinite[i];
+        int64_t overflow;
+        int64_t low = wrappingSub(a.low[i], b.high[i], overflow);
+        overflow &= ~lowInfinite;
+        lowInfinite |= overflow;
+        highInfinite |= overflow & laneMask(a.low[i] >= 0);
+        int64_t high = wrappingSub(a.high[i], b.low[i], overflow);
+        overflow &= ~highInfinite;
+        highInfinite |= overflow;
+        lowInfinite |= overflow & laneMask(a.high[i] < 0);
+        out.low[i] = laneSelect(lowInfinite, 0, low);
+        out.high[i] = laneSelect(highInfinite, 0, high);
+        out.lowInfinite[i] = lowInfinite;
+        out.highInfinite[i] = highInfinite;
+        out.empty[i] = 0;
+    }
+}
+
+// out = a * b, lane by lane; out may be a or b. A product past the range
+// stretches the result to the infinity of its sign, and the others give
+// the bounds; with all four past it nothing is known.
+template <size_t N>
+void mulLanes(const IntervalLanes<N> &a, const IntervalLanes<N> &b, IntervalLanes<N> &out)
+{
+    for (size_t i = 0; i < N; ++i) {
+        int64_t aNegative = laneMask(a.low[i] < 0) | laneMask(a.high[i] < 0);
+        int64_t bNegative = laneMask(b.low[i] < 0) | laneMask(b.high[i] < 0);
+        int64_t lowInfinite = a.lowInfinite[i] | b.lowInfinite[i]
+            | (aNegative & b.highInfinite[i]) | (a.highInfinite[i] & bNegative);
+        int64_t highInfinite = a.highInfinite[i] | b.highInfinite[i]
+            | (aNegative & b.lowInfinite[i]) | (a.lowInfinite[i] & bNegative);
+
+        const int64_t x[4] = {a.low[i], a.low[i], a.high[i], a.high[i]};
+        const int64_t y[4] = {b.low[i], b.high[i], b.low[i], b.high[i]};
+        int64_t low = INT64_MAX, high = INT64_MIN, found = 0;
+        for (unsigned k = 0; k < 4; ++k) {
+            int64_t product;
+            int64_t overflow = laneMask(__builtin_mul_overflow(x[k], y[k], &product));
+            int64_t opposite = (x[k] ^ y[k]) >> 63;
+            lowInfinite |= overflow & opposite;
+            highInfinite |= overflow & ~opposite;
+            low = laneSelect(overflow, low, product < low ? product : low);
+            high = laneSelect(overflow, high, product > high ? product : high);
+            found |= ~overflow;
+        }
+        out.low[i] = laneSelect(found, low, 0);
+        out.high[i] = laneSelect(found, high, 0);
+        out.lowInfinite[i] = lowInfinite | ~found;
+        out.highInfinite[i] = highInfinite | ~found;
+        out.empty[i] = 0;
+    }
+}
+
+// out = a joined with b, lane by lane, as a.unionWith(b); out may be a or b.
+template <size_t N>
+void joinLanes(const IntervalLanes<N> &a, const IntervalLanes<N> &b, IntervalLanes<N> &out)
+{
+    for (size_t i = 0; i < N; ++i) {
+        int64_t lowFinite = ~(a.lowInfinite[i] | b.lowInfinite[i]);
+        int64_t highFinite = ~(a.highInfinite[i] | b.highInfinite[i]);
+        int64_t low = a.low[i] < b.low[i] ? a.low[i] : b.low[i];
+        int64_t high = a.high[i] > b.high[i] ? a.high[i] : b.high[i];
+        out.low[i] = laneSelect(lowFinite, low, a.low[i]);
+        out.high[i] = laneSelect(highFinite, high, a.high[i]);
+        out.lowInfinite[i] = ~lowFinite;
+        out.highInfinite[i] = ~highFinite;
+        out.empty[i] = a.empty[i];
+    }
+}
+
+// out = a met with b, lane by lane, as a.meetWith(b): disjoint ones give
+// empty. out may be a or b.
+template <size_t N>
+void meetLanes(const IntervalLanes<N> &a, const IntervalLanes<N> &b, IntervalLanes<N> &out)
+{
+    for (size_t i = 0; i < N; ++i) {
+        int64_t takeLow = ~b.lowInfinite[i] & (a.lowInfinite[i] | laneMask(a.low[i] < b.low[i]));
+        int64_t takeHigh = ~b.highInfinite[i] & (a.highInfinite[i] | laneMask(a.high[i] > b.high[i]));
+        int64_t low = laneSelect(takeLow, b.low[i], a.low[i]);
+        int64_t high = laneSelect(takeHigh, b.high[i], a.high[i]);
+        int64_t lowInfinite = a.lowInfinite[i] & ~takeLow;
+        int64_t highInfinite = a.highInfinite[i] & ~takeHigh;
+        out.empty[i] = a.empty[i] | b.empty[i] | (~lowInfinite & ~highInfinite & laneMask(low > high));
+        out.low[i] = low;
+        out.high[i] = high;
+        out.lowInfinite[i] = lowInfinite;
+        out.highInfinite[i] = highInfinite;
+    }
+}
+
+// out = a widened by b, lane by lane, as a.widenWith(b): a bound b moved
+// outwards goes to infinity. out may be a or b.
+template <size_t N>
+void widenLanes(const IntervalLanes<N> &a, const IntervalLanes<N> &b, IntervalLanes<N> &out)
+{
+    for (size_t i = 0; i < N; ++i) {
+        int64_t lowFinite = ~(a.lowInfinite[i] | b.lowInfinite[i]);
+        int64_t highFinite = ~(a.highInfinite[i] | b.highInfinite[i]);
+        out.lowInfinite[i] = ~lowFinite | (lowFinite & laneMask(a.low[i] > b.low[i]));
+        out.highInfinite[i] = ~highFinite | (highFinite & laneMask(a.high[i] < b.high[i]));
+        out.low[i] = a.low[i];
+        out.high[i] = a.high[i];
+        out.empty[i] = a.empty[i];
+    }
+}
+
+// out = a narrowed by b, lane by lane, as a.narrowWith(b): an infinite
+// bound of a takes b's finite one. out may be a or b.
+template <size_t N>
+void narrowLanes(const IntervalLanes<N> &a, const IntervalLanes<N> &b, IntervalLanes<N> &out)
+{
+    for (size_t i = 0; i < N; ++i) {
+        int64_t takeLow = a.lowInfinite[i] & ~b.lowInfinite[i];
+        int64_t takeHigh = a.highInfinite[i] & ~b.highInfinite[i];
+        out.low[i] = laneSelect(takeLow, b.low[i], a.low[i]);
+        out.high[i] = laneSelect(takeHigh, b.high[i], a.high[i]);
+        out.lowInfinite[i] = a.lowInfinite[i] & ~takeLow;
+        out.highInfinite[i] = a.highInfinite[i] & ~takeHigh;
+        out.empty[i] = a.empty[i];
+    }
+}
+
+// The entries of a leaf of an IntervalMap, pairs of a key and its
+// interval, into lanes; present[i] is a mask of whether entry i has a key.
+template <size_t N, typename Entry>
+void loadEntries(const Entry *entries, IntervalLanes<N> &lanes, int64_t *present)
+{
+    for (size_t i = 0; i < N; ++i) {
+        lanes.load(i, entries[i].second);
+        present[i] = laneMask(entries[i].first != nullptr);
+    }
+}
+
+// Writes back a merge of a leaf: entry i becomes others[i] where take[i] is
+// set, and gets lane i of result where update[i] is. Whether any changed.
+template <size_t N, typename Entry>
+bool storeEntries(Entry *entries, const Entry *others, const IntervalLanes<N> &result,
+                  const int64_t *take, const int64_t *update)
+{
+    int64_t changed = 0;
+    for (size_t i = 0; i < N; ++i) {
+        changed |= take[i] | update[i];
+    }
+    if (changed == 0) {
+        return false;
+    }
+    for (size_t i = 0; i < N; ++i) {
+        if (take[i] != 0) {
+            entries[i] = others[i];
+        } else if (update[i] != 0) {
+            entries[i].second = result.get(i);
+        }
+    }
+    return true;
+}
+
+// differ[i] = whether lanes i of a and b differ as Interval64's operator==
+// sees it: in their flags, or in a bound neither hides.
+template <size_t N>
+void compareLanes(const IntervalLanes<N> &a, const IntervalLanes<N> &b, int64_t *differ)
+{
+    for (size_t i = 0; i < N; ++i) {
+        int64_t flags = (a.lowInfinite[i] ^ b.lowInfinite[i]) | (a.highInfinite[i] ^ b.highInfinite[i]);
+        int64_t lowDiffers = ~a.lowInfinite[i] & ~b.lowInfinite[i] & laneMask(a.low[i] != b.low[i]);
+        int64_t highDiffers = ~a.highInfinite[i] & ~b.highInfinite[i] & laneMask(a.high[i] != b.high[i]);
+        differ[i] = flags | lowDiffers | highDiffers;
+    }
+}
+
+#endif
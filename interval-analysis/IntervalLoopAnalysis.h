@@ -0,0 +1,288 @@
+#ifndef INTERVAL_LOOP_ANALYSIS_H
+#define INTERVAL_LOOP_ANALYSIS_H
+
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Value.h"
+#include "Interval.h"
+#include "PersistentArray.h"
+#include "../common/Arena.h"
+#include "../common/AnalysisTools.h"
+#include "../common/ResultFormat.h"
+#include "../common/Stats.h"
+
+// Default number of descending passes after the states converge, which give
+// back finite bounds that widening overshot (see narrowStates).
+#define NARROWING_PASSES 2
+
+// The states of intervalLoopAnalysis and the solver that computes them, for
+// the tool and for the opt plugin (see IntervalPass.h).
+namespace interval {
+
+// Dense per-function numbering of every instruction, argument and tracked
+// global. Ids follow pointer order, so walking a state by id matches the
+// old map<Value*, Interval>.
+class ValueNumbering {
+    public:
+        explicit ValueNumbering(llvm::Function &F);
+
+        // Returns -1 for values the function does not track, e.g. constants.
+        int lookup(llvm::Value *V) const
+        {
+            auto iter = ids.find(V);
+            if (iter == ids.end()) {
+                return -1;
+            }
+            return iter->second;
+        }
+
+        unsigned size() const
+        {
+            return values.size();
+        }
+
+    private:
+        llvm::DenseMap<llvm::Value*, unsigned> ids;
+        std::vector<llvm::Value*> values;
+};
+
+// Abstract state with one slot per numbered value, kept in a persistent
+// trie (see PersistentArray.h). It keeps the subset of the std::map
+// interface the transfer functions rely on. Copying a state shares all of
+// it, and a block's transfer copies only the parts it writes, so the states
+// of a function's blocks share the values they agree on.
+class IntervalMap {
+    public:
+        typedef std::pair<llvm::Value*, Interval64> Entry;
+
+        // Walks the occupied slots; a slot whose key is null is not in the
+        // map. Through a non-const map, dereferencing unshares the slot.
+        template <typename MapT, typename EntryT>
+        class SlotIterator {
+            public:
+                SlotIterator(MapT *map, size_t pos): map(map), pos(pos)
+                {
+                    skipEmpty();
+                }
+
+                EntryT& operator*() const { return map->slot(pos); }
+                EntryT* operator->() const { return &map->slot(pos); }
+
+                SlotIterator& operator++()
+                {
+                    ++pos;
+                    skipEmpty();
+                    return *this;
+                }
+
+                bool operator==(const SlotIterator &rhs) const { return pos == rhs.pos; }
+                bool operator!=(const SlotIterator &rhs) const { return pos != rhs.pos; }
+
+            private:
+                void skipEmpty()
+                {
+                    const IntervalMap *slots = map;
+                    while (pos != slots->capacity() && slots->slot(pos).first == nullptr) {
+                        ++pos;
+                    }
+                }
+
+                MapT *map;
+                size_t pos;
+        };
+
+        typedef SlotIterator<IntervalMap, Entry> iterator;
+        typedef SlotIterator<const IntervalMap, const Entry> const_iterator;
+        typedef PersistentArray<Entry>::InternTable StateTable;
+
+        IntervalMap() {}
+        explicit IntervalMap(const ValueNumbering *numbering):
+            numbering(numbering), slots(numbering->size(), Entry(nullptr, Interval64())) {}
+
+        IntervalMap(const IntervalMap &other): numbering(other.numbering), slots(other.slots), count(other.count)
+        {
+            countStat("state copies");
+        }
+
+        IntervalMap(IntervalMap &&other) = default;
+        IntervalMap &operator=(const IntervalMap &other)
+        {
+            countStat("state copies");
+            numbering = other.numbering;
+            slots = other.slots;
+            count = other.count;
+            return *this;
+        }
+        IntervalMap &operator=(IntervalMap &&other) = default;
+
+        iterator begin() { return iterator(this, 0); }
+        iterator end() { return iterator(this, capacity()); }
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, capacity()); }
+
+        iterator find(llvm::Value *V)
+        {
+            int id = numbering == nullptr ? -1 : numbering->lookup(V);
+            if (id < 0 || slots[id].first == nullptr) {
+                return end();
+            }
+            return iterator(this, id);
+        }
+
+        const_iterator find(llvm::Value *V) const
+        {
+            int id = numbering == nullptr ? -1 : numbering->lookup(V);
+            if (id < 0 || slots[id].first == nullptr) {
+                return end();
+            }
+            return const_iterator(this, id);
+        }
+
+        void insert(const Entry &entry)
+        {
+            int id = numbering == nullptr ? -1 : numbering->lookup(entry.first);
+            if (id < 0) {
+                throw AnalysisError("value is not numbered in this function");
+            }
+            if (slots[id].first == nullptr) {
+                slots.mutate(id) = entry;
+                ++count;
+            }
+        }
+
+        size_t size() const
+        {
+            return count;
+        }
+
+        // Runs merge(mine, theirs) on the slots other may differ in, as
+        // PersistentArray::mergeWith does, keeping the count of keys.
+        template <typename Merge>
+        void mergeWith(const IntervalMap &other, Merge merge)
+        {
+            // An empty map, as a join starts from, has nothing to give.
+            if (other.numbering == nullptr) {
+                return;
+            }
+            size_t added = 0;
+            slots.mergeWith(other.slots, [&](Entry &mine, const Entry &theirs) {
+                bool wasEmpty = mine.first == nullptr;
+                if (!merge(mine, theirs)) {
+                    return false;
+                }
+                added += wasEmpty && mine.first != nullptr;
+                return true;
+            });
+            count += added;
+        }
+
+        // mergeWith a leaf of PERSISTENT_WIDTH slots at a time, for merges
+        // that run the interval kernels over them (see
+        // PersistentArray::mergeLeavesWith).
+        template <typename LeafMerge>
+        void mergeLeavesWith(const IntervalMap &other, LeafMerge merge)
+        {
+            if (other.numbering == nullptr) {
+                return;
+            }
+            size_t added = 0;
+            slots.mergeLeavesWith(other.slots, [&](Entry *mine, const Entry *theirs) {
+                size_t before = 0;
+                for (unsigned k = 0; k < PERSISTENT_WIDTH; ++k) {
+                    before += mine[k].first != nullptr;
+                }
+                if (!merge(mine, theirs)) {
+                    return false;
+                }
+                for (unsigned k = 0; k < PERSISTENT_WIDTH; ++k) {
+                    added += mine[k].first != nullptr;
+                }
+                added -= before;
+                return true;
+            });
+            count += added;
+        }
+
+        // Hash-conses the state into table: states interned in the same one
+        // share the parts they agree on exactly, and the whole trie when they
+        // agree everywhere, so comparing those is a pointer test.
+        void intern(StateTable &table)
+        {
+            slots.intern(table, [](const Entry &entry) {
+                return std::hash<llvm::Value*>()(entry.first) * 31 + entry.second.hash();
+            }, [](const Entry &mine, const Entry &theirs) {
+                return mine.first == theirs.first && mine.second.identical(theirs.second);
+            });
+        }
+
+        // The same keys with the same intervals.
+        bool operator==(const IntervalMap &other) const
+        {
+            if (count != other.count) {
+                return false;
+            }
+            return slots.equals(other.slots, [](const Entry &mine, const Entry &theirs) {
+                return mine.first == theirs.first && Interval64(mine.second) == theirs.second;
+            });
+        }
+
+    private:
+        size_t capacity() const
+        {
+            return slots.size();
+        }
+
+        Entry &slot(size_t i)
+        {
+            return slots.mutate(i);
+        }
+
+        const Entry &slot(size_t i) const
+        {
+            return slots[i];
+        }
+
+        const ValueNumbering *numbering = nullptr;
+        PersistentArray<Entry> slots;
+        size_t count = 0;
+};
+
+// Per-block fixpoint states of one function, which --invariants keeps
+// between runs. It keeps them as the ascending phase left them, since a warm
+// start resumes that phase, so with keepAscending narrowing saves those it
+// replaces. The maps live in the arena of the function's analysis.
+struct BlockStates {
+    ArenaMap<llvm::BasicBlock*, IntervalMap> inMaps;
+    ArenaMap<llvm::BasicBlock*, IntervalMap> outMaps;
+    bool keepAscending = false;
+    ArenaMap<llvm::BasicBlock*, IntervalMap> ascendingIn;
+    ArenaMap<llvm::BasicBlock*, IntervalMap> ascendingOut;
+};
+
+class SummaryCache;
+
+// The state on entry to BB's function: allocas and arguments unbounded,
+// tracked globals at their initial values.
+IntervalMap initInterval(llvm::BasicBlock *BB, const ValueNumbering &numbering);
+
+// Solves F from what states holds, leaving every block's states there, and
+// returns the state at F's return; blocks in frozen keep theirs.
+IntervalMap solveIncremental(
+    llvm::Function &F,
+    const ValueNumbering &numbering,
+    int &visitCount,
+    std::map<llvm::Value*, std::pair<bool, bool>> &boolMap,
+    SummaryCache *summaries,
+    BlockStates &states,
+    const std::set<llvm::BasicBlock*> &frozen,
+    int narrowingPasses,
+    const ResultPrinter &printer);
+
+}
+
+#endif
@@ -0,0 +1,188 @@
+#include <map>
+#include <memory>
+#include <set>
+#include <utility>
+#include "llvm/Config/llvm-config.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/PassManager.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Passes/PassPlugin.h"
+#include "llvm/Support/raw_ostream.h"
+#include "Interval.h"
+#include "IntervalPass.h"
+#include "IntervalLoopAnalysis.h"
+#include "../common/ResultFormat.h"
+#include "../common/Trace.h"
+
+#if LLVM_VERSION_MAJOR < 9
+#error "the interval pass plugin needs LLVM 9 or later"
+#endif
+
+using namespace llvm;
+using namespace std;
+
+struct IntervalRanges::State {
+    explicit State(Function &F): numbering(F) {}
+
+    // The states point at the numbering, so it stays put on the heap.
+    interval::ValueNumbering numbering;
+    interval::BlockStates states;
+    interval::IntervalMap returnMap;
+};
+
+void printRange(raw_ostream &OS, const Interval64 &range);
+bool findRange(const interval::IntervalMap &intervalMap, Value *V, Interval64 &range);
+
+AnalysisKey IntervalAnalysis::Key;
+
+IntervalRanges IntervalAnalysis::run(Function &F, FunctionAnalysisManager &)
+{
+    unique_ptr<IntervalRanges::State> state(new IntervalRanges::State(F));
+    if (F.isDeclaration()) {
+        return IntervalRanges(move(state));
+    }
+
+    // The worklist solver from the entry block, as the tool runs it by
+    // default, with its tracing off: a pass prints only when asked to.
+    int savedLevel = traceLevel();
+    traceLevel() = TRACE_OFF;
+    BasicBlock *entry = &F.getEntryBlock();
+    state->states.inMaps[entry] = interval::initInterval(entry, state->numbering);
+    map<Value*, pair<bool, bool>> boolMap;
+    int visitCount = 0;
+    ResultPrinter printer("intervalLoopAnalysis");
+    try {
+        state->returnMap = interval::solveIncremental(
+            F, state->numbering, visitCount, boolMap, nullptr, state->states, set<BasicBlock*>(),
+            NARROWING_PASSES, printer);
+    } catch (const AnalysisError &error) {
+        // Nothing is known about a function the solver gives up on.
+        errs() << "warning: no intervals for " << F.getName() << ": " << error.what() << "\n";
+        state.reset(new IntervalRanges::State(F));
+    }
+    traceLevel() = savedLevel;
+    return IntervalRanges(move(state));
+}
+
+IntervalRanges::IntervalRanges(unique_ptr<State> state): state(move(state)) {}
+
+IntervalRanges::IntervalRanges(IntervalRanges &&other) = default;
+
+IntervalRanges::~IntervalRanges() = default;
+
+bool IntervalRanges::atEntry(BasicBlock *BB, Value *V, Interval64 &range) const
+{
+    auto found = state->states.inMaps.find(BB);
+    return found != state->states.inMaps.end() && findRange(found->second, V, range);
+}
+
+bool IntervalRanges::atExit(BasicBlock *BB, Value *V, Interval64 &range) const
+{
+    auto found = state->states.outMaps.find(BB);
+    return found != state->states.outMaps.end() && findRange(found->second, V, range);
+}
+
+bool IntervalRanges::atReturn(Value *V, Interval64 &range) const
+{
+    return findRange(state->returnMap, V, range);
+}
+
+void IntervalRanges::print(raw_ostream &OS, Function &F) const
+{
+    OS << "Intervals for function '" << F.getName() << "':\n";
+    for (auto &BB: F) {
+        auto found = state->states.outMaps.find(&BB);
+        if (found == state->states.outMaps.end()) {
+            continue;
+        }
+        BB.printAsOperand(OS, false);
+        OS << ":\n";
+        for (auto iter = found->second.begin(); iter != found->second.end(); ++iter) {
+            if (iter->first->hasName()) {
+                OS << "  " << iter->first->getName() << ": ";
+                printRange(OS, iter->second);
+            }
+        }
+    }
+    OS << "return:\n";
+    for (auto iter = state->returnMap.begin(); iter != state->returnMap.end(); ++iter) {
+        if (iter->first->hasName()) {
+            OS << "  " << iter->first->getName() << ": ";
+            printRange(OS, iter->second);
+        }
+    }
+}
+
+bool IntervalRanges::invalidate(
+    Function &,
+    const PreservedAnalyses &PA,
+    FunctionAnalysisManager::Invalidator &)
+{
+    auto checker = PA.getChecker<IntervalAnalysis>();
+    return !checker.preserved() && !checker.preservedSet<AllAnalysesOn<Function>>();
+}
+
+PreservedAnalyses IntervalPrinterPass::run(Function &F, FunctionAnalysisManager &FAM)
+{
+    FAM.getResult<IntervalAnalysis>(F).print(OS, F);
+    return PreservedAnalyses::all();
+}
+
+// In the tool's notation, e.g. [0, INFINITY].
+void printRange(raw_ostream &OS, const Interval64 &range)
+{
+    if (range.isEmpty()) {
+        OS << "EMPTY INTERVAL\n";
+        return;
+    }
+    OS << "[";
+    if (range.lowerInfinite()) {
+        OS << "-INFINITY";
+    } else {
+        OS << range.lower();
+    }
+    OS << ", ";
+    if (range.upperInfinite()) {
+        OS << "INFINITY";
+    } else {
+        OS << range.upper();
+    }
+    OS << "]\n";
+}
+
+bool findRange(const interval::IntervalMap &intervalMap, Value *V, Interval64 &range)
+{
+    auto found = intervalMap.find(V);
+    if (found == intervalMap.end()) {
+        return false;
+    }
+    range = found->second;
+    return true;
+}
+
+// opt -load-pass-plugin IntervalPass.so -passes='print<intervals>' registers
+// the analysis with every FunctionAnalysisManager; require<intervals> only
+// computes it, for passes further down the pipeline to query.
+extern "C" LLVM_ATTRIBUTE_WEAK PassPluginLibraryInfo llvmGetPassPluginInfo()
+{
+    return {
+        LLVM_PLUGIN_API_VERSION, "IntervalPass", LLVM_VERSION_STRING,
+        [](PassBuilder &PB) {
+            PB.registerAnalysisRegistrationCallback([](FunctionAnalysisManager &FAM) {
+                FAM.registerPass([] { return IntervalAnalysis(); });
+            });
+            PB.registerPipelineParsingCallback(
+                [](StringRef Name, FunctionPassManager &FPM, ArrayRef<PassBuilder::PipelineElement>) {
+                    if (Name == "print<intervals>") {
+                        FPM.addPass(IntervalPrinterPass(errs()));
+                        return true;
+                    }
+                    if (Name == "require<intervals>") {
+                        FPM.addPass(RequireAnalysisPass<IntervalAnalysis, Function>());
+                        return true;
+                    }
+                    return false;
+                });
+        }
+    };
+}
@@ -0,0 +1,69 @@
+#ifndef INTERVAL_PASS_H
+#define INTERVAL_PASS_H
+
+#include <memory>
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/PassManager.h"
+#include "llvm/IR/Value.h"
+#include "llvm/Support/raw_ostream.h"
+#include "Interval.h"
+
+// The intervals intervalLoopAnalysis computes for one function, kept per
+// block so other passes can query them. The function must be in the form
+// the tool accepts: unoptimized front-end output with its variables in
+// allocas.
+class IntervalRanges {
+    public:
+        struct State;
+
+        explicit IntervalRanges(std::unique_ptr<State> state);
+        IntervalRanges(IntervalRanges &&other);
+        ~IntervalRanges();
+
+        // The interval of V where BB starts or ends; false when V has none
+        // there, e.g. a constant or a block the solver never reached.
+        bool atEntry(llvm::BasicBlock *BB, llvm::Value *V, Interval64 &range) const;
+        bool atExit(llvm::BasicBlock *BB, llvm::Value *V, Interval64 &range) const;
+
+        // The interval of V joined over every returning block.
+        bool atReturn(llvm::Value *V, Interval64 &range) const;
+
+        void print(llvm::raw_ostream &OS, llvm::Function &F) const;
+
+        // The intervals follow every instruction, so only a pass preserving
+        // this analysis (or all of them) keeps the cached result.
+        bool invalidate(
+            llvm::Function &F,
+            const llvm::PreservedAnalyses &PA,
+            llvm::FunctionAnalysisManager::Invalidator &Inv);
+
+    private:
+        std::unique_ptr<State> state;
+};
+
+// New-pass-manager analysis; its results are cached per function by the
+// FunctionAnalysisManager.
+class IntervalAnalysis : public llvm::AnalysisInfoMixin<IntervalAnalysis> {
+    public:
+        typedef IntervalRanges Result;
+
+        IntervalRanges run(llvm::Function &F, llvm::FunctionAnalysisManager &FAM);
+
+    private:
+        friend llvm::AnalysisInfoMixin<IntervalAnalysis>;
+        static llvm::AnalysisKey Key;
+};
+
+// print<intervals>: the state at the end of every block, then at return.
+class IntervalPrinterPass : public llvm::PassInfoMixin<IntervalPrinterPass> {
+    public:
+        explicit IntervalPrinterPass(llvm::raw_ostream &OS): OS(OS) {}
+
+        llvm::PreservedAnalyses run(llvm::Function &F, llvm::FunctionAnalysisManager &FAM);
+
+    private:
+        llvm::raw_ostream &OS;
+};
+
+#endif
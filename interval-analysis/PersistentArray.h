@@ -0,0 +1,438 @@
+#ifndef PERSISTENT_ARRAY_H
+#define PERSISTENT_ARRAY_H
+
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "../common/Arena.h"
+#include "../common/Stats.h"
+
+// Index bits each level of the trie resolves, so a node has 32 slots.
+#define PERSISTENT_BITS 5
+#define PERSISTENT_WIDTH (1 << PERSISTENT_BITS)
+#define PERSISTENT_MASK (PERSISTENT_WIDTH - 1)
+
+// Fixed-size array stored as a radix trie of 32-way nodes with reference
+// counts, so copies share their nodes. Copying is O(1); writing an element
+// copies the nodes on its path that are still shared (path copying) and
+// leaves the rest shared, so two states that differ in a few values share
+// almost all of their memory. mergeWith and equals skip the subtrees two
+// arrays share, which is where an unchanged part of a state ends up.
+//
+// intern hash-conses the nodes, so interned arrays with the same elements
+// have the same root and compare equal at once.
+//
+// Nodes come from the arena active when they are made (see Arena.h), or
+// from the heap without one, and go back to where they came from.
+//
+// The counts are plain integers: an array and its copies must stay on one
+// thread, as every abstract state of an analysis run does.
+template <typename T>
+class PersistentArray {
+    public:
+        PersistentArray() {}
+
+        // Every element starts as fill, all of them in one shared leaf.
+        PersistentArray(size_t size, const T &fill): count(size)
+        {
+            Leaf *leaf = newNode<Leaf>();
+            for (auto &item: leaf->items) {
+                item = fill;
+            }
+            root = leaf;
+            for (size_t covered = PERSISTENT_WIDTH; covered < size; covered <<= PERSISTENT_BITS) {
+                Branch *branch = newNode<Branch>();
+                for (auto &child: branch->children) {
+                    child = root;
+                }
+                root->refs += PERSISTENT_WIDTH - 1;
+                root = branch;
+                ++height;
+            }
+        }
+
+        PersistentArray(const PersistentArray &other): root(other.root), count(other.count), height(other.height)
+        {
+            if (root != nullptr) {
+                ++root->refs;
+            }
+        }
+
+        PersistentArray(PersistentArray &&other): root(other.root), count(other.count), height(other.height)
+        {
+            other.root = nullptr;
+            other.count = 0;
+            other.height = 0;
+        }
+
+        PersistentArray &operator=(PersistentArray other)
+        {
+            std::swap(root, other.root);
+            std::swap(count, other.count);
+            std::swap(height, other.height);
+            return *this;
+        }
+
+        ~PersistentArray()
+        {
+            release(root, height);
+        }
+
+        size_t size() const
+        {
+            return count;
+        }
+
+        const T &operator[](size_t i) const
+        {
+            Node *node = root;
+            for (unsigned h = height; h > 0; --h) {
+                node = static_cast<Branch*>(node)->children[(i >> (PERSISTENT_BITS * h)) & PERSISTENT_MASK];
+            }
+            return static_cast<Leaf*>(node)->items[i & PERSISTENT_MASK];
+        }
+
+        // Element i for writing, after copying the shared nodes above it.
+        T &mutate(size_t i)
+        {
+            Node **slot = &root;
+            for (unsigned h = height; ; --h) {
+                if (shared(*slot)) {
+                    Node *copy = copyNode(*slot, h);
+                    release(*slot, h);
+                    *slot = copy;
+                }
+                if (h == 0) {
+                    return static_cast<Leaf*>(*slot)->items[i & PERSISTENT_MASK];
+                }
+                slot = &static_cast<Branch*>(*slot)->children[(i >> (PERSISTENT_BITS * h)) & PERSISTENT_MASK];
+            }
+        }
+
+        // Whether both are the same version, so equal without a look.
+        bool shares(const PersistentArray &other) const
+        {
+            return root == other.root;
+        }
+
+        // Runs merge(mine, theirs) on the elements of the subtrees the two
+        // arrays of the same size do not share. merge changes mine and says
+        // whether it did; only then is the leaf copied, if shared. Skipping
+        // shared subtrees needs merge(x, x) to leave x alone.
+        template <typename Merge>
+        void mergeWith(const PersistentArray &other, Merge merge)
+        {
+            mergeTree(other, [&merge](Leaf *mine, const Leaf *theirs, bool owned) -> Node* {
+                Node *result = mine;
+                for (unsigned k = 0; k < PERSISTENT_WIDTH; ++k) {
+                    T item = static_cast<Leaf*>(result)->items[k];
+                    if (!merge(item, theirs->items[k])) {
+                        continue;
+                    }
+                    if (result == mine && !owned) {
+                        result = copyNode(mine, 0);
+                    }
+                    static_cast<Leaf*>(result)->items[k] = item;
+                }
+                return result;
+            });
+        }
+
+        // mergeWith a leaf at a time, for merges that take many elements at
+        // once: merge(mine, theirs) gets the PERSISTENT_WIDTH elements of two
+        // leaves the arrays do not share, changes mine and says whether it
+        // did. It may only write the elements it changes, since mine is the
+        // leaf itself when nothing else can reach it.
+        template <typename LeafMerge>
+        void mergeLeavesWith(const PersistentArray &other, LeafMerge merge)
+        {
+            mergeTree(other, [&merge](Leaf *mine, const Leaf *theirs, bool owned) -> Node* {
+                if (owned) {
+                    merge(mine->items, theirs->items);
+                    return mine;
+                }
+                T items[PERSISTENT_WIDTH];
+                for (unsigned k = 0; k < PERSISTENT_WIDTH; ++k) {
+                    items[k] = mine->items[k];
+                }
+                if (!merge(items, theirs->items)) {
+                    return mine;
+                }
+                countStat("state nodes copied");
+                Leaf *leaf = newNode<Leaf>();
+                for (unsigned k = 0; k < PERSISTENT_WIDTH; ++k) {
+                    leaf->items[k] = items[k];
+                }
+                return leaf;
+            });
+        }
+
+        // Whether equal(mine, theirs) holds for every pair of elements,
+        // comparing only the subtrees the two arrays do not share.
+        template <typename Equal>
+        bool equals(const PersistentArray &other, Equal equal) const
+        {
+            return count == other.count && equalNodes(root, other.root, height, equal);
+        }
+
+    public:
+        class InternTable;
+
+    private:
+        // An interned node knows its table and hash, to leave the table
+        // when its last reference goes.
+        struct Node {
+            unsigned refs = 1;
+            Arena *arena = nullptr;
+            InternTable *table = nullptr;
+            size_t key = 0;
+        };
+
+        struct Leaf: Node {
+            T items[PERSISTENT_WIDTH];
+        };
+
+        struct Branch: Node {
+            Node *children[PERSISTENT_WIDTH];
+        };
+
+    public:
+        // The canonical node for each content still in use, by height
+        // above the leaves. It holds no references: a node leaves it when
+        // the last array using it lets go.
+        class InternTable {
+            public:
+                InternTable() {}
+                InternTable(const InternTable &) = delete;
+                InternTable &operator=(const InternTable &) = delete;
+
+                ~InternTable()
+                {
+                    for (auto &level: levels) {
+                        for (auto &entry: level) {
+                            entry.second->table = nullptr;
+                        }
+                    }
+                }
+
+            private:
+                friend class PersistentArray;
+                typedef std::unordered_multimap<size_t, Node*, std::hash<size_t>, std::equal_to<size_t>,
+                                                ArenaAllocator<std::pair<const size_t, Node*>>> Level;
+                std::vector<Level> levels;
+        };
+
+        // Replaces every node by the one of table with the same content,
+        // entering those new to it, so two arrays interned in one table
+        // share a root exactly when their elements are the same. same(x, y)
+        // must imply hash(x) == hash(y). Interned nodes are never written in
+        // place, so they stay canonical while the table lives.
+        template <typename Hash, typename Same>
+        void intern(InternTable &table, Hash hash, Same same)
+        {
+            if (root == nullptr) {
+                return;
+            }
+            if (table.levels.size() <= height) {
+                table.levels.resize(height + 1);
+            }
+            Node *canonical = internNode(root, height, table, hash, same);
+            if (canonical != root) {
+                ++canonical->refs;
+                release(root, height);
+                root = canonical;
+            }
+        }
+
+    private:
+        template <typename N>
+        static N *newNode()
+        {
+            Arena *arena = activeArena();
+            N *node = new (arena != nullptr ? arena->allocate(sizeof(N)) : ::operator new(sizeof(N))) N;
+            node->arena = arena;
+            return node;
+        }
+
+        template <typename N>
+        static void deleteNode(N *node)
+        {
+            Arena *arena = node->arena;
+            node->~N();
+            if (arena != nullptr) {
+                arena->deallocate(node, sizeof(N));
+            } else {
+                ::operator delete(node);
+            }
+        }
+
+        static bool shared(const Node *node)
+        {
+            return node->refs > 1 || node->table != nullptr;
+        }
+
+        // A private copy of node, at height h above the leaves, holding one
+        // more reference to each child.
+        static Node *copyNode(Node *node, unsigned h)
+        {
+            countStat("state nodes copied");
+            if (h == 0) {
+                Leaf *leaf = newNode<Leaf>();
+                for (unsigned k = 0; k < PERSISTENT_WIDTH; ++k) {
+                    leaf->items[k] = static_cast<Leaf*>(node)->items[k];
+                }
+                return leaf;
+            }
+            Branch *branch = newNode<Branch>();
+            for (unsigned k = 0; k < PERSISTENT_WIDTH; ++k) {
+                branch->children[k] = static_cast<Branch*>(node)->children[k];
+                ++branch->children[k]->refs;
+            }
+            return branch;
+        }
+
+        static void release(Node *node, unsigned h)
+        {
+            if (node == nullptr || --node->refs > 0) {
+                return;
+            }
+            if (node->table != nullptr) {
+                auto &level = node->table->levels[h];
+                auto range = level.equal_range(node->key);
+                for (auto iter = range.first; iter != range.second; ++iter) {
+                    if (iter->second == node) {
+                        level.erase(iter);
+                        break;
+                    }
+                }
+            }
+            if (h == 0) {
+                deleteNode(static_cast<Leaf*>(node));
+                return;
+            }
+            Branch *branch = static_cast<Branch*>(node);
+            for (auto child: branch->children) {
+                release(child, h - 1);
+            }
+            deleteNode(branch);
+        }
+
+        template <typename MergeLeaf>
+        void mergeTree(const PersistentArray &other, MergeLeaf mergeLeaf)
+        {
+            Node *merged = mergeNode(root, other.root, height, true, mergeLeaf);
+            if (merged != root) {
+                release(root, height);
+                root = merged;
+            }
+        }
+
+        // mine with theirs merged in: mine itself, changed in place when
+        // owned says nothing else can reach it, or a new node otherwise.
+        // mergeLeaf(mine, theirs, owned) does the same for a pair of leaves.
+        template <typename MergeLeaf>
+        static Node *mergeNode(Node *mine, const Node *theirs, unsigned h, bool owned, MergeLeaf &mergeLeaf)
+        {
+            if (mine == theirs) {
+                return mine;
+            }
+            owned = owned && !shared(mine);
+            if (h == 0) {
+                return mergeLeaf(static_cast<Leaf*>(mine), static_cast<const Leaf*>(theirs), owned);
+            }
+            Node *result = mine;
+            const Branch *other = static_cast<const Branch*>(theirs);
+            for (unsigned k = 0; k < PERSISTENT_WIDTH; ++k) {
+                Node *child = static_cast<Branch*>(result)->children[k];
+                Node *merged = mergeNode(child, other->children[k], h - 1, owned || result != mine, mergeLeaf);
+                if (merged == child) {
+                    continue;
+                }
+                if (result == mine && !owned) {
+                    result = copyNode(mine, h);
+                }
+                release(child, h - 1);
+                static_cast<Branch*>(result)->children[k] = merged;
+            }
+            return result;
+        }
+
+        template <typename Hash, typename Same>
+        static Node *internNode(Node *node, unsigned h, InternTable &table, Hash &hash, Same &same)
+        {
+            if (node->table != nullptr) {
+                return node;
+            }
+            size_t key = h;
+            if (h == 0) {
+                for (auto &item: static_cast<Leaf*>(node)->items) {
+                    key = key * 31 + hash(item);
+                }
+            } else {
+                for (auto &child: static_cast<Branch*>(node)->children) {
+                    Node *canonical = internNode(child, h - 1, table, hash, same);
+                    if (canonical != child) {
+                        ++canonical->refs;
+                        release(child, h - 1);
+                        child = canonical;
+                    }
+                    key = key * 31 + std::hash<Node*>()(child);
+                }
+            }
+            auto range = table.levels[h].equal_range(key);
+            for (auto iter = range.first; iter != range.second; ++iter) {
+                if (sameNode(iter->second, node, h, same)) {
+                    countStat("interned nodes reused");
+                    return iter->second;
+                }
+            }
+            countStat("interned nodes");
+            node->table = &table;
+            node->key = key;
+            table.levels[h].insert(std::make_pair(key, node));
+            return node;
+        }
+
+        template <typename Same>
+        static bool sameNode(const Node *mine, const Node *theirs, unsigned h, Same &same)
+        {
+            for (unsigned k = 0; k < PERSISTENT_WIDTH; ++k) {
+                if (h == 0 ? !same(static_cast<const Leaf*>(mine)->items[k], static_cast<const Leaf*>(theirs)->items[k])
+                           : static_cast<const Branch*>(mine)->children[k] != static_cast<const Branch*>(theirs)->children[k]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        template <typename Equal>
+        static bool equalNodes(const Node *mine, const Node *theirs, unsigned h, Equal &equal)
+        {
+            if (mine == theirs) {
+                return true;
+            }
+            if (h == 0) {
+                for (unsigned k = 0; k < PERSISTENT_WIDTH; ++k) {
+                    if (!equal(static_cast<const Leaf*>(mine)->items[k], static_cast<const Leaf*>(theirs)->items[k])) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            for (unsigned k = 0; k < PERSISTENT_WIDTH; ++k) {
+                if (!equalNodes(static_cast<const Branch*>(mine)->children[k],
+                                static_cast<const Branch*>(theirs)->children[k], h - 1, equal)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        Node *root = nullptr;
+        size_t count = 0;
+        unsigned height = 0;
+};
+
+#endif
@@ -17,6 +17,10 @@
 #include "llvm/IR/InstrTypes.h"
 #include "llvm/IR/Type.h"
 #include "llvm/Support/raw_ostream.h"
+#include "../common/IRInput.h"
+#include "../common/CFG.h"
+#include "../common/ResultFormat.h"
+#include "../common/Stats.h"
 
 using namespace llvm;
 using namespace std;
@@ -406,13 +410,13 @@ class Interval {
         int supremum = 0;
         int min(int a, int b, int c, int d) {
             int array[4] = {a, b, c, d};
-            sort(array, array + 4);
+            std::sort(array, array + 4);
             return array[0];
         }
 
         int max(int a, int b, int c, int d) {
             int array[4] = {a, b, c, d};
-            sort(array, array + 4);
+            std::sort(array, array + 4);
             return array[3];
         }
 };
@@ -429,16 +433,36 @@ map<Value*, Interval> unionTwoMaps(map<Value*, Interval> map1, map<Value*, Inter
 
 int main(int argc, char **argv)
 {
-    // Read the IR file.
-    LLVMContext &Context = getGlobalContext();
+    // Read the IR file, textual or bitcode; "-" reads standard input. The
+    // context is owned by this run, so runs on other threads never share one.
+    LLVMContext Context;
     SMDiagnostic Err;
-    Module *M = ParseIRFile(argv[1], Err, Context);
+    auto parseStart = chrono::steady_clock::now();
+    Module *M = loadModule(argv[1], Err, Context);
+    auto parseTime = chrono::steady_clock::now() - parseStart;
     if (M == nullptr)
     {
         fprintf(stderr, "error: failed to load LLVM IR file \"%s\"", argv[1]);
         return EXIT_FAILURE;
     }
 
+    // --stats reports phase times and counters after the results (see
+    // common/Stats.h), as the loop analyses do.
+    bool wantStats = false;
+    for (int i = 2; i < argc; ++i) {
+        if (strcmp(argv[i], "--stats") == 0) {
+            wantStats = true;
+        } else {
+            fprintf(stderr, "error: unknown option \"%s\"\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    AnalysisStats stats;
+    activeStats() = wantStats ? &stats : nullptr;
+    if (wantStats) {
+        stats.addTime("parse", parseTime);
+    }
+
     map<Value*, Interval> intervalMap;
     map<Value*, Interval> newIntervalMap;
     map<Value*, pair<bool, bool>> boolMap;
@@ -447,6 +471,14 @@ int main(int argc, char **argv)
     int blkCount = 1;
     for (auto &F: *M)
         if (strncmp(F.getName().str().c_str(), "main", 4) == 0) {
+            {
+                PhaseTimer timer("parse");
+                if (!materialize(F)) {
+                    return EXIT_FAILURE;
+                }
+            }
+            PhaseTimer timer("solve");
+            int startCount = blkCount;
             BasicBlock* BB = dyn_cast<BasicBlock>(F.begin());
             blockQueue.push(BB);
             intervalMap = initInterval(BB);
@@ -455,10 +487,19 @@ int main(int argc, char **argv)
                 BasicBlock *next = blockQueue.front();
                 blockQueue.pop();
                 intervalMap = traverseCFG(next, blkCount, newIntervalMap, boolMap, blockQueue);
+                PhaseTimer timer("print");
                 cout << "=========== Final Result ===========" << endl;
                 printMap(intervalMap);
             }
+            if (wantStats) {
+                stats.addIterations(F.getName().str(), blkCount - startCount);
+            }
         }
+
+    if (wantStats) {
+        stats.print(ResultPrinter("intervalAnalysis"));
+        activeStats() = nullptr;
+    }
     return 0;
 }
 
@@ -758,6 +799,10 @@ void transfer(
     map<Value*, Interval> &intervalMap,
     map<Value*, pair<bool, bool>> &boolMap)
 {
+    PhaseTimer timer("transfer");
+    if (AnalysisStats *stats = activeStats()) {
+        stats->countOpcode(I.getOpcodeName());
+    }
     if (isa<ICmpInst>(&I)) {
         Value *op1 = I.getOperand(0);
         Value *op2 = I.getOperand(1);
@@ -926,18 +971,25 @@ map<Value*, Interval> traverseCFG(
     for (auto &I: *BB) {
         transfer(I, intervalMap, boolMap);
     }
+    countStat("block visits");
 
-    cout << "Block " << blkCount << endl;
-    cout << "=========== Old Interval Map ===========" << endl;
-    printMap(oldMap);
+    {
+        PhaseTimer timer("print");
+        cout << "Block " << blkCount << endl;
+        cout << "=========== Old Interval Map ===========" << endl;
+        printMap(oldMap);
+    }
     intervalMap = unionTwoMaps(intervalMap, oldMap);
-    cout << "=========== New Interval Map ===========" << endl;
-    printMap(intervalMap);
+    {
+        PhaseTimer timer("print");
+        cout << "=========== New Interval Map ===========" << endl;
+        printMap(intervalMap);
+    }
 
     ++blkCount;
     if (blkCount == 100000) { exit(EXIT_SUCCESS); }
 
-    const TerminatorInst *TInst = BB->getTerminator();
+    const Terminator *TInst = BB->getTerminator();
     // unsigned int NSucc = TInst->getNumSuccessors();
     if (isa<BranchInst>(TInst)) {
         const BranchInst *BInst = dyn_cast<BranchInst>(TInst);
@@ -948,9 +1000,15 @@ map<Value*, Interval> traverseCFG(
             queue<BasicBlock*> falseBrQueue;
             if (iter->second.first) {
                 trueBrQueue.push(TInst->getSuccessor(0));
+                if (AnalysisStats *stats = activeStats()) {
+                    stats->countEdge(BB, TInst->getSuccessor(0));
+                }
             }
             if (iter->second.second) {
                 falseBrQueue.push(TInst->getSuccessor(1));
+                if (AnalysisStats *stats = activeStats()) {
+                    stats->countEdge(BB, TInst->getSuccessor(1));
+                }
             }
 
             map<Value*, Interval> newIntervalMap1 = backwardUpdate(BB, intervalMap, boolMap);
@@ -977,6 +1035,9 @@ map<Value*, Interval> traverseCFG(
             // }
             // cout << "=========== Unconditional Branch ===========" << endl;
             blockQueue.push(TInst->getSuccessor(0));
+            if (AnalysisStats *stats = activeStats()) {
+                stats->countEdge(BB, TInst->getSuccessor(0));
+            }
         }
     }
     return intervalMap;
@@ -994,6 +1055,7 @@ void printMap(const map<Value*, Interval> &intervalMap)
 }
 
 map<Value*, Interval> unionTwoMaps(map<Value*, Interval> map1, map<Value*, Interval> map2) {
+        PhaseTimer timer("join");
 
         for (auto iter2 = map2.begin(); iter2 != map2.end(); ++iter2) {
             auto iter1 = map1.find(iter2->first);
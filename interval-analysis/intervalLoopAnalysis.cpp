@@ -5,6 +5,13 @@
 #include <algorithm>
 #include <cstring>
 #include <map>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cstdlib>
+#include <fstream>
+#include <unistd.h>
+#include "llvm/Config/llvm-config.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Function.h"
@@ -16,520 +23,636 @@
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/InstrTypes.h"
 #include "llvm/IR/Type.h"
+#include "llvm/IR/DerivedTypes.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/ADT/DenseMap.h"
+#include "Interval.h"
+#ifdef INTERVAL_KERNELS
+#include "IntervalKernels.h"
+#endif
+#include "PersistentArray.h"
+#include "../common/Arena.h"
+#include "../common/IRInput.h"
+#include "../common/CFG.h"
+#include "../common/WTO.h"
+#include "../common/ResultCache.h"
+#include "../common/OutputRedirect.h"
+#include "../common/ResultFormat.h"
+#include "../common/Trace.h"
+#include "../common/Stats.h"
+#include "../common/AnalysisTools.h"
+#include "IntervalLoopAnalysis.h"
+
+// Number of times a loop head is visited before its input is widened.
+#define WIDEN_DELAY 3
+
+// Number of widenings at a loop head that stop at the next program constant
+// (see wideningThresholds); later ones go straight to infinity.
+#define THRESHOLD_WIDENINGS 2
+
+// Bump whenever the printed result for the same IR and options changes.
+#define RESULT_VERSION 5
 
 using namespace llvm;
 using namespace std;
 
-class Interval {
-    public:
-        Interval() {
-             nInfinity = true;
-             pInfinity = true;
-        }
-
-        Interval(const bool inf, const bool sup): nInfinity(inf), pInfinity(sup) {}
-        Interval(const int inf, const bool sup): pInfinity(sup), infimum(inf) {}
-        Interval(const bool inf, const int sup): nInfinity(inf), supremum(sup) {}
-        Interval(const int inf, const int sup): infimum(inf), supremum(sup) {}
-
-        Interval operator+(const Interval &rhs)
-        {
-            const Interval &lhs = *this;
-            int newInf = 0, newSup = 0;
-            bool newNInfinity = false, newPInfinity = false;
-            if (lhs.nInfinity || rhs.nInfinity) {
-                newNInfinity = true;
-            }
-
-            if(!lhs.nInfinity && !rhs.nInfinity) {
-                newNInfinity = false;
-                newInf = lhs.infimum + rhs.infimum;
-            }
+namespace interval {
 
-            if (lhs.pInfinity || rhs.pInfinity) {
-                newPInfinity = true;
-            }
-
-            if (!lhs.pInfinity && !rhs.pInfinity) {
-                newPInfinity = false;
-                newSup = lhs.supremum + rhs.supremum;
-            }
-
-            return Interval(newInf, newSup, newNInfinity, newPInfinity);
+// Integer globals with a known initial value, tracked like local variables.
+vector<GlobalVariable*> trackedGlobals(Module &M)
+{
+    vector<GlobalVariable*> globals;
+    for (auto GV = M.global_begin(); GV != M.global_end(); ++GV) {
+        if (GV->hasInitializer() && isa<ConstantInt>(GV->getInitializer())) {
+            globals.push_back(&*GV);
         }
+    }
+    return globals;
+}
 
-        Interval& operator+=(const Interval &rhs)
-        {
-            *this = *this + rhs;
-            return *this;
+ValueNumbering::ValueNumbering(Function &F)
+{
+    for (auto arg = F.arg_begin(); arg != F.arg_end(); ++arg) {
+        values.push_back(&*arg);
+    }
+    for (auto GV: trackedGlobals(*F.getParent())) {
+        values.push_back(GV);
+    }
+    for (auto &BB: F) {
+        for (auto &I: BB) {
+            values.push_back(dyn_cast<Value>(&I));
         }
+    }
+    std::sort(values.begin(), values.end());
+    for (unsigned i = 0; i < values.size(); ++i) {
+        ids[values[i]] = i;
+    }
+}
 
-        Interval operator-(const Interval &rhs)
-        {
-            const Interval &lhs = *this;
-            int newInf = 0, newSup = 0;
-            bool newNInfinity = false, newPInfinity = false;
-            if (lhs.nInfinity || rhs.pInfinity) {
-                newNInfinity = true;
-            }
-
-            if(!lhs.nInfinity && !rhs.pInfinity) {
-                newNInfinity = false;
-                newInf = lhs.infimum - rhs.supremum;
-            }
+// What a call to a function yields for one abstract input: the interval of
+// the returned value and of every tracked global when it returns.
+struct FunctionSummary {
+    Interval64 returnInterval;
+    vector<Interval64> globalsOut;
+};
 
-            if (lhs.pInfinity || rhs.nInfinity) {
-                newPInfinity = true;
-            }
+// Summaries memoized per function and abstract input, where the input is the
+// interval of each argument followed by each tracked global.
+class SummaryCache {
+    public:
+        explicit SummaryCache(Module &M): globals(trackedGlobals(M)) {}
 
-            if (!lhs.pInfinity && !rhs.nInfinity) {
-                newPInfinity = false;
-                newSup = lhs.supremum - rhs.infimum;
-            }
+        FunctionSummary lookup(Function *F, const vector<Interval64> &input);
+        vector<Interval64> topInput(Function *F) const;
 
-            return Interval(newInf, newSup, newNInfinity, newPInfinity);
-        }
+        vector<GlobalVariable*> globals;
+        int narrowingPasses = NARROWING_PASSES;
+        int hits = 0;
+        int misses = 0;
 
-        Interval& operator-=(const Interval &rhs)
-        {
-            *this = *this - rhs;
-            return *this;
-        }
+    private:
+        map<Function*, map<vector<Interval64>, FunctionSummary>> cache;
+        set<Function*> inProgress;
+};
 
+// Names for blocks and values that survive edits elsewhere in the function:
+// a block goes by its label (or position when unnamed), an instruction by its
+// block and position, an argument by position and a global by its name.
+class StableNames {
+    public:
+        StableNames() {}
+        explicit StableNames(Function &F);
 
-        Interval operator*(const Interval &rhs)
+        string blockKey(BasicBlock *BB) const
         {
-            const Interval &lhs = *this;
-            int newInf = 0, newSup = 0;
-            bool newNInfinity = false, newPInfinity = false;
-            if (lhs.nInfinity || rhs.nInfinity) {
-                newNInfinity = true;
-            }
-
-            if (lhs.pInfinity || rhs.pInfinity) {
-                newPInfinity = true;
-            }
-
-            if (lhs.supremum < 0 && rhs.nInfinity) {
-                newPInfinity = true;
-            }
-
-            if (lhs.infimum < 0 && rhs.nInfinity) {
-                newPInfinity = true;
-            }
-
-            if (lhs.nInfinity && rhs.supremum < 0) {
-                newPInfinity = true;
-            }
-
-            if (lhs.nInfinity && rhs.infimum < 0) {
-                newPInfinity = true;
-            }
-
-            if (lhs.supremum < 0 && rhs.pInfinity) {
-                newNInfinity = true;
-            }
-
-            if (lhs.infimum < 0 && rhs.pInfinity) {
-                newNInfinity = true;
-            }
-
-            if (lhs.pInfinity && rhs.supremum < 0) {
-                newNInfinity = true;
-            }
-
-            if (lhs.pInfinity && rhs.infimum < 0) {
-                newNInfinity = true;
-            }
-
-            int ab = lhs.infimum * rhs.infimum;
-            int bc = lhs.infimum * rhs.supremum;
-            int cd = lhs.supremum * rhs.infimum;
-            int da = lhs.supremum * rhs.supremum;
-            newInf = this->min(ab, bc, cd, da);
-            newSup = this->max(ab, bc, cd, da);
-
-            return Interval(newInf, newSup, newNInfinity, newPInfinity);
+            return blockKeys.find(BB)->second;
         }
 
-        Interval& operator*=(const Interval &rhs)
+        // Keys of the blocks branching to BB, in layout order.
+        const vector<string> &predecessorKeys(BasicBlock *BB) const
         {
-            *this = *this * rhs;
-            return *this;
+            return predecessors.find(BB)->second;
         }
 
-        bool operator>(const int rhs)
+        string valueKey(Value *V) const
         {
-            const Interval &lhs = *this;
-
-            if (lhs.pInfinity) {
-                return true;
-            }
-
-            if (!lhs.nInfinity && lhs.infimum > rhs) {
-                return true;
-            }
-
-            if (!lhs.pInfinity && lhs.supremum > rhs) {
-                return true;
-            }
-
-            return false;
+            return valueKeys.find(V)->second;
         }
 
-        bool operator>=(const int rhs)
+        bool hasValue(Value *V) const
         {
-            const Interval &lhs = *this;
-
-            if (lhs.pInfinity) {
-                return true;
-            }
-
-            if (!lhs.nInfinity && lhs.infimum >= rhs) {
-                return true;
-            }
-
-            if (!lhs.pInfinity && lhs.supremum >= rhs) {
-                return true;
-            }
-
-            return false;
+            return valueKeys.find(V) != valueKeys.end();
         }
 
-        bool operator<(const int rhs)
+        Value *value(const string &key) const
         {
-            const Interval &lhs = *this;
+            auto iter = values.find(key);
+            return iter == values.end() ? nullptr : iter->second;
+        }
 
-            if (lhs.nInfinity) {
-                return true;
-            }
+    private:
+        map<BasicBlock*, string> blockKeys;
+        map<BasicBlock*, vector<string>> predecessors;
+        map<Value*, string> valueKeys;
+        map<string, Value*> values;
+};
 
-            if (!lhs.nInfinity && lhs.infimum < rhs) {
-                return true;
-            }
+// What solveIncremental threads through the elements of the weak
+// topological order it iterates. The states it stores are interned in
+// table, so equal ones share their tries and the fixpoint check at a loop
+// head that stopped changing compares two pointers.
+struct IncrementalSolve {
+    const ValueNumbering &numbering;
+    int &visitCount;
+    map<Value*, pair<bool, bool>> &boolMap;
+    SummaryCache *summaries;
+    BlockStates &states;
+    const set<BasicBlock*> &frozen;
+    ArenaSet<BasicBlock*> feeders;
+    ArenaMap<BasicBlock*, int> headVisits;
+    vector<int64_t> thresholds;
+    const ResultPrinter &printer;
+    IntervalMap::StateTable table;
+};
 
-            if (!lhs.pInfinity && lhs.supremum < rhs) {
-                return true;
-            }
+IntervalMap traverseCFG(
+    BasicBlock* BB,
+    int &blkCount,
+    IntervalMap intervalMap,
+    map<Value*, pair<bool, bool>> &boolMap,
+    queue<BasicBlock*> &blockQueue,
+    set<BasicBlock*> &masterTraversedBlocks,
+    queue<BasicBlock*> &masterBlockQueue,
+    const ResultPrinter &printer);
+unsigned valueBits(Value *V);
+Interval64 arithmetic(unsigned opcode, unsigned bits, const Interval64 &lhs, const Interval64 &rhs);
+void printMap(const IntervalMap &intervalMap);
+ResultItem intervalItem(Value *var, const Interval64 &interval);
+vector<ResultItem> mapItems(const IntervalMap &intervalMap);
+void traceInstruction(const ResultPrinter &printer, int block, Instruction &I, const IntervalMap &intervalMap);
+void printBlock(const ResultPrinter &printer, int block, const IntervalMap &oldMap, const IntervalMap &newMap);
+IntervalMap unionTwoMaps(IntervalMap newMap, IntervalMap oldMap);
+#ifdef INTERVAL_KERNELS
+bool joinLeaf(IntervalMap::Entry *newEntries, const IntervalMap::Entry *oldEntries);
+bool widenLeaf(IntervalMap::Entry *oldEntries, const IntervalMap::Entry *newEntries);
+bool narrowLeaf(IntervalMap::Entry *oldEntries, const IntervalMap::Entry *newEntries);
+#endif
+vector<int64_t> wideningThresholds(Function &F);
+IntervalMap widenMap(IntervalMap newMap, IntervalMap oldMap, const vector<int64_t> &thresholds);
+IntervalMap narrowMap(IntervalMap newMap, IntervalMap oldMap);
+bool reachFixedPoint(IntervalMap map1, IntervalMap map2);
+IntervalMap solveRecursive(
+    Function &F,
+    const ValueNumbering &numbering,
+    int &blkCount,
+    map<Value*, pair<bool, bool>> &boolMap,
+    const ResultPrinter &printer);
+IntervalMap solveWorklist(
+    Function &F,
+    const ValueNumbering &numbering,
+    int &visitCount,
+    map<Value*, pair<bool, bool>> &boolMap,
+    SummaryCache *summaries,
+    const IntervalMap &entryMap,
+    int narrowingPasses,
+    const ResultPrinter &printer);
+void solveElement(IncrementalSolve &solve, const WTOElement &element);
+void solveBlock(IncrementalSolve &solve, BasicBlock *BB);
+void runBlock(IncrementalSolve &solve, BasicBlock *BB, const IntervalMap &input);
+bool edgeState(IncrementalSolve &solve, BasicBlock *BB, unsigned i, IntervalMap &edgeMap);
+void narrowStates(IncrementalSolve &solve, const WeakTopologicalOrder &order, int passes);
+vector<Function*> bottomUpOrder(Module &M);
+map<string, string> readInvariants(const string &path);
+bool writeInvariants(const string &path, const map<string, string> &sections);
+string globalInitializers(Module &M);
+string invariantContext(Module &M, Function &F, const string &options, bool interprocedural);
+string blockHash(BasicBlock &BB, const StableNames &names);
+string saveInvariants(Function &F, const StableNames &names, const BlockStates &states, const string &context);
+void writeStateMap(ostringstream &out, const char *tag, const IntervalMap &intervalMap, const StableNames &names);
+bool readStateMap(istringstream &in, const char *tag, IntervalMap &intervalMap, const StableNames &names, const ValueNumbering &numbering);
+set<BasicBlock*> restoreInvariants(
+    const string &section,
+    Function &F,
+    const StableNames &names,
+    const ValueNumbering &numbering,
+    const string &context,
+    BlockStates &states);
+bool sameStates(const BlockStates &lhs, const BlockStates &rhs);
+
+int runLoopAnalysis(int argc, char **argv)
+{
+    // Read the IR file, textual or bitcode; "-" reads standard input. The
+    // context is owned by this run, so runs on other threads never share one.
+    LLVMContext Context;
+    SMDiagnostic Err;
+    auto parseStart = chrono::steady_clock::now();
+    Module *M = loadModule(argv[1], Err, Context);
+    auto parseTime = chrono::steady_clock::now() - parseStart;
+    if (M == nullptr)
+    {
+        fprintf(stderr, "error: failed to load LLVM IR file \"%s\"", argv[1]);
+        return EXIT_FAILURE;
+    }
 
-            return false;
+    // --recursive runs the original recursive walker instead of the worklist
+    // solver, --compare-visits runs both and reports the block visits saved.
+    // --interprocedural resolves calls through per-function summaries.
+    // --narrowing N runs up to N descending passes after the worklist solver
+    // converges (default NARROWING_PASSES, 0 for none).
+    // --cache-dir DIR reuses results of unchanged functions from earlier runs.
+    // --invariants FILE warm-starts from the per-block states saved in FILE by
+    // the previous run and re-solves only blocks an edit can affect;
+    // --verify-incremental also solves from scratch and checks they agree.
+    // --format text|jsonl|binary picks how results are written (see
+    // common/ResultFormat.h); text is the default.
+    // --trace off|summary|block|instruction picks how much of the solving is
+    // shown besides the results (see common/Trace.h); block is the default.
+    // --stats reports phase times and solver counters after the results
+    // (see common/Stats.h).
+    traceLevel() = TRACE_DEFAULT;
+    bool useRecursive = false;
+    bool wantStats = false;
+    string invariantsPath;
+    bool verifyIncremental = false;
+    bool compareVisits = false;
+    bool interprocedural = false;
+    int narrowingPasses = NARROWING_PASSES;
+    ResultCache resultCache("intervalLoopAnalysis", RESULT_VERSION);
+    ResultPrinter printer("intervalLoopAnalysis");
+    for (int i = 2; i < argc; ++i) {
+        if (strcmp(argv[i], "--recursive") == 0) {
+            useRecursive = true;
+            resultCache.addOption(argv[i]);
+        } else if (strcmp(argv[i], "--compare-visits") == 0) {
+            compareVisits = true;
+            resultCache.addOption(argv[i]);
+        } else if (strcmp(argv[i], "--interprocedural") == 0) {
+            interprocedural = true;
+            resultCache.addOption(argv[i]);
+        } else if (strcmp(argv[i], "--narrowing") == 0 && i + 1 < argc) {
+            char *end;
+            narrowingPasses = strtol(argv[++i], &end, 10);
+            if (*end != '\0' || narrowingPasses < 0) {
+                fprintf(stderr, "error: --narrowing needs a number of passes, not \"%s\"\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+            resultCache.addOption(argv[i - 1]);
+            resultCache.addOption(argv[i]);
+        } else if (strcmp(argv[i], "--cache-dir") == 0 && i + 1 < argc) {
+            if (!resultCache.open(argv[++i])) {
+                fprintf(stderr, "error: cannot create cache directory \"%s\"\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--invariants") == 0 && i + 1 < argc) {
+            invariantsPath = argv[++i];
+        } else if (strcmp(argv[i], "--verify-incremental") == 0) {
+            verifyIncremental = true;
+        } else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            if (!printer.setFormat(argv[++i])) {
+                fprintf(stderr, "error: unknown format \"%s\"\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+            resultCache.addOption(argv[i - 1]);
+            resultCache.addOption(argv[i]);
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            if (!parseTraceLevel(argv[++i], traceLevel())) {
+                fprintf(stderr, "error: unknown trace level \"%s\"\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+            resultCache.addOption(argv[i - 1]);
+            resultCache.addOption(argv[i]);
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            wantStats = true;
+        } else {
+            fprintf(stderr, "error: unknown option \"%s\"\n", argv[i]);
+            return EXIT_FAILURE;
         }
+    }
 
-        bool operator<=(const int rhs)
-        {
-            const Interval &lhs = *this;
+    if (interprocedural && useRecursive) {
+        fprintf(stderr, "error: --interprocedural needs the worklist solver\n");
+        return EXIT_FAILURE;
+    }
+    if (!invariantsPath.empty() && useRecursive) {
+        fprintf(stderr, "error: --invariants needs the worklist solver\n");
+        return EXIT_FAILURE;
+    }
+    if (!invariantsPath.empty() && resultCache.enabled()) {
+        fprintf(stderr, "error: --invariants cannot be combined with --cache-dir\n");
+        return EXIT_FAILURE;
+    }
+    if (verifyIncremental && invariantsPath.empty()) {
+        fprintf(stderr, "error: --verify-incremental needs --invariants\n");
+        return EXIT_FAILURE;
+    }
 
-            if (lhs.nInfinity) {
-                return true;
-            }
+    // The report comes after all functions, so it never enters the cache.
+    AnalysisStats stats;
+    activeStats() = wantStats ? &stats : nullptr;
+    if (wantStats) {
+        stats.addTime("parse", parseTime);
+    }
 
-            if (!lhs.nInfinity && lhs.infimum <= rhs) {
-                return true;
-            }
+    printer.begin();
 
-            if (!lhs.pInfinity && lhs.supremum <= rhs) {
-                return true;
-            }
+    // Sections of the invariants file, one per analyzed function.
+    map<string, string> invariantSections;
+    if (!invariantsPath.empty()) {
+        invariantSections = readInvariants(invariantsPath);
+    }
 
-            return false;
+    // Summaries and the module-wide cache key read every function body.
+    if (interprocedural) {
+        PhaseTimer timer("parse");
+        if (!materializeAll(*M)) {
+            return EXIT_FAILURE;
         }
+    }
 
-        bool operator==(const int rhs)
-        {
-            const Interval &lhs = *this;
-
-            if (lhs.nInfinity && lhs.pInfinity) {
-                return true;
-            }
-
-            if (lhs.nInfinity && lhs.supremum >= rhs) {
-                return true;
-            }
+    SummaryCache cache(*M);
+    cache.narrowingPasses = narrowingPasses;
+    SummaryCache *summaries = nullptr;
+    map<Value*, pair<bool, bool>> boolMap;
 
-            if (lhs.pInfinity && lhs.infimum <= rhs) {
-                return true;
+    int blkCount = 1;
+    for (auto &F: *M)
+        if (strncmp(F.getName().str().c_str(), "main", 4) == 0) {
+            // Everything the analysis of F allocates, states and worklists,
+            // comes from one arena freed at the end of the iteration.
+            ArenaScope arena;
+            {
+                PhaseTimer timer("parse");
+                if (!materialize(F)) {
+                    return EXIT_FAILURE;
+                }
             }
-
-            if (!lhs.nInfinity && lhs.pInfinity && lhs.infimum <= rhs) {
-                return true;
+            printer.function = F.getName().str();
+
+            // With summaries the result also depends on every callee, so the
+            // whole module is hashed. F's text does not show the initial
+            // values of the globals its entry state starts from.
+            string key;
+            if (resultCache.enabled()) {
+                string carriedIn = to_string(blkCount) + globalInitializers(*M);
+                key = interprocedural ? resultCache.key(*M, F, carriedIn) : resultCache.key(F, carriedIn);
+                string carriedOut, cached;
+                if (resultCache.lookup(key, carriedOut, cached)) {
+                    blkCount = atoi(carriedOut.c_str());
+                    cout << cached;
+                    continue;
+                }
             }
-
-            if (!lhs.pInfinity && lhs.nInfinity && lhs.supremum >= rhs) {
-                return true;
+            ostringstream captured;
+            streambuf *uncaptured = nullptr;
+            if (resultCache.enabled()) {
+                uncaptured = redirectOutput(captured.rdbuf());
             }
 
-            if (!lhs.pInfinity && !lhs.nInfinity) {
-                if (lhs.infimum <= rhs && lhs.supremum >= rhs) {
-                    return true;
+            // Summarize every callee bottom-up over the call graph, so the
+            // entry points only cost a summary lookup per call site.
+            if (interprocedural && summaries == nullptr) {
+                summaries = &cache;
+                for (auto callee: bottomUpOrder(*M)) {
+                    if (strncmp(callee->getName().str().c_str(), "main", 4) != 0) {
+                        cache.lookup(callee, cache.topInput(callee));
+                    }
                 }
             }
 
-            return false;
-        }
-
-        bool operator!=(const int rhs)
-        {
-            return !(*this == rhs);
-        }
-
-        bool operator==(const Interval rhs)
-        {
-            const Interval &lhs = *this;
-            if (lhs.nInfinity != rhs.nInfinity) {
-                return false;
+            ValueNumbering numbering(F);
+            IntervalMap newMap;
+            int visitCount = 0;
+            if (useRecursive) {
+                int startCount = blkCount;
+                newMap = solveRecursive(F, numbering, blkCount, boolMap, printer);
+                visitCount = blkCount - startCount;
+            } else if (invariantsPath.empty()) {
+                newMap = solveWorklist(F, numbering, visitCount, boolMap, summaries, initInterval(&F.getEntryBlock(), numbering), narrowingPasses, printer);
+            }
+
+            // Blocks whose saved states still hold are frozen; the rest start
+            // from nothing and are re-solved from the frozen frontier.
+            StableNames names;
+            string context;
+            BlockStates states;
+            states.keepAscending = true;
+            set<BasicBlock*> frozen;
+            map<Value*, pair<bool, bool>> scratchBoolMap = boolMap;
+            if (!invariantsPath.empty()) {
+                names = StableNames(F);
+                context = invariantContext(*M, F, resultCache.optionList(), interprocedural);
+                auto found = invariantSections.find(F.getName().str());
+                if (found != invariantSections.end()) {
+                    frozen = restoreInvariants(found->second, F, names, numbering, context, states);
+                }
+                BasicBlock *entry = &F.getEntryBlock();
+                if (frozen.find(entry) == frozen.end()) {
+                    states.inMaps[entry] = initInterval(entry, numbering);
+                }
+                newMap = solveIncremental(F, numbering, visitCount, boolMap, summaries, states, frozen, narrowingPasses, printer);
             }
 
-            if (lhs.pInfinity != rhs.pInfinity) {
-                return false;
+            if (AnalysisStats *stats = activeStats()) {
+                stats->addIterations(F.getName().str(), visitCount);
             }
 
-            if (!lhs.nInfinity && !rhs.nInfinity) {
-                if (lhs.infimum != rhs.infimum) {
-                    return false;
+            {
+                PhaseTimer timer("print");
+                if (printer.text()) {
+                    cout << "=========== Final Result ===========\n";
+                    printMap(newMap);
+                } else {
+                    printer.write("final", 0, mapItems(newMap));
                 }
             }
 
-            if (!lhs.pInfinity && !rhs.pInfinity) {
-                if (lhs.supremum != rhs.supremum) {
-                    return false;
+            if (!invariantsPath.empty()) {
+                if (printer.text()) {
+                    cout << "Warm start: " << frozen.size() << " of " << F.size()
+                         << " blocks reused, " << visitCount << " block visits\n";
+                } else {
+                    vector<ResultItem> items;
+                    items.push_back(ResultItem::count("reused", frozen.size()));
+                    items.push_back(ResultItem::count("blocks", F.size()));
+                    items.push_back(ResultItem::count("visits", visitCount));
+                    printer.write("warm-start", 0, items);
                 }
-            }
-
-            return true;
-        }
-
-        bool operator!=(const Interval rhs)
-        {
-            return !(*this == rhs);
-        }
 
-
-        void print() const
-        {
-            if (empty) {
-                cout << "EMPTY INTERVAL" << endl;
-            } else {
-                cout << "[";
-                if (nInfinity) {
-                    cout << "-INFINITY";
+                if (verifyIncremental) {
+                    BlockStates scratch;
+                    scratch.inMaps[&F.getEntryBlock()] = initInterval(&F.getEntryBlock(), numbering);
+                    int scratchCount = 0;
+                    int savedLevel = traceLevel();
+                    AnalysisStats *savedStats = activeStats();
+                    traceLevel() = TRACE_OFF;
+                    activeStats() = nullptr;
+                    IntervalMap scratchMap = solveIncremental(F, numbering, scratchCount, scratchBoolMap, summaries, scratch, set<BasicBlock*>(), narrowingPasses, printer);
+                    traceLevel() = savedLevel;
+                    activeStats() = savedStats;
+                    if (!sameStates(states, scratch) || !reachFixedPoint(newMap, scratchMap)) {
+                        cerr << "error: warm-started states of " << F.getName().str()
+                             << " differ from a from-scratch run" << endl;
+                        return EXIT_FAILURE;
+                    }
+                    if (printer.text()) {
+                        cout << "Incremental check: identical to a from-scratch run of "
+                             << scratchCount << " block visits\n";
+                    } else {
+                        vector<ResultItem> items(1, ResultItem::count("visits", scratchCount));
+                        printer.write("incremental-check", 0, items);
+                    }
+                }
+                invariantSections[F.getName().str()] = saveInvariants(F, names, states, context);
+            }
+
+            if (compareVisits) {
+                // Replay the other engine with its tracing and statistics off.
+                map<Value*, pair<bool, bool>> otherBoolMap;
+                int otherCount = 0;
+                int savedLevel = traceLevel();
+                AnalysisStats *savedStats = activeStats();
+                traceLevel() = TRACE_OFF;
+                activeStats() = nullptr;
+                if (useRecursive) {
+                    solveWorklist(F, numbering, otherCount, otherBoolMap, summaries, initInterval(&F.getEntryBlock(), numbering), narrowingPasses, printer);
                 } else {
-                    cout << infimum;
+                    int otherBlkCount = 1;
+                    solveRecursive(F, numbering, otherBlkCount, otherBoolMap, printer);
+                    otherCount = otherBlkCount - 1;
                 }
-                cout << ", ";
-                if (pInfinity) {
-                    cout << "INFINITY";
+                traceLevel() = savedLevel;
+                activeStats() = savedStats;
+
+                int worklistVisits = useRecursive ? otherCount : visitCount;
+                int recursiveVisits = useRecursive ? visitCount : otherCount;
+                if (printer.text()) {
+                    cout << "Block visits: worklist " << worklistVisits
+                         << ", recursive " << recursiveVisits
+                         << ", saved " << recursiveVisits - worklistVisits << "\n";
                 } else {
-                    cout << supremum;
+                    vector<ResultItem> items;
+                    items.push_back(ResultItem::count("worklist", worklistVisits));
+                    items.push_back(ResultItem::count("recursive", recursiveVisits));
+                    printer.write("block-visits", 0, items);
                 }
-                    cout << "]" << endl;
-            }
-        }
-        void widenWith(const Interval &rhs) {
-
-            if (rhs.nInfinity) {
-                this->nInfinity = true;
-            }
-
-            if (rhs.pInfinity) {
-                this->pInfinity = true;
-            }
-
-            if (!rhs.nInfinity && !this->nInfinity && this->infimum > rhs.infimum) {
-                this->nInfinity = true;
-            }
-
-            if (!rhs.pInfinity && !this->pInfinity && this->supremum < rhs.supremum) {
-                this->pInfinity = true;
-            }
-        }
-
-        void narrowWith(const Interval &rhs) {
-
-            if (!rhs.nInfinity && this->nInfinity) {
-                this->infimum = rhs.infimum;
-                this->nInfinity = false;
-            }
-
-            if (!rhs.pInfinity && this->pInfinity) {
-                this->supremum = rhs.supremum;
-                this->pInfinity = false;
-            }
-        }
-
-        void unionWith(const Interval &rhs) {
-            if (rhs.nInfinity) {
-                this->nInfinity = rhs.nInfinity;
-            }
-
-            if (rhs.pInfinity) {
-                this->pInfinity = rhs.pInfinity;
-            }
-
-            if (!rhs.nInfinity && !this->nInfinity) {
-                this->infimum = std::min(this->infimum, rhs.infimum);
             }
 
-            if (!rhs.pInfinity && !this->pInfinity) {
-                this->supremum = std::max(this->supremum, rhs.supremum);
+            if (resultCache.enabled()) {
+                redirectOutput(uncaptured);
+                resultCache.store(key, to_string(blkCount), captured.str());
+                cout << captured.str();
             }
         }
 
-        void intersectionWith(const Interval &rhs) {
-
-            if (this->nInfinity && !rhs.nInfinity) {
-                this->infimum = rhs.infimum;
-                this->nInfinity = rhs.nInfinity;
-            }
-
-            if (this->pInfinity && !rhs.pInfinity) {
-                this->supremum = rhs.supremum;
-                this->pInfinity = rhs.pInfinity;
-            }
-
-            // if (!this->nInfinity && rhs.nInfinity) {
-            //
-            // }
-            //
-            // if (!this->pInfinity && rhs.pInfinity) {
-            //
-            // }
-
-            if (!this->nInfinity && !this->pInfinity && !rhs.nInfinity && rhs.pInfinity && this->supremum >= rhs.infimum) {
-                this->infimum = std::max(this->infimum, rhs.infimum);
-            }
-
-            if (!this->nInfinity && this->pInfinity && !rhs.nInfinity && !rhs.pInfinity && this->infimum <= rhs.supremum) {
-                this->infimum = std::max(this->infimum, rhs.infimum);
-                this->supremum = rhs.supremum;
-            }
-
-            if (!this->nInfinity && !this->pInfinity && rhs.nInfinity && !rhs.pInfinity && this->infimum <= rhs.supremum) {
-                this->supremum = std::min(this->supremum, rhs.supremum);
-            }
-
-            if (this->nInfinity && !this->pInfinity && !rhs.nInfinity && !rhs.pInfinity && this->supremum >= rhs.infimum) {
-                this->infimum = rhs.infimum;
-                this->supremum = std::min(this->supremum, rhs.supremum);
-            }
-
-            // if (!(this->infimum <= rhs.supremum) || !(this->supremum >= rhs.infimum)) {
-            //     this->empty = true;
-            // }
-
-
-        }
-
-        bool justInitialized() {
-            if (nInfinity && pInfinity) {
-                return true;
-            }
-            return false;
+    // Module-wide counters belong to no function.
+    printer.function.clear();
+    if (interprocedural) {
+        if (printer.text()) {
+            cout << "Summaries: " << cache.misses << " computed, "
+                 << cache.hits << " reused\n";
+        } else {
+            vector<ResultItem> items;
+            items.push_back(ResultItem::count("computed", cache.misses));
+            items.push_back(ResultItem::count("reused", cache.hits));
+            printer.write("summaries", 0, items);
         }
-
-    private:
-        Interval(const int inf, const int sup, const bool nInfi, const bool pInfi):
-            nInfinity(nInfi), pInfinity(pInfi), infimum(inf), supremum(sup) {}
-        bool nInfinity = false;
-        bool pInfinity = false;
-        bool empty = false;
-        int infimum = 0;
-        int supremum = 0;
-        int min(int a, int b, int c, int d) {
-            int array[4] = {a, b, c, d};
-            sort(array, array + 4);
-            return array[0];
-        }
-
-        int max(int a, int b, int c, int d) {
-            int array[4] = {a, b, c, d};
-            sort(array, array + 4);
-            return array[3];
+    }
+    if (resultCache.enabled()) {
+        if (printer.text()) {
+            cout << "Result cache: " << resultCache.hits << " hits, "
+                 << resultCache.misses << " misses\n";
+        } else {
+            vector<ResultItem> items;
+            items.push_back(ResultItem::count("hits", resultCache.hits));
+            items.push_back(ResultItem::count("misses", resultCache.misses));
+            printer.write("result-cache", 0, items);
         }
-};
+    }
+    if (!invariantsPath.empty() && !writeInvariants(invariantsPath, invariantSections)) {
+        return EXIT_FAILURE;
+    }
+    if (wantStats) {
+        stats.print(printer);
+        activeStats() = nullptr;
+    }
+    return 0;
+}
 
-map<Value*, Interval> traverseCFG(
-    BasicBlock* BB,
+IntervalMap solveRecursive(
+    Function &F,
+    const ValueNumbering &numbering,
     int &blkCount,
-    map<Value*, Interval> intervalMap,
     map<Value*, pair<bool, bool>> &boolMap,
-    queue<BasicBlock*> &blockQueue,
-    set<BasicBlock*> &masterTraversedBlocks,
-    queue<BasicBlock*> &masterBlockQueue);
-map<Value*, Interval> initInterval(BasicBlock *BB);
-void printMap(const map<Value*, Interval> &intervalMap);
-map<Value*, Interval> unionTwoMaps(map<Value*, Interval> newMap, map<Value*, Interval> oldMap);
-map<Value*, Interval> widenMap(map<Value*, Interval> newMap, map<Value*, Interval> oldMap);
-map<Value*, Interval> narrowMap(map<Value*, Interval> newMap, map<Value*, Interval> oldMap);
-bool reachFixedPoint(map<Value*, Interval> map1, map<Value*, Interval> map2);
-
-int main(int argc, char **argv)
+    const ResultPrinter &printer)
 {
-    // Read the IR file.
-    LLVMContext &Context = getGlobalContext();
-    SMDiagnostic Err;
-    Module *M = ParseIRFile(argv[1], Err, Context);
-    if (M == nullptr)
-    {
-        fprintf(stderr, "error: failed to load LLVM IR file \"%s\"", argv[1]);
-        return EXIT_FAILURE;
-    }
-
-    map<Value*, Interval> oldMap;
-    map<Value*, Interval> newMap;
-    map<Value*, pair<bool, bool>> boolMap;
+    PhaseTimer timer("solve");
+    IntervalMap oldMap;
+    IntervalMap newMap;
     queue<BasicBlock*> blockQueue;
     set<BasicBlock*> masterTraversedBlocks;
 
-    int blkCount = 1;
-    for (auto &F: *M)
-        if (strncmp(F.getName().str().c_str(), "main", 4) == 0) {
-            BasicBlock* BB = dyn_cast<BasicBlock>(F.begin());
-            blockQueue.push(BB);
-            oldMap = initInterval(BB);
-            while (!blockQueue.empty()) {
-                BasicBlock *next = blockQueue.front();
-                blockQueue.pop();
-                if (masterTraversedBlocks.find(next) != masterTraversedBlocks.end()) {
-                    cout << "It is a loop." << endl;
-                } else {
-                    masterTraversedBlocks.insert(next);
-                }
-                newMap = traverseCFG(next, blkCount, oldMap, boolMap, blockQueue, masterTraversedBlocks, blockQueue);
-                if (blkCount >= 200) {
-                    newMap = widenMap(newMap, oldMap);
-                }
-                oldMap = newMap;
-            }
-            cout << "=========== Final Result ===========" << endl;
-            printMap(newMap);
+    vector<int64_t> thresholds = wideningThresholds(F);
+    map<BasicBlock*, int> headVisits;
+
+    BasicBlock* BB = dyn_cast<BasicBlock>(F.begin());
+    blockQueue.push(BB);
+    oldMap = initInterval(BB, numbering);
+    while (!blockQueue.empty()) {
+        BasicBlock *next = blockQueue.front();
+        blockQueue.pop();
+        bool widen = false;
+        if (masterTraversedBlocks.find(next) != masterTraversedBlocks.end()) {
+            TRACE(TRACE_BLOCK, if (printer.text()) cout << "It is a loop.\n");
+            if (AnalysisStats *stats = activeStats()) {
+                stats->countHeadVisit(next);
+            }
+            widen = ++headVisits[next] >= WIDEN_DELAY;
+        } else {
+            masterTraversedBlocks.insert(next);
         }
-    return 0;
+        newMap = traverseCFG(next, blkCount, oldMap, boolMap, blockQueue, masterTraversedBlocks, blockQueue, printer);
+        if (widen) {
+            bool useThresholds = headVisits[next] < WIDEN_DELAY + THRESHOLD_WIDENINGS;
+            newMap = widenMap(newMap, oldMap, useThresholds ? thresholds : vector<int64_t>());
+        }
+        oldMap = newMap;
+    }
+    return newMap;
 }
 
-map<Value*, Interval> initInterval(BasicBlock *BB)
+IntervalMap initInterval(BasicBlock *BB, const ValueNumbering &numbering)
 {
-    map<Value*, Interval> intervalMap;
+    IntervalMap intervalMap(&numbering);
 
     for (auto &I: *BB) {
         if (isa<AllocaInst>(I)) {
             Value *allocVal = dyn_cast<Value>(&I);
-            Interval newInterval;
-            pair<Value*, Interval> pair = make_pair(allocVal, newInterval);
+            Interval64 newInterval;
+            pair<Value*, Interval64> pair = make_pair(allocVal, newInterval);
             intervalMap.insert(pair);
         }
     }
+
+    Function *F = BB->getParent();
+    for (auto arg = F->arg_begin(); arg != F->arg_end(); ++arg) {
+        intervalMap.insert(make_pair(dyn_cast<Value>(&*arg), Interval64()));
+    }
+    for (auto GV: trackedGlobals(*F->getParent())) {
+        Interval64 initVal = Interval64::constant(dyn_cast<ConstantInt>(GV->getInitializer())->getSExtValue());
+        intervalMap.insert(make_pair(dyn_cast<Value>(GV), initVal));
+    }
     return intervalMap;
 }
 
-map<Value*, Interval>
+IntervalMap
 backwardUpdate(
     BasicBlock *BB,
-    map<Value*, Interval> intervalMap,
+    IntervalMap intervalMap,
     map<Value*, pair<bool, bool>> &boolMap)
 {
+    PhaseTimer timer("backwardUpdate");
     bool updated = false;
-    Value *cond;
+    Value *cond = nullptr;
 
     for (auto iter = (*BB).rbegin(); iter != (*BB).rend(); ++iter) {
         Instruction *I = &(*iter);
@@ -545,8 +668,9 @@ backwardUpdate(
             Value *op2 = I->getOperand(1);
             auto iter1 = intervalMap.find(op1);
             auto iter2 = intervalMap.find(op2);
-            Interval lhs;
-            Interval rhs;
+            Interval64 lhs;
+            Interval64 rhs;
+            unsigned bits = valueBits(op1);
 
             auto boolIter = boolMap.find(cond);
             pair<bool, bool> brCond = boolIter->second;
@@ -558,30 +682,28 @@ backwardUpdate(
 
             if (iter1 != intervalMap.end() && iter2 == intervalMap.end()) {
                 lhs = iter1->second;
-                int newVal = dyn_cast<ConstantInt>(op2)->getSExtValue();
-                rhs = Interval(newVal, newVal);
+                rhs = Interval64::constant(dyn_cast<ConstantInt>(op2)->getSExtValue());
             }
 
             if (iter1 == intervalMap.end() && iter2 != intervalMap.end()) {
-                int newVal = dyn_cast<ConstantInt>(op1)->getSExtValue();
-                lhs = Interval(newVal, newVal);
+                lhs = Interval64::constant(dyn_cast<ConstantInt>(op1)->getSExtValue());
                 rhs = iter2->second;
             }
 
-            Interval originalInterval = intervalMap.find(dyn_cast<Value>(I))->second;
+            Interval64 originalInterval = intervalMap.find(dyn_cast<Value>(I))->second;
 
             switch(dyn_cast<CmpInst>(I)->getPredicate()) {
                 case CmpInst::Predicate::ICMP_SGT:
                     if (brCond.first) {
-                        originalInterval.intersectionWith(Interval(1, true));
+                        originalInterval.intersectionWith(Interval64((int64_t) 1, true));
                         if (iter1 != intervalMap.end()) {
-                            Interval newInterval = originalInterval + rhs;
+                            Interval64 newInterval = arithmetic(Instruction::Add, bits, originalInterval, rhs);
                             newInterval.intersectionWith(lhs);
                             iter1->second = newInterval;
                         }
 
                         if (iter2 != intervalMap.end()) {
-                            Interval newInterval = lhs - originalInterval;
+                            Interval64 newInterval = arithmetic(Instruction::Sub, bits, lhs, originalInterval);
                             newInterval.intersectionWith(rhs);
                             iter2->second = newInterval;
                         }
@@ -589,15 +711,15 @@ backwardUpdate(
                         break;
                     }
                     if (brCond.second) {
-                        originalInterval.intersectionWith(Interval(true, 0));
+                        originalInterval.intersectionWith(Interval64(true, (int64_t) 0));
                         if (iter1 != intervalMap.end()) {
-                            Interval newInterval = originalInterval + rhs;
+                            Interval64 newInterval = arithmetic(Instruction::Add, bits, originalInterval, rhs);
                             newInterval.intersectionWith(lhs);
                             iter1->second = newInterval;
                         }
 
                         if (iter2 != intervalMap.end()) {
-                            Interval newInterval = lhs - originalInterval;
+                            Interval64 newInterval = arithmetic(Instruction::Sub, bits, lhs, originalInterval);
                             newInterval.intersectionWith(rhs);
                             iter2->second = newInterval;
                         }
@@ -606,15 +728,15 @@ backwardUpdate(
                     break;
                 case CmpInst::Predicate::ICMP_SGE:
                     if (brCond.first) {
-                        originalInterval.intersectionWith(Interval(0, true));
+                        originalInterval.intersectionWith(Interval64((int64_t) 0, true));
                         if (iter1 != intervalMap.end()) {
-                            Interval newInterval = originalInterval + rhs;
+                            Interval64 newInterval = arithmetic(Instruction::Add, bits, originalInterval, rhs);
                             newInterval.intersectionWith(lhs);
                             iter1->second = newInterval;
                         }
 
                         if (iter2 != intervalMap.end()) {
-                            Interval newInterval = lhs - originalInterval;
+                            Interval64 newInterval = arithmetic(Instruction::Sub, bits, lhs, originalInterval);
                             newInterval.intersectionWith(rhs);
                             iter2->second = newInterval;
                         }
@@ -622,15 +744,15 @@ backwardUpdate(
                         break;
                     }
                     if (brCond.second) {
-                        originalInterval.intersectionWith(Interval(true, -1));
+                        originalInterval.intersectionWith(Interval64(true, (int64_t) -1));
                         if (iter1 != intervalMap.end()) {
-                            Interval newInterval = originalInterval + rhs;
+                            Interval64 newInterval = arithmetic(Instruction::Add, bits, originalInterval, rhs);
                             newInterval.intersectionWith(lhs);
                             iter1->second = newInterval;
                         }
 
                         if (iter2 != intervalMap.end()) {
-                            Interval newInterval = lhs - originalInterval;
+                            Interval64 newInterval = arithmetic(Instruction::Sub, bits, lhs, originalInterval);
                             newInterval.intersectionWith(rhs);
                             iter2->second = newInterval;
                         }
@@ -639,15 +761,15 @@ backwardUpdate(
                     break;
                 case CmpInst::Predicate::ICMP_SLT:
                     if (brCond.first) {
-                        originalInterval.intersectionWith(Interval(true, -1));
+                        originalInterval.intersectionWith(Interval64(true, (int64_t) -1));
                         if (iter1 != intervalMap.end()) {
-                            Interval newInterval = originalInterval + rhs;
+                            Interval64 newInterval = arithmetic(Instruction::Add, bits, originalInterval, rhs);
                             newInterval.intersectionWith(lhs);
                             iter1->second = newInterval;
                         }
 
                         if (iter2 != intervalMap.end()) {
-                            Interval newInterval = lhs - originalInterval;
+                            Interval64 newInterval = arithmetic(Instruction::Sub, bits, lhs, originalInterval);
                             newInterval.intersectionWith(rhs);
                             iter2->second = newInterval;
                         }
@@ -655,15 +777,15 @@ backwardUpdate(
                         break;
                     }
                     if (brCond.second) {
-                        originalInterval.intersectionWith(Interval(0, true));
+                        originalInterval.intersectionWith(Interval64((int64_t) 0, true));
                         if (iter1 != intervalMap.end()) {
-                            Interval newInterval = originalInterval + rhs;
+                            Interval64 newInterval = arithmetic(Instruction::Add, bits, originalInterval, rhs);
                             newInterval.intersectionWith(lhs);
                             iter1->second = newInterval;
                         }
 
                         if (iter2 != intervalMap.end()) {
-                            Interval newInterval = lhs - originalInterval;
+                            Interval64 newInterval = arithmetic(Instruction::Sub, bits, lhs, originalInterval);
                             newInterval.intersectionWith(rhs);
                             iter2->second = newInterval;
                         }
@@ -672,15 +794,15 @@ backwardUpdate(
                     break;
                 case CmpInst::Predicate::ICMP_SLE:
                     if (brCond.first) {
-                        originalInterval.intersectionWith(Interval(true, 0));
+                        originalInterval.intersectionWith(Interval64(true, (int64_t) 0));
                         if (iter1 != intervalMap.end()) {
-                            Interval newInterval = originalInterval + rhs;
+                            Interval64 newInterval = arithmetic(Instruction::Add, bits, originalInterval, rhs);
                             newInterval.intersectionWith(lhs);
                             iter1->second = newInterval;
                         }
 
                         if (iter2 != intervalMap.end()) {
-                            Interval newInterval = lhs - originalInterval;
+                            Interval64 newInterval = arithmetic(Instruction::Sub, bits, lhs, originalInterval);
                             newInterval.intersectionWith(rhs);
                             iter2->second = newInterval;
                         }
@@ -688,15 +810,15 @@ backwardUpdate(
                         break;
                     }
                     if (brCond.second) {
-                        originalInterval.intersectionWith(Interval(1, true));
+                        originalInterval.intersectionWith(Interval64((int64_t) 1, true));
                         if (iter1 != intervalMap.end()) {
-                            Interval newInterval = originalInterval + rhs;
+                            Interval64 newInterval = arithmetic(Instruction::Add, bits, originalInterval, rhs);
                             newInterval.intersectionWith(lhs);
                             iter1->second = newInterval;
                         }
 
                         if (iter2 != intervalMap.end()) {
-                            Interval newInterval = lhs - originalInterval;
+                            Interval64 newInterval = arithmetic(Instruction::Sub, bits, lhs, originalInterval);
                             newInterval.intersectionWith(rhs);
                             iter2->second = newInterval;
                         }
@@ -716,8 +838,7 @@ backwardUpdate(
                 //     }
                 //     break;
                 default:
-                    cerr << "Undefined Comparison" << endl;
-                    exit(EXIT_FAILURE);
+                    throw AnalysisError("undefined comparison");
             }
 
             updated = true;
@@ -737,8 +858,8 @@ backwardUpdate(
             Value *op2 = I->getOperand(1);
             auto iter1 = intervalMap.find(op1);
             auto iter2 = intervalMap.find(op2);
-            Interval lhs;
-            Interval rhs;
+            Interval64 lhs;
+            Interval64 rhs;
 
             if (iter1 != intervalMap.end() && iter2 != intervalMap.end()) {
                 lhs = iter1->second;
@@ -747,35 +868,34 @@ backwardUpdate(
 
             if (iter1 != intervalMap.end() && iter2 == intervalMap.end()) {
                 lhs = iter1->second;
-                int newVal = dyn_cast<ConstantInt>(op2)->getSExtValue();
-                rhs = Interval(newVal, newVal);
+                rhs = Interval64::constant(dyn_cast<ConstantInt>(op2)->getSExtValue());
             }
 
             if (iter1 == intervalMap.end() && iter2 != intervalMap.end()) {
-                int newVal = dyn_cast<ConstantInt>(op1)->getSExtValue();
-                lhs = Interval(newVal, newVal);
+                lhs = Interval64::constant(dyn_cast<ConstantInt>(op1)->getSExtValue());
                 rhs = iter2->second;
             }
 
-            Interval newInterval = intervalMap.find(dyn_cast<Value>(I))->second;
+            Interval64 newInterval = intervalMap.find(dyn_cast<Value>(I))->second;
+            unsigned bits = valueBits(I);
             switch(I->getOpcode()) {
                 case Instruction::Add:
                     if (iter1 != intervalMap.end()) {
-                        lhs.intersectionWith(newInterval - rhs);
+                        lhs.intersectionWith(arithmetic(Instruction::Sub, bits, newInterval, rhs));
                         iter1->second = lhs;
                     }
                     if (iter2 != intervalMap.end()) {
-                        rhs.intersectionWith(newInterval - lhs);
+                        rhs.intersectionWith(arithmetic(Instruction::Sub, bits, newInterval, lhs));
                         iter2->second = rhs;
                     }
                     break;
                 case Instruction::Sub:
                     if (iter1 != intervalMap.end()) {
-                        lhs.intersectionWith(newInterval + rhs);
+                        lhs.intersectionWith(arithmetic(Instruction::Add, bits, newInterval, rhs));
                         iter1->second = lhs;
                     }
                     if (iter2 != intervalMap.end()) {
-                        rhs.intersectionWith(lhs - newInterval);
+                        rhs.intersectionWith(arithmetic(Instruction::Sub, bits, lhs, newInterval));
                         iter2->second = rhs;
                     }
                     break;
@@ -783,8 +903,7 @@ backwardUpdate(
                 //     newInterval = lhs * rhs;
                 //     break;
                 default:
-                    cerr << "Undefined Operation" << endl;
-                    exit(EXIT_FAILURE);
+                    throw AnalysisError(string("undefined operation \"") + I->getOpcodeName() + "\"");
             }
             updated = true;
         }
@@ -798,37 +917,135 @@ backwardUpdate(
     return intervalMap;
 }
 
-void transfer(
-    Instruction &I,
-    map<Value*, Interval> &intervalMap,
-    map<Value*, pair<bool, bool>> &boolMap)
+// The width V's arithmetic runs at: that of its integer type, else 64.
+unsigned valueBits(Value *V)
 {
-    if (isa<ICmpInst>(&I)) {
-        Value *op1 = I.getOperand(0);
+    IntegerType *type = dyn_cast<IntegerType>(V->getType());
+    return type != nullptr ? type->getBitWidth() : 64;
+}
+
+template <typename T>
+Interval64 arithmeticAt(unsigned opcode, const Interval64 &lhs, const Interval64 &rhs)
+{
+    BasicInterval<T> a = convertInterval<T>(lhs);
+    BasicInterval<T> b = convertInterval<T>(rhs);
+    switch (opcode) {
+        case Instruction::Add:
+            return convertInterval<int64_t>(a + b);
+        case Instruction::Sub:
+            return convertInterval<int64_t>(a - b);
+        default:
+            return convertInterval<int64_t>(a * b);
+    }
+}
+
+// lhs op rhs for Add, Sub or Mul on bits-wide values, in the narrowest
+// interval that holds them, so a bound becomes infinite where the IR's
+// value would wrap: past 127 for an i8, past INT64_MAX for an i64.
+Interval64 arithmetic(unsigned opcode, unsigned bits, const Interval64 &lhs, const Interval64 &rhs)
+{
+    if (bits <= 8) {
+        return arithmeticAt<int8_t>(opcode, lhs, rhs);
+    }
+    if (bits <= 16) {
+        return arithmeticAt<int16_t>(opcode, lhs, rhs);
+    }
+    if (bits <= 32) {
+        return arithmeticAt<int32_t>(opcode, lhs, rhs);
+    }
+    return arithmeticAt<int64_t>(opcode, lhs, rhs);
+}
+
+void transfer(
+    Instruction &I,
+    IntervalMap &intervalMap,
+    map<Value*, pair<bool, bool>> &boolMap,
+    SummaryCache *summaries)
+{
+    PhaseTimer timer("transfer");
+    // Operands are read through current, so reading them does not unshare
+    // their part of the state; only the slots written are copied.
+    const IntervalMap &current = intervalMap;
+    if (AnalysisStats *stats = activeStats()) {
+        stats->countOpcode(I.getOpcodeName());
+    }
+    if (isa<CallInst>(&I)) {
+        CallInst *call = dyn_cast<CallInst>(&I);
+        Function *callee = call->getCalledFunction();
+        Interval64 result;
+
+        if (summaries != nullptr && callee != nullptr && !callee->isDeclaration()) {
+            vector<Interval64> input;
+            // Operand bundles and the callee follow the arguments.
+#if LLVM_VERSION_MAJOR >= 8
+            unsigned numArgs = call->arg_size();
+#else
+            unsigned numArgs = call->getNumArgOperands();
+#endif
+            for (unsigned x = 0; x < numArgs; ++x) {
+                Value *arg = call->getArgOperand(x);
+                auto iter = current.find(arg);
+                ConstantInt *constInt = dyn_cast<ConstantInt>(arg);
+                if (iter != current.end()) {
+                    input.push_back(iter->second);
+                } else if (constInt != nullptr) {
+                    input.push_back(Interval64::constant(constInt->getSExtValue()));
+                } else {
+                    input.push_back(Interval64());
+                }
+            }
+            for (auto GV: summaries->globals) {
+                input.push_back(current.find(GV)->second);
+            }
+
+            FunctionSummary summary = summaries->lookup(callee, input);
+            result = summary.returnInterval;
+            for (unsigned g = 0; g < summaries->globals.size(); ++g) {
+                intervalMap.find(summaries->globals[g])->second = summary.globalsOut[g];
+            }
+        } else {
+            // Unknown callees may write any global.
+            for (auto iter = current.begin(); iter != current.end(); ++iter) {
+                if (isa<GlobalVariable>(iter->first)) {
+                    intervalMap.find(iter->first)->second = Interval64();
+                }
+            }
+        }
+
+        if (!call->getType()->isVoidTy()) {
+            auto found = intervalMap.find(dyn_cast<Value>(&I));
+            if (found == intervalMap.end()) {
+                intervalMap.insert(make_pair(dyn_cast<Value>(&I), result));
+            } else {
+                found->second = result;
+            }
+        }
+    }
+
+    if (isa<ICmpInst>(&I)) {
+        Value *op1 = I.getOperand(0);
         Value *op2 = I.getOperand(1);
-        auto iter1 = intervalMap.find(op1);
-        auto iter2 = intervalMap.find(op2);
-        Interval lhs;
-        Interval rhs;
+        auto iter1 = current.find(op1);
+        auto iter2 = current.find(op2);
+        Interval64 lhs;
+        Interval64 rhs;
 
-        if (iter1 != intervalMap.end() && iter2 != intervalMap.end()) {
+        if (iter1 != current.end() && iter2 != current.end()) {
             lhs = iter1->second;
             rhs = iter2->second;
         }
 
-        if (iter1 != intervalMap.end() && iter2 == intervalMap.end()) {
+        if (iter1 != current.end() && iter2 == current.end()) {
             lhs = iter1->second;
-            int newVal = dyn_cast<ConstantInt>(op2)->getSExtValue();
-            rhs = Interval(newVal, newVal);
+            rhs = Interval64::constant(dyn_cast<ConstantInt>(op2)->getSExtValue());
         }
 
-        if (iter1 == intervalMap.end() && iter2 != intervalMap.end()) {
-            int newVal = dyn_cast<ConstantInt>(op1)->getSExtValue();
-            lhs = Interval(newVal, newVal);
+        if (iter1 == current.end() && iter2 != current.end()) {
+            lhs = Interval64::constant(dyn_cast<ConstantInt>(op1)->getSExtValue());
             rhs = iter2->second;
         }
 
-        Interval operand = lhs - rhs;
+        Interval64 operand = arithmetic(Instruction::Sub, valueBits(op1), lhs, rhs);
         auto existing = intervalMap.find(dyn_cast<Value>(&I));
         if (existing == intervalMap.end()) {
             intervalMap.insert(make_pair(dyn_cast<Value>(&I), operand));
@@ -888,8 +1105,7 @@ void transfer(
                 }
                 break;
             default:
-                cerr << "Undefined Comparison" << endl;
-                exit(EXIT_FAILURE);
+                throw AnalysisError("undefined comparison");
         }
         auto found = boolMap.find(dyn_cast<Value>(&I));
         pair<bool, bool> pair = make_pair(br1, br2);
@@ -903,9 +1119,9 @@ void transfer(
     if (isa<LoadInst>(&I)) {
         Value *inst = dyn_cast<Value>(&I);
         Value *op = I.getOperand(0);
-        auto iter = intervalMap.find(op);
+        auto iter = current.find(op);
         auto found = intervalMap.find(inst);
-        pair<Value*, Interval> newPair = make_pair(inst, iter->second);
+        pair<Value*, Interval64> newPair = make_pair(inst, iter->second);
         if (found == intervalMap.end()) {
             intervalMap.insert(newPair);
         } else {
@@ -920,56 +1136,48 @@ void transfer(
         ConstantInt *constInt = dyn_cast<ConstantInt>(from);
 
         if (constInt == nullptr) {
-            auto jter = intervalMap.find(from);
+            auto jter = current.find(from);
             iter->second = jter->second;
         }
 
         if (constInt != nullptr) {
-            int newConst = constInt->getSExtValue();
-            iter->second = Interval(newConst, newConst);
+            iter->second = Interval64::constant(constInt->getSExtValue());
         }
     }
 
     if (I.isBinaryOp()) {
         Value *op1 = I.getOperand(0);
         Value *op2 = I.getOperand(1);
-        auto iter1 = intervalMap.find(op1);
-        auto iter2 = intervalMap.find(op2);
-        Interval lhs;
-        Interval rhs;
+        auto iter1 = current.find(op1);
+        auto iter2 = current.find(op2);
+        Interval64 lhs;
+        Interval64 rhs;
 
-        if (iter1 != intervalMap.end() && iter2 != intervalMap.end()) {
+        if (iter1 != current.end() && iter2 != current.end()) {
             lhs = iter1->second;
             rhs = iter2->second;
         }
 
-        if (iter1 != intervalMap.end() && iter2 == intervalMap.end()) {
+        if (iter1 != current.end() && iter2 == current.end()) {
             lhs = iter1->second;
-            int newVal = dyn_cast<ConstantInt>(op2)->getSExtValue();
-            rhs = Interval(newVal, newVal);
+            rhs = Interval64::constant(dyn_cast<ConstantInt>(op2)->getSExtValue());
         }
 
-        if (iter1 == intervalMap.end() && iter2 != intervalMap.end()) {
-            int newVal = dyn_cast<ConstantInt>(op1)->getSExtValue();
-            lhs = Interval(newVal, newVal);
+        if (iter1 == current.end() && iter2 != current.end()) {
+            lhs = Interval64::constant(dyn_cast<ConstantInt>(op1)->getSExtValue());
             rhs = iter2->second;
         }
 
-        Interval newInterval;
+        Interval64 newInterval;
 
         switch(I.getOpcode()) {
             case Instruction::Add:
-                newInterval = lhs + rhs;
-                break;
             case Instruction::Sub:
-                newInterval = lhs - rhs;
-                break;
             case Instruction::Mul:
-                newInterval = lhs * rhs;
+                newInterval = arithmetic(I.getOpcode(), valueBits(&I), lhs, rhs);
                 break;
             default:
-                cerr << "Undefined Operation" << endl;
-                exit(EXIT_FAILURE);
+                throw AnalysisError(string("undefined operation \"") + I.getOpcodeName() + "\"");
         }
         auto found = intervalMap.find(dyn_cast<Value>(&I));
         if (found == intervalMap.end()) {
@@ -980,30 +1188,29 @@ void transfer(
     }
 }
 
-map<Value*, Interval> traverseCFG(
+IntervalMap traverseCFG(
     BasicBlock* BB,
     int &blkCount,
-    map<Value*, Interval> intervalMap,
+    IntervalMap intervalMap,
     map<Value*, pair<bool, bool>> &boolMap,
     queue<BasicBlock*> &blockQueue,
     set<BasicBlock*> &masterTraversedBlocks,
-    queue<BasicBlock*> &masterBlockQueue)
+    queue<BasicBlock*> &masterBlockQueue,
+    const ResultPrinter &printer)
 {
-    map<Value*, Interval> oldMap = intervalMap;
+    IntervalMap oldMap = intervalMap;
     for (auto &I: *BB) {
-        transfer(I, intervalMap, boolMap);
+        transfer(I, intervalMap, boolMap, nullptr);
+        TRACE(TRACE_INSTRUCTION, traceInstruction(printer, blkCount, I, intervalMap));
     }
 
-    cout << "Block " << blkCount << endl;
-    cout << "=========== Old Interval Map ===========" << endl;
-    printMap(oldMap);
     intervalMap = unionTwoMaps(intervalMap, oldMap);
-    cout << "=========== New Interval Map ===========" << endl;
-    printMap(intervalMap);
+    TRACE(TRACE_BLOCK, printBlock(printer, blkCount, oldMap, intervalMap));
 
     ++blkCount;
+    countStat("block visits");
 
-    const TerminatorInst *TInst = BB->getTerminator();
+    const Terminator *TInst = BB->getTerminator();
     // unsigned int NSucc = TInst->getNumSuccessors();
     if (isa<BranchInst>(TInst)) {
         const BranchInst *BInst = dyn_cast<BranchInst>(TInst);
@@ -1020,13 +1227,13 @@ map<Value*, Interval> traverseCFG(
                 falseBrQueue.push(TInst->getSuccessor(1));
             }
 
-            map<Value*, Interval> newIntervalMap1 = backwardUpdate(BB, intervalMap, boolMap);
-            map<Value*, Interval> newIntervalMap2 = backwardUpdate(BB, intervalMap, boolMap);
+            IntervalMap newIntervalMap1 = backwardUpdate(BB, intervalMap, boolMap);
+            IntervalMap newIntervalMap2 = backwardUpdate(BB, intervalMap, boolMap);
 
             while (!trueBrQueue.empty()) {
                 BasicBlock *next = trueBrQueue.front();
                 trueBrQueue.pop();
-                newIntervalMap1 = unionTwoMaps(traverseCFG(next, blkCount, newIntervalMap1, boolMap, trueBrQueue, masterTraversedBlocks, masterBlockQueue), newIntervalMap1);
+                newIntervalMap1 = unionTwoMaps(traverseCFG(next, blkCount, newIntervalMap1, boolMap, trueBrQueue, masterTraversedBlocks, masterBlockQueue, printer), newIntervalMap1);
             }
 
             if (masterTraversedBlocks.find(BB) != masterTraversedBlocks.end() && reachFixedPoint(newIntervalMap1, oldMap)) {
@@ -1041,7 +1248,7 @@ map<Value*, Interval> traverseCFG(
             while (!falseBrQueue.empty()) {
                 BasicBlock *next = falseBrQueue.front();
                 falseBrQueue.pop();
-                newIntervalMap2 = unionTwoMaps(traverseCFG(next, blkCount, newIntervalMap2, boolMap, falseBrQueue, masterTraversedBlocks, masterBlockQueue), newIntervalMap2);
+                newIntervalMap2 = unionTwoMaps(traverseCFG(next, blkCount, newIntervalMap2, boolMap, falseBrQueue, masterTraversedBlocks, masterBlockQueue, printer), newIntervalMap2);
             }
             intervalMap = unionTwoMaps(newIntervalMap2, intervalMap);
             intervalMap = unionTwoMaps(newIntervalMap1, intervalMap);
@@ -1056,7 +1263,7 @@ map<Value*, Interval> traverseCFG(
     return intervalMap;
 }
 
-void printMap(const map<Value*, Interval> &intervalMap)
+void printMap(const IntervalMap &intervalMap)
 {
     for (auto iter = intervalMap.begin(); iter != intervalMap.end(); ++iter) {
         Value* var = iter->first;
@@ -1067,53 +1274,987 @@ void printMap(const map<Value*, Interval> &intervalMap)
     }
 }
 
-map<Value*, Interval> unionTwoMaps(map<Value*, Interval> newMap, map<Value*, Interval> oldMap) {
+ResultItem intervalItem(Value *var, const Interval64 &interval)
+{
+    if (interval.isEmpty()) {
+        ResultItem item;
+        item.id = resultId(var);
+        item.kind = ResultItem::Empty;
+        return item;
+    }
+    return ResultItem::bounds(resultId(var),
+                              interval.lowerInfinite(), interval.lower(),
+                              interval.upperInfinite(), interval.upper());
+}
 
-        for (auto oldIter = oldMap.begin(); oldIter != oldMap.end(); ++oldIter) {
-            auto newIter = newMap.find(oldIter->first);
-            if (newIter == newMap.end()) {
-                newMap.insert(make_pair(oldIter->first, oldIter->second));
-            } else {
-                if (!oldIter->second.justInitialized()) {
-                    newIter->second.unionWith(oldIter->second);
+// The named values of a map as record items.
+vector<ResultItem> mapItems(const IntervalMap &intervalMap)
+{
+    vector<ResultItem> items;
+    for (auto iter = intervalMap.begin(); iter != intervalMap.end(); ++iter) {
+        Value* var = iter->first;
+        if (var->hasName()) {
+            items.push_back(intervalItem(var, iter->second));
+        }
+    }
+    return items;
+}
+
+// The interval of a named instruction right after its transfer, tagged with
+// the visit it belongs to.
+void traceInstruction(const ResultPrinter &printer, int block, Instruction &I, const IntervalMap &intervalMap)
+{
+    PhaseTimer timer("print");
+    auto iter = intervalMap.find(&I);
+    if (!I.hasName() || iter == intervalMap.end()) {
+        return;
+    }
+    if (printer.text()) {
+        cout << "Instruction " << I.getName().str() << " in block " << block << ": ";
+        iter->second.print();
+    } else {
+        printer.write("instruction", block, vector<ResultItem>(1, intervalItem(&I, iter->second)));
+    }
+}
+
+// One visit of a block: the states before and after it.
+void printBlock(const ResultPrinter &printer, int block, const IntervalMap &oldMap, const IntervalMap &newMap)
+{
+    PhaseTimer timer("print");
+    if (printer.text()) {
+        cout << "Block " << block << "\n";
+        cout << "=========== Old Interval Map ===========\n";
+        printMap(oldMap);
+        cout << "=========== New Interval Map ===========\n";
+        printMap(newMap);
+    } else {
+        printer.write("in", block, mapItems(oldMap));
+        printer.write("out", block, mapItems(newMap));
+    }
+}
+
+IntervalMap unionTwoMaps(IntervalMap newMap, IntervalMap oldMap) {
+        PhaseTimer timer("join");
+        countStat("joins");
+
+#ifdef INTERVAL_KERNELS
+        newMap.mergeLeavesWith(oldMap, joinLeaf);
+#else
+        newMap.mergeWith(oldMap, [](IntervalMap::Entry &newEntry, const IntervalMap::Entry &oldEntry) {
+            Interval64 old = oldEntry.second;
+            if (oldEntry.first == nullptr || (newEntry.first != nullptr && old.justInitialized())) {
+                return false;
+            }
+            if (newEntry.first == nullptr) {
+                newEntry = oldEntry;
+                return true;
+            }
+            Interval64 before = newEntry.second;
+            newEntry.second.unionWith(old);
+            return before != newEntry.second;
+        });
+#endif
+    return newMap;
+}
+
+#ifdef INTERVAL_KERNELS
+// The merges of unionTwoMaps, widenMap and narrowMap a leaf of slots at a
+// time through the interval kernels, taking the same slots as the scalar
+// ones. A slot without a key holds [-INFINITY, INFINITY] in its lanes, and
+// the masks keep it out.
+typedef IntervalLanes<PERSISTENT_WIDTH> LeafLanes;
+
+bool joinLeaf(IntervalMap::Entry *newEntries, const IntervalMap::Entry *oldEntries)
+{
+    LeafLanes news, olds, joined;
+    int64_t newPresent[PERSISTENT_WIDTH], oldPresent[PERSISTENT_WIDTH];
+    int64_t take[PERSISTENT_WIDTH], update[PERSISTENT_WIDTH];
+    loadEntries(newEntries, news, newPresent);
+    loadEntries(oldEntries, olds, oldPresent);
+    joinLanes(news, olds, joined);
+    compareLanes(news, joined, update);
+    for (unsigned k = 0; k < PERSISTENT_WIDTH; ++k) {
+        take[k] = oldPresent[k] & ~newPresent[k];
+        update[k] &= oldPresent[k] & newPresent[k] & ~(olds.lowInfinite[k] & olds.highInfinite[k]);
+    }
+    return storeEntries(newEntries, oldEntries, joined, take, update);
+}
+
+bool widenLeaf(IntervalMap::Entry *oldEntries, const IntervalMap::Entry *newEntries)
+{
+    LeafLanes olds, news, widened;
+    int64_t oldPresent[PERSISTENT_WIDTH], newPresent[PERSISTENT_WIDTH];
+    int64_t take[PERSISTENT_WIDTH], update[PERSISTENT_WIDTH];
+    loadEntries(oldEntries, olds, oldPresent);
+    loadEntries(newEntries, news, newPresent);
+    widenLanes(olds, news, widened);
+    compareLanes(olds, widened, update);
+    for (unsigned k = 0; k < PERSISTENT_WIDTH; ++k) {
+        take[k] = newPresent[k] & ~oldPresent[k];
+        update[k] &= newPresent[k] & oldPresent[k];
+    }
+    return storeEntries(oldEntries, newEntries, widened, take, update);
+}
+
+bool narrowLeaf(IntervalMap::Entry *oldEntries, const IntervalMap::Entry *newEntries)
+{
+    LeafLanes olds, news, narrowed;
+    int64_t oldPresent[PERSISTENT_WIDTH], newPresent[PERSISTENT_WIDTH];
+    int64_t take[PERSISTENT_WIDTH], update[PERSISTENT_WIDTH];
+    loadEntries(oldEntries, olds, oldPresent);
+    loadEntries(newEntries, news, newPresent);
+    narrowLanes(olds, news, narrowed);
+    compareLanes(olds, narrowed, update);
+    for (unsigned k = 0; k < PERSISTENT_WIDTH; ++k) {
+        take[k] = newPresent[k] & ~oldPresent[k];
+        update[k] &= newPresent[k] & oldPresent[k] & ~(olds.lowInfinite[k] & olds.highInfinite[k]);
+    }
+    return storeEntries(oldEntries, newEntries, narrowed, take, update);
+}
+#endif
+
+// The constants a loop bound is likely to stop at: those compared against,
+// and one past them for <= and >=, as in i <= N; ++i; and those stored.
+vector<int64_t> wideningThresholds(Function &F)
+{
+    set<int64_t> thresholds;
+    for (auto &BB: F) {
+        for (auto &I: BB) {
+            ICmpInst *cmp = dyn_cast<ICmpInst>(&I);
+            StoreInst *store = dyn_cast<StoreInst>(&I);
+            for (unsigned i = 0; i < I.getNumOperands() && (cmp != nullptr || store != nullptr); ++i) {
+                ConstantInt *constInt = dyn_cast<ConstantInt>(I.getOperand(i));
+                if (constInt == nullptr || constInt->getBitWidth() > 64) {
+                    continue;
+                }
+                int64_t constant = constInt->getSExtValue();
+                thresholds.insert(constant);
+                if (cmp == nullptr || cmp->isEquality() || cmp->isFalseWhenEqual()) {
+                    continue;
+                }
+                if (constant > numeric_limits<int64_t>::min()) {
+                    thresholds.insert(constant - 1);
+                }
+                if (constant < numeric_limits<int64_t>::max()) {
+                    thresholds.insert(constant + 1);
                 }
             }
         }
-    return newMap;
+    }
+    return vector<int64_t>(thresholds.begin(), thresholds.end());
 }
 
-map<Value*, Interval> widenMap(map<Value*, Interval> newMap, map<Value*, Interval> oldMap) {
+IntervalMap widenMap(IntervalMap newMap, IntervalMap oldMap, const vector<int64_t> &thresholds) {
+        PhaseTimer timer("widen");
+        countStat("widenings");
 
-        for (auto newIter = newMap.begin(); newIter != newMap.end(); ++newIter) {
-            auto oldIter = oldMap.find(newIter->first);
-            oldIter->second.widenWith(newIter->second);
+#ifdef INTERVAL_KERNELS
+        // The thresholds take a search per bound; plain widening has none.
+        if (thresholds.empty()) {
+            oldMap.mergeLeavesWith(newMap, widenLeaf);
+            return oldMap;
         }
+#endif
+        oldMap.mergeWith(newMap, [&](IntervalMap::Entry &oldEntry, const IntervalMap::Entry &newEntry) {
+            if (newEntry.first == nullptr) {
+                return false;
+            }
+            if (oldEntry.first == nullptr) {
+                // Nothing to extrapolate from yet.
+                oldEntry = newEntry;
+                return true;
+            }
+            Interval64 before = oldEntry.second;
+            oldEntry.second.widenWith(newEntry.second, thresholds);
+            return before != oldEntry.second;
+        });
     return oldMap;
 }
 
-map<Value*, Interval> narrowMap(map<Value*, Interval> newMap, map<Value*, Interval> oldMap) {
+IntervalMap narrowMap(IntervalMap newMap, IntervalMap oldMap) {
+        PhaseTimer timer("narrow");
+        countStat("narrowings");
 
-        for (auto newIter = newMap.begin(); newIter != newMap.end(); ++newIter) {
-            auto oldIter = oldMap.find(newIter->first);
-            oldIter->second.narrowWith(newIter->second);
-        }
+#ifdef INTERVAL_KERNELS
+        oldMap.mergeLeavesWith(newMap, narrowLeaf);
+#else
+        oldMap.mergeWith(newMap, [](IntervalMap::Entry &oldEntry, const IntervalMap::Entry &newEntry) {
+            if (newEntry.first == nullptr) {
+                return false;
+            }
+            if (oldEntry.first == nullptr) {
+                // Nothing to extrapolate from yet.
+                oldEntry = newEntry;
+                return true;
+            }
+            // [-INFINITY, INFINITY] is also what an unset value holds, which
+            // unionTwoMaps skips, so it is no bound to narrow from.
+            Interval64 before = oldEntry.second;
+            if (before.justInitialized()) {
+                return false;
+            }
+            oldEntry.second.narrowWith(newEntry.second);
+            return before != oldEntry.second;
+        });
+#endif
     return oldMap;
 }
 
-bool reachFixedPoint(map<Value*, Interval> map1, map<Value*, Interval> map2) {
-    if (map1.size() != map2.size()) {
+bool reachFixedPoint(IntervalMap map1, IntervalMap map2) {
+    PhaseTimer timer("fixpoint check");
+    countStat("fixpoint checks");
+    // Slots are fixed per value, so the same keys sit in the same slots.
+    return map1 == map2;
+}
+
+IntervalMap refineEdge(
+    BasicBlock *BB,
+    bool trueEdge,
+    const IntervalMap &intervalMap,
+    map<Value*, pair<bool, bool>> &boolMap)
+{
+    // backwardUpdate refines for whichever branch is still flagged feasible,
+    // so flag only the edge being followed and restore the flags afterwards.
+    const BranchInst *BInst = dyn_cast<BranchInst>(BB->getTerminator());
+    auto iter = boolMap.find(BInst->getCondition());
+    pair<bool, bool> feasible = iter->second;
+    iter->second = make_pair(trueEdge, !trueEdge);
+    IntervalMap edgeMap = backwardUpdate(BB, intervalMap, boolMap);
+    iter->second = feasible;
+    return edgeMap;
+}
+
+IntervalMap solveWorklist(
+    Function &F,
+    const ValueNumbering &numbering,
+    int &visitCount,
+    map<Value*, pair<bool, bool>> &boolMap,
+    SummaryCache *summaries,
+    const IntervalMap &entryMap,
+    int narrowingPasses,
+    const ResultPrinter &printer)
+{
+    BlockStates states;
+    states.inMaps[&F.getEntryBlock()] = entryMap;
+    return solveIncremental(F, numbering, visitCount, boolMap, summaries, states, set<BasicBlock*>(), narrowingPasses, printer);
+}
+
+// Solves the blocks outside frozen, whose states are already final. Frozen
+// blocks feeding the rest (by an edge or a branch condition) are re-run once
+// to rebuild their edge maps and branch flags, but nothing flows into them.
+// The blocks run in a weak topological order, each loop until the state at
+// its head is stable, so only heads are widened and checked for a fixpoint.
+IntervalMap solveIncremental(
+    Function &F,
+    const ValueNumbering &numbering,
+    int &visitCount,
+    map<Value*, pair<bool, bool>> &boolMap,
+    SummaryCache *summaries,
+    BlockStates &states,
+    const set<BasicBlock*> &frozen,
+    int narrowingPasses,
+    const ResultPrinter &printer)
+{
+    PhaseTimer timer("solve");
+    WeakTopologicalOrder order(F);
+    IncrementalSolve solve{numbering, visitCount, boolMap, summaries, states, frozen,
+                           ArenaSet<BasicBlock*>(), ArenaMap<BasicBlock*, int>(), wideningThresholds(F), printer,
+                           {}};
+
+    // Narrowing runs every block again, so with it all frozen blocks re-run
+    // to rebuild their branch flags.
+    ArenaMap<BasicBlock*, IntervalMap> &inMaps = states.inMaps;
+    for (auto BB: frozen) {
+        if (inMaps.find(BB) == inMaps.end()) {
+            continue;
+        }
+        if (narrowingPasses > 0) {
+            solve.feeders.insert(BB);
+        }
+        const Terminator *TInst = BB->getTerminator();
+        for (unsigned i = 0; i < TInst->getNumSuccessors(); ++i) {
+            if (frozen.find(TInst->getSuccessor(i)) == frozen.end()) {
+                solve.feeders.insert(BB);
+            }
+        }
+    }
+    for (auto &BB: F) {
+        const BranchInst *BInst = dyn_cast<BranchInst>(BB.getTerminator());
+        if (frozen.find(&BB) != frozen.end() || BInst == nullptr || !BInst->isConditional()) {
+            continue;
+        }
+        Instruction *cond = dyn_cast<Instruction>(BInst->getCondition());
+        if (cond != nullptr && frozen.find(cond->getParent()) != frozen.end() &&
+            inMaps.find(cond->getParent()) != inMaps.end()) {
+            solve.feeders.insert(cond->getParent());
+        }
+    }
+
+    for (auto &element: order.elements()) {
+        solveElement(solve, element);
+    }
+    narrowStates(solve, order, narrowingPasses);
+
+    // The result is the join of every exit block's output.
+    IntervalMap result;
+    for (auto &entry: states.outMaps) {
+        if (entry.first->getTerminator()->getNumSuccessors() == 0) {
+            result = unionTwoMaps(entry.second, result);
+        }
+    }
+    return result;
+}
+
+// Bourdoncle's recursive strategy: a component runs its head and then its
+// body until the head's input, joined with what the body sends back, stops
+// changing. After WIDEN_DELAY rounds that input is widened.
+void solveElement(IncrementalSolve &solve, const WTOElement &element)
+{
+    if (!element.component) {
+        solveBlock(solve, element.block);
+        return;
+    }
+
+    BasicBlock *head = element.block;
+    ArenaMap<BasicBlock*, IntervalMap> &inMaps = solve.states.inMaps;
+    long rounds = 0;
+    while (true) {
+        auto found = inMaps.find(head);
+        bool reached = found != inMaps.end();
+        IntervalMap before = reached ? found->second : IntervalMap();
+        solveBlock(solve, head);
+        for (auto &inner: element.body) {
+            solveElement(solve, inner);
+        }
+        ++rounds;
+
+        found = inMaps.find(head);
+        if (found == inMaps.end()) {
+            break;
+        }
+        if (!reached) {
+            continue;
+        }
+        if (AnalysisStats *stats = activeStats()) {
+            stats->countHeadVisit(head);
+        }
+        // Widened before the check: a join can drop an unset top, which
+        // widening restores.
+        if (++solve.headVisits[head] >= WIDEN_DELAY) {
+            bool useThresholds = solve.headVisits[head] < WIDEN_DELAY + THRESHOLD_WIDENINGS;
+            found->second = widenMap(found->second, before, useThresholds ? solve.thresholds : vector<int64_t>());
+            found->second.intern(solve.table);
+        }
+        if (reachFixedPoint(found->second, before)) {
+            break;
+        }
+    }
+    if (AnalysisStats *stats = activeStats()) {
+        stats->addComponentIterations(head, rounds);
+    }
+}
+
+// Runs BB on its input, if it has one yet, and joins what it sends along
+// each feasible edge into the input of the successor.
+void solveBlock(IncrementalSolve &solve, BasicBlock *BB)
+{
+    ArenaMap<BasicBlock*, IntervalMap> &inMaps = solve.states.inMaps;
+    auto input = inMaps.find(BB);
+    if (input == inMaps.end()) {
+        return;
+    }
+    if (solve.frozen.find(BB) != solve.frozen.end() && solve.feeders.erase(BB) == 0) {
+        return;
+    }
+    runBlock(solve, BB, input->second);
+
+    const Terminator *TInst = BB->getTerminator();
+    unsigned int NSucc = TInst->getNumSuccessors();
+    for (unsigned i = 0; i < NSucc; ++i) {
+        BasicBlock *Succ = TInst->getSuccessor(i);
+        IntervalMap edgeMap;
+        if (!edgeState(solve, BB, i, edgeMap) || solve.frozen.find(Succ) != solve.frozen.end()) {
+            continue;
+        }
+        auto found = inMaps.find(Succ);
+        if (found == inMaps.end()) {
+            found = inMaps.insert(make_pair(Succ, edgeMap)).first;
+        } else {
+            found->second = unionTwoMaps(edgeMap, found->second);
+        }
+        found->second.intern(solve.table);
+    }
+}
+
+// Runs BB on input into its output state.
+void runBlock(IncrementalSolve &solve, BasicBlock *BB, const IntervalMap &input)
+{
+    IntervalMap intervalMap = input;
+    for (auto &I: *BB) {
+        transfer(I, intervalMap, solve.boolMap, solve.summaries);
+        TRACE(TRACE_INSTRUCTION, traceInstruction(solve.printer, solve.visitCount + 1, I, intervalMap));
+    }
+    ++solve.visitCount;
+    countStat("block visits");
+
+    TRACE(TRACE_BLOCK, printBlock(solve.printer, solve.visitCount, input, intervalMap));
+    intervalMap.intern(solve.table);
+    solve.states.outMaps[BB] = intervalMap;
+}
+
+// The state BB's output sends along its successor edge i, refined by the
+// branch condition; false if the branch never takes that edge.
+bool edgeState(IncrementalSolve &solve, BasicBlock *BB, unsigned i, IntervalMap &edgeMap)
+{
+    const IntervalMap &intervalMap = solve.states.outMaps[BB];
+    const BranchInst *BInst = dyn_cast<BranchInst>(BB->getTerminator());
+    if (BInst == nullptr || !BInst->isConditional()) {
+        edgeMap = intervalMap;
+        return true;
+    }
+    pair<bool, bool> feasible = solve.boolMap.find(BInst->getCondition())->second;
+    bool trueEdge = (i == 0);
+    if ((trueEdge && !feasible.first) || (!trueEdge && !feasible.second)) {
         return false;
     }
+    edgeMap = refineEdge(BB, trueEdge, intervalMap, solve.boolMap);
+    return true;
+}
 
-    for (auto iter2 = map2.begin(); iter2 != map2.end(); ++iter2) {
-        auto iter1 = map1.find(iter2->first);
-        if (iter1 != map1.end()) {
-            if (iter1->second != iter2->second) {
-                return false;
+// Descending passes over the converged states, in the same order: a block's
+// input is rebuilt from what its predecessors now send, and narrowMap takes
+// from it the finite bounds where the input was widened to infinity. Only
+// blocks whose input narrowed run again, and the passes stop early once one
+// changes nothing. Frozen blocks are narrowed too: their saved states are
+// the ascending ones, so a warm start narrows to what a cold one does.
+// Without loops nothing was widened, and no pass runs.
+void narrowStates(IncrementalSolve &solve, const WeakTopologicalOrder &order, int passes)
+{
+    if (passes == 0 || !order.hasLoops()) {
+        return;
+    }
+    PhaseTimer timer("narrowing");
+    ArenaMap<BasicBlock*, IntervalMap> &inMaps = solve.states.inMaps;
+    ArenaMap<BasicBlock*, IntervalMap> &outMaps = solve.states.outMaps;
+    vector<BasicBlock*> blocks = order.blocks();
+    ArenaMap<BasicBlock*, ArenaVector<pair<BasicBlock*, unsigned>>> inEdges;
+    for (auto BB: blocks) {
+        const Terminator *TInst = BB->getTerminator();
+        for (unsigned i = 0; i < TInst->getNumSuccessors(); ++i) {
+            inEdges[TInst->getSuccessor(i)].push_back(make_pair(BB, i));
+        }
+    }
+
+    int startCount = solve.visitCount;
+    int pass = 0;
+    bool changed = true;
+    while (changed && pass < passes) {
+        ++pass;
+        countStat("narrowing passes");
+        changed = false;
+        for (auto BB: blocks) {
+            auto input = inMaps.find(BB);
+            if (input == inMaps.end()) {
+                continue;
+            }
+            IntervalMap joined;
+            bool reached = false;
+            for (auto &edge: inEdges[BB]) {
+                IntervalMap edgeMap;
+                if (outMaps.find(edge.first) == outMaps.end() || !edgeState(solve, edge.first, edge.second, edgeMap)) {
+                    continue;
+                }
+                joined = reached ? unionTwoMaps(edgeMap, joined) : edgeMap;
+                reached = true;
+            }
+            if (!reached) {
+                continue;
+            }
+            IntervalMap narrowed = narrowMap(joined, input->second);
+            if (reachFixedPoint(narrowed, input->second)) {
+                continue;
             }
+            if (solve.states.keepAscending) {
+                solve.states.ascendingIn.insert(*input);
+                solve.states.ascendingOut.insert(*outMaps.find(BB));
+            }
+            input->second = narrowed;
+            input->second.intern(solve.table);
+            changed = true;
+            runBlock(solve, BB, narrowed);
+            countStat("narrowing visits");
+        }
+    }
+
+    TRACE(TRACE_SUMMARY,
+        if (solve.printer.text()) {
+            cout << "Narrowing: " << pass << " passes, " << solve.visitCount - startCount << " block visits\n";
         } else {
+            vector<ResultItem> items;
+            items.push_back(ResultItem::count("passes", pass));
+            items.push_back(ResultItem::count("visits", solve.visitCount - startCount));
+            solve.printer.write("narrowing", 0, items);
+        });
+}
+
+vector<Interval64> SummaryCache::topInput(Function *F) const
+{
+    return vector<Interval64>(F->arg_size() + globals.size(), Interval64());
+}
+
+FunctionSummary SummaryCache::lookup(Function *F, const vector<Interval64> &input)
+{
+    map<vector<Interval64>, FunctionSummary> &summaries = cache[F];
+    auto found = summaries.find(input);
+    if (found != summaries.end()) {
+        ++hits;
+        return found->second;
+    }
+
+    // A recursive call falls back to the input-independent summary, or to
+    // no information at all while its SCC is still being summarized.
+    if (inProgress.find(F) != inProgress.end()) {
+        found = summaries.find(topInput(F));
+        if (found != summaries.end()) {
+            ++hits;
+            return found->second;
+        }
+        FunctionSummary unknown;
+        unknown.globalsOut.assign(globals.size(), Interval64());
+        return unknown;
+    }
+
+    ++misses;
+    inProgress.insert(F);
+    ValueNumbering numbering(*F);
+    map<Value*, pair<bool, bool>> boolMap;
+    int visitCount = 0;
+
+    // Summaries are computed quietly; only the entry points are traced.
+    ResultPrinter quiet("intervalLoopAnalysis");
+    int savedLevel = traceLevel();
+    traceLevel() = TRACE_OFF;
+    IntervalMap entryMap = initInterval(&F->getEntryBlock(), numbering);
+    unsigned pos = 0;
+    for (auto arg = F->arg_begin(); arg != F->arg_end(); ++arg) {
+        entryMap.find(&*arg)->second = input[pos++];
+    }
+    for (auto GV: globals) {
+        entryMap.find(GV)->second = input[pos++];
+    }
+    IntervalMap exitMap = solveWorklist(*F, numbering, visitCount, boolMap, this, entryMap, narrowingPasses, quiet);
+    traceLevel() = savedLevel;
+
+    FunctionSummary summary;
+    bool anyReturn = false;
+    for (auto &BB: *F) {
+        ReturnInst *ret = dyn_cast<ReturnInst>(BB.getTerminator());
+        if (ret == nullptr || ret->getReturnValue() == nullptr) {
+            continue;
+        }
+        Value *retVal = ret->getReturnValue();
+        Interval64 retInterval;
+        auto iter = exitMap.find(retVal);
+        ConstantInt *constInt = dyn_cast<ConstantInt>(retVal);
+        if (iter != exitMap.end()) {
+            retInterval = iter->second;
+        } else if (constInt != nullptr) {
+            retInterval = Interval64::constant(constInt->getSExtValue());
+        }
+        if (!anyReturn) {
+            summary.returnInterval = retInterval;
+            anyReturn = true;
+        } else {
+            summary.returnInterval.unionWith(retInterval);
+        }
+    }
+    for (auto GV: globals) {
+        auto iter = exitMap.find(GV);
+        summary.globalsOut.push_back(iter == exitMap.end() ? Interval64() : iter->second);
+    }
+
+    inProgress.erase(F);
+    return summaries[input] = summary;
+}
+
+// Defined functions ordered callee-first: Tarjan over the direct call graph
+// emits each SCC after every SCC it calls into.
+vector<Function*> bottomUpOrder(Module &M)
+{
+    map<Function*, vector<Function*>> callees;
+    vector<Function*> functions;
+    for (auto &F: M) {
+        if (F.isDeclaration()) {
+            continue;
+        }
+        functions.push_back(&F);
+        for (auto &BB: F) {
+            for (auto &I: BB) {
+                CallInst *call = dyn_cast<CallInst>(&I);
+                if (call == nullptr) {
+                    continue;
+                }
+                Function *callee = call->getCalledFunction();
+                if (callee != nullptr && !callee->isDeclaration()) {
+                    callees[&F].push_back(callee);
+                }
+            }
+        }
+    }
+
+    map<Function*, int> index, lowLink;
+    set<Function*> onStack;
+    vector<Function*> sccStack;
+    vector<Function*> order;
+    int nextIndex = 0;
+
+    for (auto root: functions) {
+        if (index.find(root) != index.end()) {
+            continue;
+        }
+        vector<pair<Function*, unsigned>> callStack;
+        callStack.push_back(make_pair(root, 0));
+        index[root] = lowLink[root] = nextIndex++;
+        sccStack.push_back(root);
+        onStack.insert(root);
+
+        while (!callStack.empty()) {
+            Function *F = callStack.back().first;
+            unsigned &next = callStack.back().second;
+            vector<Function*> &succs = callees[F];
+            if (next < succs.size()) {
+                Function *callee = succs[next++];
+                if (index.find(callee) == index.end()) {
+                    index[callee] = lowLink[callee] = nextIndex++;
+                    sccStack.push_back(callee);
+                    onStack.insert(callee);
+                    callStack.push_back(make_pair(callee, 0));
+                } else if (onStack.find(callee) != onStack.end()) {
+                    lowLink[F] = min(lowLink[F], index[callee]);
+                }
+                continue;
+            }
+
+            if (lowLink[F] == index[F]) {
+                Function *member;
+                do {
+                    member = sccStack.back();
+                    sccStack.pop_back();
+                    onStack.erase(member);
+                    order.push_back(member);
+                } while (member != F);
+            }
+            callStack.pop_back();
+            if (!callStack.empty()) {
+                Function *caller = callStack.back().first;
+                lowLink[caller] = min(lowLink[caller], lowLink[F]);
+            }
+        }
+    }
+    return order;
+}
+
+StableNames::StableNames(Function &F)
+{
+    unsigned argNo = 0;
+    for (auto arg = F.arg_begin(); arg != F.arg_end(); ++arg) {
+        string key = "arg:" + to_string(argNo++);
+        valueKeys[&*arg] = key;
+        values[key] = &*arg;
+    }
+    for (auto GV: trackedGlobals(*F.getParent())) {
+        string key = "@" + GV->getName().str();
+        valueKeys[GV] = key;
+        values[key] = GV;
+    }
+
+    unsigned blockNo = 0;
+    for (auto &BB: F) {
+        string key = BB.getName().str();
+        if (key.empty() || key.find_first_of(" \t\n") != string::npos) {
+            key = "#" + to_string(blockNo);
+        }
+        ++blockNo;
+        blockKeys[&BB] = key;
+
+        unsigned instNo = 0;
+        for (auto &I: BB) {
+            string instKey = key + ":" + to_string(instNo++);
+            valueKeys[&I] = instKey;
+            values[instKey] = &I;
+        }
+    }
+
+    for (auto &BB: F) {
+        predecessors[&BB];
+        const Terminator *TInst = BB.getTerminator();
+        for (unsigned i = 0; i < TInst->getNumSuccessors(); ++i) {
+            predecessors[TInst->getSuccessor(i)].push_back(blockKeys[&BB]);
+        }
+    }
+}
+
+// Fingerprint of what the analysis sees in a block: every instruction's
+// opcode, type, predicate and operands, plus the block's predecessors.
+// Operands go by stable name, so editing one block leaves the rest intact.
+string blockHash(BasicBlock &BB, const StableNames &names)
+{
+    string text;
+    raw_string_ostream os(text);
+    for (auto &pred: names.predecessorKeys(&BB)) {
+        os << "pred " << pred << "\n";
+    }
+    for (auto &I: BB) {
+        os << I.getOpcodeName() << " ";
+        I.getType()->print(os);
+        if (CmpInst *cmp = dyn_cast<CmpInst>(&I)) {
+            os << " p" << (int) cmp->getPredicate();
+        }
+        for (unsigned i = 0; i < I.getNumOperands(); ++i) {
+            Value *op = I.getOperand(i);
+            os << " ";
+            if (BasicBlock *target = dyn_cast<BasicBlock>(op)) {
+                os << "%" << names.blockKey(target);
+            } else if (names.hasValue(op)) {
+                os << names.valueKey(op);
+            } else if (ConstantInt *constInt = dyn_cast<ConstantInt>(op)) {
+                os << constInt->getSExtValue();
+            } else if (op->hasName()) {
+                os << "@" << op->getName();
+            } else {
+                op->print(os);
+            }
+        }
+        os << "\n";
+    }
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long) fnv1a(os.str()));
+    return hex;
+}
+
+// Everything outside the function body that its states depend on.
+// The tracked globals with their initial values, one per line, which
+// initInterval puts into every entry state.
+string globalInitializers(Module &M)
+{
+    string text;
+    raw_string_ostream os(text);
+    for (auto GV: trackedGlobals(M)) {
+        os << "\n@" << GV->getName() << " " << dyn_cast<ConstantInt>(GV->getInitializer())->getSExtValue();
+    }
+    return os.str();
+}
+
+string invariantContext(Module &M, Function &F, const string &options, bool interprocedural)
+{
+    string text;
+    raw_string_ostream os(text);
+    os << RESULT_VERSION << " " << options << "\n";
+    F.getFunctionType()->print(os);
+    os << globalInitializers(M);
+    if (interprocedural) {
+        for (auto &callee: M) {
+            if (&callee != &F) {
+                callee.print(os);
+            }
+        }
+    }
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long) fnv1a(os.str()));
+    return hex;
+}
+
+void writeStateMap(ostringstream &out, const char *tag, const IntervalMap &intervalMap, const StableNames &names)
+{
+    out << tag << " " << intervalMap.size() << "\n";
+    for (auto iter = intervalMap.begin(); iter != intervalMap.end(); ++iter) {
+        out << names.valueKey(iter->first) << " ";
+        iter->second.write(out);
+        out << "\n";
+    }
+}
+
+string saveInvariants(Function &F, const StableNames &names, const BlockStates &states, const string &context)
+{
+    ostringstream out;
+    out << "context " << context << "\n";
+    for (auto &BB: F) {
+        auto in = states.ascendingIn.find(&BB);
+        auto outMap = states.ascendingOut.find(&BB);
+        if (in == states.ascendingIn.end()) {
+            in = states.inMaps.find(&BB);
+            outMap = states.outMaps.find(&BB);
+        }
+        bool reached = in != states.inMaps.end() && outMap != states.outMaps.end();
+        out << "block " << names.blockKey(&BB) << " " << blockHash(BB, names) << " " << reached << "\n";
+        if (reached) {
+            writeStateMap(out, "in", in->second, names);
+            writeStateMap(out, "out", outMap->second, names);
+        }
+    }
+    return out.str();
+}
+
+bool readStateMap(istringstream &in, const char *tag, IntervalMap &intervalMap, const StableNames &names, const ValueNumbering &numbering)
+{
+    string word;
+    size_t count = 0;
+    if (!(in >> word >> count) || word != tag) {
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        string key;
+        Interval64 interval;
+        if (!(in >> key) || !interval.read(in)) {
+            return false;
+        }
+        Value *V = names.value(key);
+        if (V == nullptr || numbering.lookup(V) < 0) {
+            return false;
+        }
+        intervalMap.insert(make_pair(V, interval));
+    }
+    return true;
+}
+
+// Restores the saved states that still hold and returns their blocks: those
+// whose code and predecessors are unchanged and that no changed block can
+// reach. Anything unreadable, or saved under another context, restores
+// nothing, which amounts to solving from scratch.
+set<BasicBlock*> restoreInvariants(
+    const string &section,
+    Function &F,
+    const StableNames &names,
+    const ValueNumbering &numbering,
+    const string &context,
+    BlockStates &states)
+{
+    istringstream in(section);
+    string word, savedContext;
+    if (!(in >> word >> savedContext) || word != "context" || savedContext != context) {
+        return set<BasicBlock*>();
+    }
+
+    // Saved blocks, and where the states of each start in the section.
+    map<string, pair<string, streampos>> savedBlocks;
+    set<string> reachedBlocks;
+    string key, hash;
+    bool reached;
+    while (in >> word >> key >> hash >> reached && word == "block") {
+        savedBlocks[key] = make_pair(hash, in.tellg());
+        if (reached) {
+            reachedBlocks.insert(key);
+            string line;
+            for (int lists = 0; lists < 2; ++lists) {
+                size_t count = 0;
+                in >> word >> count;
+                getline(in, line);
+                for (size_t i = 0; i < count; ++i) {
+                    getline(in, line);
+                }
+            }
+        }
+    }
+
+    vector<BasicBlock*> stale;
+    for (auto &BB: F) {
+        auto saved = savedBlocks.find(names.blockKey(&BB));
+        if (saved == savedBlocks.end() || saved->second.first != blockHash(BB, names)) {
+            stale.push_back(&BB);
+        }
+    }
+    set<BasicBlock*> invalid(stale.begin(), stale.end());
+    while (!stale.empty()) {
+        BasicBlock *BB = stale.back();
+        stale.pop_back();
+        const Terminator *TInst = BB->getTerminator();
+        for (unsigned i = 0; i < TInst->getNumSuccessors(); ++i) {
+            if (invalid.insert(TInst->getSuccessor(i)).second) {
+                stale.push_back(TInst->getSuccessor(i));
+            }
+        }
+    }
+
+    set<BasicBlock*> frozen;
+    for (auto &BB: F) {
+        if (invalid.find(&BB) != invalid.end()) {
+            continue;
+        }
+        frozen.insert(&BB);
+        string blockKey = names.blockKey(&BB);
+        if (reachedBlocks.find(blockKey) == reachedBlocks.end()) {
+            continue;
+        }
+        in.clear();
+        in.seekg(savedBlocks[blockKey].second);
+        IntervalMap inMap(&numbering), outMap(&numbering);
+        if (!readStateMap(in, "in", inMap, names, numbering) ||
+            !readStateMap(in, "out", outMap, names, numbering)) {
+            states.inMaps.clear();
+            states.outMaps.clear();
+            return set<BasicBlock*>();
+        }
+        states.inMaps[&BB] = inMap;
+        states.outMaps[&BB] = outMap;
+    }
+    return frozen;
+}
+
+// Sections are keyed by function name; a file written by another version
+// reads as empty.
+map<string, string> readInvariants(const string &path)
+{
+    map<string, string> sections;
+    ifstream in(path.c_str());
+    string line;
+    if (!getline(in, line) || line != "intervalLoopAnalysis invariants " + to_string(RESULT_VERSION)) {
+        return sections;
+    }
+    string *section = nullptr;
+    while (getline(in, line)) {
+        if (line.compare(0, 9, "function ") == 0) {
+            section = &sections[line.substr(9)];
+        } else if (section != nullptr) {
+            *section += line + "\n";
+        }
+    }
+    return sections;
+}
+
+bool writeInvariants(const string &path, const map<string, string> &sections)
+{
+    ostringstream tmpPath;
+    tmpPath << path << ".tmp." << getpid();
+    ofstream out(tmpPath.str().c_str());
+    out << "intervalLoopAnalysis invariants " << RESULT_VERSION << "\n";
+    for (auto &section: sections) {
+        out << "function " << section.first << "\n" << section.second;
+    }
+    out.close();
+    if (!out || rename(tmpPath.str().c_str(), path.c_str()) != 0) {
+        remove(tmpPath.str().c_str());
+        cerr << "error: cannot write invariants file \"" << path << "\"" << endl;
+        return false;
+    }
+    return true;
+}
+
+bool sameStates(const BlockStates &lhs, const BlockStates &rhs)
+{
+    const ArenaMap<BasicBlock*, IntervalMap> *lhsMaps[] = {&lhs.inMaps, &lhs.outMaps};
+    const ArenaMap<BasicBlock*, IntervalMap> *rhsMaps[] = {&rhs.inMaps, &rhs.outMaps};
+    for (int i = 0; i < 2; ++i) {
+        if (lhsMaps[i]->size() != rhsMaps[i]->size()) {
             return false;
         }
+        for (auto &entry: *lhsMaps[i]) {
+            auto other = rhsMaps[i]->find(entry.first);
+            if (other == rhsMaps[i]->end() || !reachFixedPoint(entry.second, other->second)) {
+                return false;
+            }
+        }
     }
     return true;
 }
+
+}
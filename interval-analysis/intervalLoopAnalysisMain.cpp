@@ -0,0 +1,7 @@
+#include "../common/AnalysisTools.h"
+
+// The analysis itself is in intervalLoopAnalysis.cpp, part of analysiscore.
+int main(int argc, char **argv)
+{
+    return runAnalysisMain(interval::runLoopAnalysis, argc, argv);
+}
@@ -0,0 +1,629 @@
+#include <cstdio>
+#include <iostream>
+#include <set>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <vector>
+#include <string>
+#include <sstream>
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/IR/Value.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/InstrTypes.h"
+#include "llvm/IR/Type.h"
+#include "Interval.h"
+#include "../common/IRInput.h"
+#include "../common/CFG.h"
+#include "../common/ResultCache.h"
+#include "../common/OutputRedirect.h"
+#include "../common/ResultFormat.h"
+#include "../common/Stats.h"
+
+// Bump whenever the printed result for the same IR changes.
+#define RESULT_VERSION 1
+
+// Sparse range analysis over SSA form (run `opt -mem2reg` first). Every
+// integer SSA value is a variable of a constraint graph built from def-use
+// chains. Branches on an icmp add sigma variables that carry the branch
+// condition into the blocks the edge dominates. The graph is split into
+// strongly connected components and each component is solved once, in
+// topological order: widening, then futures resolution, then narrowing.
+
+using namespace llvm;
+using namespace std;
+
+// Defines one variable of the constraint graph from its operands.
+struct Constraint {
+    enum Kind { Copy, Phi, Binary, Sigma };
+    Kind kind;
+    int sink;
+    vector<int> sources;         // variable ids, -1 for a constant operand
+    vector<Interval> constants;  // value of each constant operand
+    unsigned opcode = 0;         // Binary
+    CmpInst::Predicate pred = CmpInst::Predicate::ICMP_EQ; // Sigma
+    int bound = -1;              // Sigma: variable the condition compares with
+    Interval boundConstant;      // Sigma: used when bound is -1
+};
+
+struct ConstraintGraph {
+    map<Value*, int> ids;
+    vector<Value*> values;       // null for sigma variables
+    vector<int> definedBy;       // constraint index, -1 for program inputs
+    vector<Constraint> constraints;
+    vector<vector<int>> users;   // constraints reading each variable
+};
+
+ConstraintGraph buildGraph(Function &F);
+vector<vector<int>> stronglyConnectedComponents(const ConstraintGraph &graph);
+vector<Interval> solveGraph(const ConstraintGraph &graph, int &evalCount);
+
+int main(int argc, char **argv)
+{
+    // Read the IR file, textual or bitcode; "-" reads standard input. The
+    // context is owned by this run, so runs on other threads never share one.
+    LLVMContext Context;
+    SMDiagnostic Err;
+    auto parseStart = chrono::steady_clock::now();
+    Module *M = loadModule(argv[1], Err, Context);
+    auto parseTime = chrono::steady_clock::now() - parseStart;
+    if (M == nullptr)
+    {
+        fprintf(stderr, "error: failed to load LLVM IR file \"%s\"", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    // --cache-dir DIR reuses results of unchanged functions from earlier runs.
+    // --stats reports phase times and counters after the results (see
+    // common/Stats.h), as the loop analyses do.
+    ResultCache resultCache("intervalSSAAnalysis", RESULT_VERSION);
+    bool wantStats = false;
+    for (int i = 2; i < argc; ++i) {
+        if (strcmp(argv[i], "--cache-dir") == 0 && i + 1 < argc) {
+            if (!resultCache.open(argv[++i])) {
+                fprintf(stderr, "error: cannot create cache directory \"%s\"\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            wantStats = true;
+        } else {
+            fprintf(stderr, "error: unknown option \"%s\"\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // The report comes after all functions, so it never enters the cache.
+    AnalysisStats stats;
+    activeStats() = wantStats ? &stats : nullptr;
+    if (wantStats) {
+        stats.addTime("parse", parseTime);
+    }
+
+    for (auto &F: *M)
+        if (strncmp(F.getName().str().c_str(), "main", 4) == 0) {
+            {
+                PhaseTimer timer("parse");
+                if (!materialize(F)) {
+                    return EXIT_FAILURE;
+                }
+            }
+            string key;
+            if (resultCache.enabled()) {
+                key = resultCache.key(F, "");
+                string carriedOut, cached;
+                if (resultCache.lookup(key, carriedOut, cached)) {
+                    cout << cached;
+                    continue;
+                }
+            }
+            ostringstream captured;
+            streambuf *uncaptured = nullptr;
+            if (resultCache.enabled()) {
+                uncaptured = redirectOutput(captured.rdbuf());
+            }
+
+            ConstraintGraph graph;
+            {
+                PhaseTimer timer("constraint graph");
+                graph = buildGraph(F);
+            }
+            countStat("constraints", graph.constraints.size());
+            int evalCount = 0;
+            vector<Interval> ranges;
+            {
+                PhaseTimer timer("solve");
+                ranges = solveGraph(graph, evalCount);
+            }
+            if (wantStats) {
+                stats.addIterations(F.getName().str(), evalCount);
+            }
+
+            {
+                PhaseTimer timer("print");
+                cout << "=========== Final Result ===========" << endl;
+                for (unsigned i = 0; i < graph.values.size(); ++i) {
+                    Value *var = graph.values[i];
+                    if (var != nullptr && var->hasName()) {
+                        cout << var->getName().str().c_str() << ": ";
+                        ranges[i].print();
+                    }
+                }
+                cout << "Constraints: " << graph.constraints.size()
+                     << ", evaluations: " << evalCount << endl;
+            }
+
+            if (resultCache.enabled()) {
+                redirectOutput(uncaptured);
+                resultCache.store(key, "", captured.str());
+                cout << captured.str();
+            }
+        }
+
+    if (resultCache.enabled()) {
+        cout << "Result cache: " << resultCache.hits << " hits, "
+             << resultCache.misses << " misses" << endl;
+    }
+    if (wantStats) {
+        stats.print(ResultPrinter("intervalSSAAnalysis"));
+        activeStats() = nullptr;
+    }
+    return 0;
+}
+
+bool isTracked(Value *V)
+{
+    return V->getType()->isIntegerTy() && (isa<Instruction>(V) || isa<Argument>(V));
+}
+
+// Immediate dominators by the Cooper-Harvey-Kennedy iteration over RPO.
+map<BasicBlock*, BasicBlock*> immediateDominators(const vector<BasicBlock*> &order)
+{
+    map<BasicBlock*, unsigned> rpoIndex;
+    for (unsigned i = 0; i < order.size(); ++i) {
+        rpoIndex[order[i]] = i;
+    }
+
+    map<BasicBlock*, vector<BasicBlock*>> preds;
+    for (auto BB: order) {
+        const Terminator *TInst = BB->getTerminator();
+        for (unsigned i = 0; i < TInst->getNumSuccessors(); ++i) {
+            preds[TInst->getSuccessor(i)].push_back(BB);
+        }
+    }
+
+    map<BasicBlock*, BasicBlock*> idom;
+    idom[order[0]] = order[0];
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (unsigned i = 1; i < order.size(); ++i) {
+            BasicBlock *BB = order[i];
+            BasicBlock *newIdom = nullptr;
+            for (auto P: preds[BB]) {
+                if (idom.find(P) == idom.end()) {
+                    continue;
+                }
+                if (newIdom == nullptr) {
+                    newIdom = P;
+                    continue;
+                }
+                BasicBlock *a = P;
+                BasicBlock *b = newIdom;
+                while (a != b) {
+                    while (rpoIndex[a] > rpoIndex[b]) a = idom[a];
+                    while (rpoIndex[b] > rpoIndex[a]) b = idom[b];
+                }
+                newIdom = a;
+            }
+            if (idom[BB] != newIdom) {
+                idom[BB] = newIdom;
+                changed = true;
+            }
+        }
+    }
+    return idom;
+}
+
+CmpInst::Predicate swapPredicate(CmpInst::Predicate pred)
+{
+    return CmpInst::getSwappedPredicate(pred);
+}
+
+int addVariable(ConstraintGraph &graph, Value *V)
+{
+    int id = graph.values.size();
+    graph.values.push_back(V);
+    graph.definedBy.push_back(-1);
+    graph.users.push_back(vector<int>());
+    if (V != nullptr) {
+        graph.ids[V] = id;
+    }
+    return id;
+}
+
+void addConstraint(ConstraintGraph &graph, const Constraint &c)
+{
+    int index = graph.constraints.size();
+    graph.constraints.push_back(c);
+    graph.definedBy[c.sink] = index;
+    for (auto src: c.sources) {
+        if (src >= 0) {
+            graph.users[src].push_back(index);
+        }
+    }
+    if (c.kind == Constraint::Sigma && c.bound >= 0) {
+        graph.users[c.bound].push_back(index);
+    }
+}
+
+// Resolves an operand to its variable id, honouring the sigma renames that
+// are live in the block where the use happens.
+int operandId(
+    ConstraintGraph &graph,
+    Value *V,
+    const map<Value*, int> &renames,
+    vector<Interval> &constants)
+{
+    auto renamed = renames.find(V);
+    if (renamed != renames.end()) {
+        constants.push_back(Interval());
+        return renamed->second;
+    }
+    auto iter = graph.ids.find(V);
+    if (iter != graph.ids.end()) {
+        constants.push_back(Interval());
+        return iter->second;
+    }
+    ConstantInt *constInt = dyn_cast<ConstantInt>(V);
+    if (constInt != nullptr) {
+        int newVal = constInt->getSExtValue();
+        constants.push_back(Interval(newVal, newVal));
+    } else {
+        constants.push_back(Interval());
+    }
+    return -1;
+}
+
+ConstraintGraph buildGraph(Function &F)
+{
+    ConstraintGraph graph;
+    for (auto arg = F.arg_begin(); arg != F.arg_end(); ++arg) {
+        if (isTracked(&*arg)) {
+            addVariable(graph, &*arg);
+        }
+    }
+    for (auto &BB: F) {
+        for (auto &I: BB) {
+            if (isTracked(&I)) {
+                addVariable(graph, &I);
+            }
+        }
+    }
+
+    vector<BasicBlock*> order = reversePostOrder(F);
+    map<BasicBlock*, BasicBlock*> idom = immediateDominators(order);
+    map<BasicBlock*, unsigned> predCount;
+    for (auto BB: order) {
+        const Terminator *TInst = BB->getTerminator();
+        for (unsigned i = 0; i < TInst->getNumSuccessors(); ++i) {
+            ++predCount[TInst->getSuccessor(i)];
+        }
+    }
+
+    // A conditional edge into a block with a single predecessor dominates that
+    // block, so the condition holds for every use the block dominates.
+    map<BasicBlock*, map<Value*, int>> renames;
+    vector<PHINode*> phis;
+    for (auto BB: order) {
+        map<Value*, int> live;
+        if (BB != order[0]) {
+            live = renames[idom[BB]];
+        }
+
+        if (predCount[BB] == 1 && BB != order[0]) {
+            BasicBlock *pred = idom[BB];
+            const BranchInst *BInst = dyn_cast<BranchInst>(pred->getTerminator());
+            ICmpInst *cmp = BInst != nullptr && BInst->isConditional() ?
+                dyn_cast<ICmpInst>(BInst->getCondition()) : nullptr;
+            if (cmp != nullptr && BInst->getSuccessor(0) != BInst->getSuccessor(1)) {
+                CmpInst::Predicate pred0 = cmp->getPredicate();
+                if (BInst->getSuccessor(1) == BB) {
+                    pred0 = cmp->getInversePredicate();
+                }
+                map<Value*, int> &predLive = renames[pred];
+                for (unsigned side = 0; side < 2; ++side) {
+                    Value *var = cmp->getOperand(side);
+                    Value *other = cmp->getOperand(1 - side);
+                    if (!isTracked(var)) {
+                        continue;
+                    }
+                    Constraint c;
+                    c.kind = Constraint::Sigma;
+                    c.pred = side == 0 ? pred0 : swapPredicate(pred0);
+                    c.sink = addVariable(graph, nullptr);
+                    c.sources.push_back(operandId(graph, var, predLive, c.constants));
+                    vector<Interval> boundConst;
+                    c.bound = operandId(graph, other, predLive, boundConst);
+                    c.boundConstant = boundConst[0];
+                    addConstraint(graph, c);
+                    live[var] = c.sink;
+                }
+            }
+        }
+
+        for (auto &I: *BB) {
+            if (!isTracked(&I)) {
+                continue;
+            }
+            Constraint c;
+            c.sink = graph.ids[&I];
+            if (isa<PHINode>(I)) {
+                phis.push_back(dyn_cast<PHINode>(&I));
+                continue;
+            } else if (I.isBinaryOp()) {
+                c.kind = Constraint::Binary;
+                c.opcode = I.getOpcode();
+                c.sources.push_back(operandId(graph, I.getOperand(0), live, c.constants));
+                c.sources.push_back(operandId(graph, I.getOperand(1), live, c.constants));
+            } else if (isa<CastInst>(I) && I.getOperand(0)->getType()->isIntegerTy()) {
+                c.kind = Constraint::Copy;
+                c.sources.push_back(operandId(graph, I.getOperand(0), live, c.constants));
+            } else {
+                // Loads, calls, compares: unconstrained program inputs.
+                continue;
+            }
+            addConstraint(graph, c);
+        }
+        renames[BB] = live;
+    }
+
+    // A phi operand is used at the end of its incoming block, which may be a
+    // loop latch, so phis wait until every block's renames are known.
+    for (auto phi: phis) {
+        Constraint c;
+        c.kind = Constraint::Phi;
+        c.sink = graph.ids[phi];
+        for (unsigned x = 0; x < phi->getNumIncomingValues(); ++x) {
+            const map<Value*, int> &incoming = renames[phi->getIncomingBlock(x)];
+            c.sources.push_back(operandId(graph, phi->getIncomingValue(x), incoming, c.constants));
+        }
+        addConstraint(graph, c);
+    }
+    return graph;
+}
+
+// Iterative Tarjan. Bound variables count as dependencies of their sigma so
+// every future is solved before the component that reads it, where possible.
+vector<vector<int>> stronglyConnectedComponents(const ConstraintGraph &graph)
+{
+    unsigned n = graph.values.size();
+    vector<vector<int>> succs(n);
+    for (auto &c: graph.constraints) {
+        for (auto src: c.sources) {
+            if (src >= 0) succs[src].push_back(c.sink);
+        }
+        if (c.kind == Constraint::Sigma && c.bound >= 0) {
+            succs[c.bound].push_back(c.sink);
+        }
+    }
+
+    vector<int> index(n, -1), lowLink(n, 0);
+    vector<bool> onStack(n, false);
+    vector<int> sccStack;
+    vector<vector<int>> components;
+    int nextIndex = 0;
+
+    for (unsigned root = 0; root < n; ++root) {
+        if (index[root] >= 0) {
+            continue;
+        }
+        vector<pair<int, unsigned>> callStack;
+        callStack.push_back(make_pair(root, 0));
+        index[root] = lowLink[root] = nextIndex++;
+        sccStack.push_back(root);
+        onStack[root] = true;
+
+        while (!callStack.empty()) {
+            int v = callStack.back().first;
+            unsigned &next = callStack.back().second;
+            if (next < succs[v].size()) {
+                int w = succs[v][next++];
+                if (index[w] < 0) {
+                    index[w] = lowLink[w] = nextIndex++;
+                    sccStack.push_back(w);
+                    onStack[w] = true;
+                    callStack.push_back(make_pair(w, 0));
+                } else if (onStack[w]) {
+                    lowLink[v] = min(lowLink[v], index[w]);
+                }
+                continue;
+            }
+
+            if (lowLink[v] == index[v]) {
+                vector<int> component;
+                int w;
+                do {
+                    w = sccStack.back();
+                    sccStack.pop_back();
+                    onStack[w] = false;
+                    component.push_back(w);
+                } while (w != v);
+                components.push_back(component);
+            }
+            callStack.pop_back();
+            if (!callStack.empty()) {
+                int parent = callStack.back().first;
+                lowLink[parent] = min(lowLink[parent], lowLink[v]);
+            }
+        }
+    }
+
+    // Tarjan emits components in reverse topological order.
+    reverse(components.begin(), components.end());
+    return components;
+}
+
+// Range a value must lie in for `value pred bound` to hold.
+Interval conditionRange(CmpInst::Predicate pred, Interval bound)
+{
+    switch (pred) {
+        case CmpInst::Predicate::ICMP_SLT:
+            return Interval(true, 0) + bound - Interval(1, 1);
+        case CmpInst::Predicate::ICMP_SLE:
+            return Interval(true, 0) + bound;
+        case CmpInst::Predicate::ICMP_SGT:
+            return Interval(0, true) + bound + Interval(1, 1);
+        case CmpInst::Predicate::ICMP_SGE:
+            return Interval(0, true) + bound;
+        case CmpInst::Predicate::ICMP_EQ:
+            return bound;
+        default:
+            return Interval();
+    }
+}
+
+// Evaluates a constraint. Returns false while an operand is still unreached.
+// Futures, i.e. variable bounds of a sigma, are ignored until resolved.
+bool evaluate(
+    const Constraint &c,
+    const vector<Interval> &ranges,
+    const vector<bool> &reached,
+    bool futuresResolved,
+    Interval &result)
+{
+    vector<Interval> operands;
+    vector<bool> known;
+    for (unsigned i = 0; i < c.sources.size(); ++i) {
+        int src = c.sources[i];
+        bool ok = src < 0 || (reached[src] && !ranges[src].isEmpty());
+        operands.push_back(src < 0 ? c.constants[i] : ranges[src]);
+        known.push_back(ok);
+    }
+
+    switch (c.kind) {
+        case Constraint::Copy:
+            if (!known[0]) return false;
+            result = operands[0];
+            return true;
+        case Constraint::Phi: {
+            bool any = false;
+            for (unsigned i = 0; i < operands.size(); ++i) {
+                if (!known[i]) continue;
+                if (!any) {
+                    result = operands[i];
+                    any = true;
+                } else {
+                    result.unionWith(operands[i]);
+                }
+            }
+            return any;
+        }
+        case Constraint::Binary:
+            if (!known[0] || !known[1]) return false;
+            switch (c.opcode) {
+                case Instruction::Add:
+                    result = operands[0] + operands[1];
+                    break;
+                case Instruction::Sub:
+                    result = operands[0] - operands[1];
+                    break;
+                case Instruction::Mul:
+                    result = operands[0] * operands[1];
+                    break;
+                default:
+                    result = Interval();
+            }
+            return true;
+        case Constraint::Sigma: {
+            if (!known[0]) return false;
+            result = operands[0];
+            if (c.bound < 0) {
+                result.meetWith(conditionRange(c.pred, c.boundConstant));
+            } else if (futuresResolved && reached[c.bound]) {
+                result.meetWith(conditionRange(c.pred, ranges[c.bound]));
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+vector<Interval> solveGraph(const ConstraintGraph &graph, int &evalCount)
+{
+    unsigned n = graph.values.size();
+    vector<Interval> ranges(n);
+    vector<bool> reached(n, false);
+    vector<int> componentOf(n, -1);
+    vector<vector<int>> components = stronglyConnectedComponents(graph);
+    for (unsigned k = 0; k < components.size(); ++k) {
+        for (auto v: components[k]) componentOf[v] = k;
+    }
+
+    for (unsigned k = 0; k < components.size(); ++k) {
+        const vector<int> &component = components[k];
+        vector<int> worklist;
+        set<int> pending;
+        for (auto v: component) {
+            if (graph.definedBy[v] < 0) {
+                reached[v] = true;
+            } else if (pending.insert(graph.definedBy[v]).second) {
+                worklist.push_back(graph.definedBy[v]);
+            }
+        }
+
+        // Widening to a fixed point, then futures resolution: from the second
+        // phase on, sigmas honour their variable bounds. Narrowing then
+        // recovers the finite bounds the widening jumped over.
+        for (int phase = 0; phase < 2; ++phase) {
+            bool narrowing = phase == 1;
+            if (narrowing) {
+                for (auto v: component) {
+                    if (graph.definedBy[v] >= 0 && pending.insert(graph.definedBy[v]).second) {
+                        worklist.push_back(graph.definedBy[v]);
+                    }
+                }
+            }
+
+            while (!worklist.empty()) {
+                int index = worklist.back();
+                worklist.pop_back();
+                pending.erase(index);
+                const Constraint &c = graph.constraints[index];
+
+                Interval result;
+                ++evalCount;
+                if (!evaluate(c, ranges, reached, narrowing, result)) {
+                    continue;
+                }
+
+                Interval old = ranges[c.sink];
+                bool wasReached = reached[c.sink] && !old.isEmpty();
+                if (!wasReached) {
+                    ranges[c.sink] = result;
+                    reached[c.sink] = true;
+                } else if (narrowing) {
+                    ranges[c.sink].narrowWith(result);
+                } else {
+                    ranges[c.sink].widenWith(result);
+                }
+                if (wasReached && old == ranges[c.sink]) {
+                    continue;
+                }
+
+                for (auto user: graph.users[c.sink]) {
+                    if (componentOf[graph.constraints[user].sink] == (int) k &&
+                        pending.insert(user).second) {
+                        worklist.push_back(user);
+                    }
+                }
+            }
+        }
+    }
+    return ranges;
+}
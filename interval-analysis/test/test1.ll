@@ -11,35 +11,35 @@ define i32 @main() #0 {
   store i32 0, i32* %1
   store i32 3, i32* %x, align 4
   store i32 -5, i32* %b, align 4
-  %2 = load i32* %x, align 4
-  %3 = load i32* %b, align 4
+  %2 = load i32, i32* %x, align 4
+  %3 = load i32, i32* %b, align 4
   %4 = add nsw i32 %2, %3
-  %5 = load i32* %a, align 4
+  %5 = load i32, i32* %a, align 4
   %6 = sub nsw i32 %4, %5
   %7 = icmp sle i32 %6, 0
   br i1 %7, label %8, label %11
 
 ; <label>:8                                       ; preds = %0
-  %9 = load i32* %b, align 4
+  %9 = load i32, i32* %b, align 4
   %10 = add nsw i32 3, %9
   store i32 %10, i32* %x, align 4
   br label %22
 
 ; <label>:11                                      ; preds = %0
-  %12 = load i32* %a, align 4
+  %12 = load i32, i32* %a, align 4
   %13 = icmp sgt i32 %12, 0
   br i1 %13, label %14, label %17
 
 ; <label>:14                                      ; preds = %11
-  %15 = load i32* %b, align 4
+  %15 = load i32, i32* %b, align 4
   %16 = sub nsw i32 %15, 10
   store i32 %16, i32* %x, align 4
   br label %21
 
 ; <label>:17                                      ; preds = %11
   store i32 3, i32* %b, align 4
-  %18 = load i32* %b, align 4
-  %19 = load i32* %x, align 4
+  %18 = load i32, i32* %b, align 4
+  %19 = load i32, i32* %x, align 4
   %20 = add nsw i32 %18, %19
   store i32 %20, i32* %x, align 4
   br label %21
@@ -48,7 +48,7 @@ define i32 @main() #0 {
   br label %22
 
 ; <label>:22                                      ; preds = %21, %8
-  %23 = load i32* %x, align 4
+  %23 = load i32, i32* %x, align 4
   ret i32 %23
 }
 
@@ -56,4 +56,4 @@ attributes #0 = { nounwind uwtable "less-precise-fpmad"="false" "no-frame-pointe
 
 !llvm.ident = !{!0}
 
-!0 = metadata !{metadata !"clang version 3.4.2 (tags/RELEASE_34/dot2-final)"}
+!0 = !{!"clang version 3.4.2 (tags/RELEASE_34/dot2-final)"}
@@ -0,0 +1,15 @@
+int main() {
+    int k;
+    signed char c = 100;
+    short s = 30000;
+    if (k > 0) {
+        c = 120;
+        s = 32000;
+    }
+    signed char d = c + 7;
+    signed char e = c + 8;
+    short t = s + 767;
+    short u = s + 768;
+    short v = s * -1;
+    return 0;
+}
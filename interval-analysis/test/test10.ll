@@ -0,0 +1,44 @@
+; ModuleID = 'test10.c'
+source_filename = "test10.c"
+
+; The char and short arithmetic is done at i8 and i16, where it wraps as
+; the C does once the result is converted back.
+define i32 @main() {
+entry:
+  %k = alloca i32, align 4
+  %c = alloca i8, align 1
+  %s = alloca i16, align 2
+  %d = alloca i8, align 1
+  %e = alloca i8, align 1
+  %t = alloca i16, align 2
+  %u = alloca i16, align 2
+  %v = alloca i16, align 2
+  store i8 100, i8* %c, align 1
+  store i16 30000, i16* %s, align 2
+  %0 = load i32, i32* %k, align 4
+  %cmp = icmp sgt i32 %0, 0
+  br i1 %cmp, label %if.then, label %if.end
+
+if.then:
+  store i8 120, i8* %c, align 1
+  store i16 32000, i16* %s, align 2
+  br label %if.end
+
+if.end:
+  %1 = load i8, i8* %c, align 1
+  %add = add i8 %1, 7
+  store i8 %add, i8* %d, align 1
+  %2 = load i8, i8* %c, align 1
+  %add1 = add i8 %2, 8
+  store i8 %add1, i8* %e, align 1
+  %3 = load i16, i16* %s, align 2
+  %add2 = add i16 %3, 767
+  store i16 %add2, i16* %t, align 2
+  %4 = load i16, i16* %s, align 2
+  %add3 = add i16 %4, 768
+  store i16 %add3, i16* %u, align 2
+  %5 = load i16, i16* %s, align 2
+  %mul = mul i16 %5, -1
+  store i16 %mul, i16* %v, align 2
+  ret i32 0
+}
@@ -10,24 +10,24 @@ define i32 @main() #0 {
   %b = alloca i32, align 4
   store i32 0, i32* %1
   store i32 5, i32* %b, align 4
-  %2 = load i32* %a, align 4
+  %2 = load i32, i32* %a, align 4
   %3 = icmp sgt i32 %2, 0
   br i1 %3, label %4, label %7
 
 ; <label>:4                                       ; preds = %0
-  %5 = load i32* %b, align 4
+  %5 = load i32, i32* %b, align 4
   %6 = add nsw i32 3, %5
   store i32 %6, i32* %x, align 4
   br label %10
 
 ; <label>:7                                       ; preds = %0
-  %8 = load i32* %b, align 4
+  %8 = load i32, i32* %b, align 4
   %9 = sub nsw i32 3, %8
   store i32 %9, i32* %x, align 4
   br label %10
 
 ; <label>:10                                      ; preds = %7, %4
-  %11 = load i32* %x, align 4
+  %11 = load i32, i32* %x, align 4
   ret i32 %11
 }
 
@@ -35,4 +35,4 @@ attributes #0 = { nounwind uwtable "less-precise-fpmad"="false" "no-frame-pointe
 
 !llvm.ident = !{!0}
 
-!0 = metadata !{metadata !"clang version 3.4.2 (tags/RELEASE_34/dot2-final)"}
+!0 = !{!"clang version 3.4.2 (tags/RELEASE_34/dot2-final)"}
@@ -0,0 +1,45 @@
+; ModuleID = 'test/test4.c'
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+define i32 @main() {
+  br label %1
+
+; <label>:1                                                ; preds = %14, %0
+  %x.0 = phi i32 [ 0, %0 ], [ %x.1, %14 ]
+  %a.0 = phi i32 [ -2, %0 ], [ %a.1, %14 ]
+  %i.0 = phi i32 [ 0, %0 ], [ %2, %14 ]
+  %2 = add nsw i32 %i.0, 1
+  %3 = icmp slt i32 %i.0, undef
+  br i1 %3, label %4, label %15
+
+; <label>:4                                                ; preds = %1
+  %5 = icmp sgt i32 %a.0, 0
+  br i1 %5, label %6, label %8
+
+; <label>:6                                                ; preds = %4
+  %7 = add nsw i32 %x.0, 7
+  br label %10
+
+; <label>:8                                                ; preds = %4
+  %9 = sub nsw i32 %x.0, 2
+  br label %10
+
+; <label>:10                                               ; preds = %8, %6
+  %x.1 = phi i32 [ %7, %6 ], [ %9, %8 ]
+  %11 = icmp sgt i32 5, 0
+  br i1 %11, label %12, label %13
+
+; <label>:12                                               ; preds = %10
+  br label %14
+
+; <label>:13                                               ; preds = %10
+  br label %14
+
+; <label>:14                                               ; preds = %13, %12
+  %a.1 = phi i32 [ 6, %12 ], [ -5, %13 ]
+  br label %1
+
+; <label>:15                                               ; preds = %1
+  ret i32 0
+}
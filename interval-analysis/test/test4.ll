@@ -19,34 +19,34 @@ define i32 @main() #0 {
   br label %2
 
 ; <label>:2                                       ; preds = %21, %0
-  %3 = load i32* %i, align 4
+  %3 = load i32, i32* %i, align 4
   %4 = add nsw i32 %3, 1
   store i32 %4, i32* %i, align 4
-  %5 = load i32* %N, align 4
+  %5 = load i32, i32* %N, align 4
   %6 = icmp slt i32 %3, %5
   br i1 %6, label %7, label %22
 
 ; <label>:7                                       ; preds = %2
-  %8 = load i32* %a, align 4
+  %8 = load i32, i32* %a, align 4
   %9 = icmp sgt i32 %8, 0
   br i1 %9, label %10, label %13
 
 ; <label>:10                                      ; preds = %7
-  %11 = load i32* %x, align 4
+  %11 = load i32, i32* %x, align 4
   %12 = add nsw i32 %11, 7
   store i32 %12, i32* %x, align 4
   store i32 5, i32* %y, align 4
   br label %16
 
 ; <label>:13                                      ; preds = %7
-  %14 = load i32* %x, align 4
+  %14 = load i32, i32* %x, align 4
   %15 = sub nsw i32 %14, 2
   store i32 %15, i32* %x, align 4
   store i32 1, i32* %y, align 4
   br label %16
 
 ; <label>:16                                      ; preds = %13, %10
-  %17 = load i32* %b, align 4
+  %17 = load i32, i32* %b, align 4
   %18 = icmp sgt i32 %17, 0
   br i1 %18, label %19, label %20
 
@@ -69,4 +69,4 @@ attributes #0 = { nounwind uwtable "less-precise-fpmad"="false" "no-frame-pointe
 
 !llvm.ident = !{!0}
 
-!0 = metadata !{metadata !"clang version 3.4.2 (tags/RELEASE_34/dot2-final)"}
+!0 = !{!"clang version 3.4.2 (tags/RELEASE_34/dot2-final)"}
@@ -0,0 +1,19 @@
+; ModuleID = 'test/test5.c'
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+define i32 @main() {
+  br label %1
+
+; <label>:1                                                ; preds = %3, %0
+  %x.0 = phi i32 [ 0, %0 ], [ %4, %3 ]
+  %2 = icmp slt i32 %x.0, 40
+  br i1 %2, label %3, label %5
+
+; <label>:3                                                ; preds = %1
+  %4 = add nsw i32 %x.0, 1
+  br label %1
+
+; <label>:5                                                ; preds = %1
+  ret i32 0
+}
@@ -11,12 +11,12 @@ define i32 @main() #0 {
   br label %2
 
 ; <label>:2                                       ; preds = %5, %0
-  %3 = load i32* %x, align 4
+  %3 = load i32, i32* %x, align 4
   %4 = icmp slt i32 %3, 40
   br i1 %4, label %5, label %8
 
 ; <label>:5                                       ; preds = %2
-  %6 = load i32* %x, align 4
+  %6 = load i32, i32* %x, align 4
   %7 = add nsw i32 %6, 1
   store i32 %7, i32* %x, align 4
   br label %2
@@ -29,4 +29,4 @@ attributes #0 = { nounwind uwtable "less-precise-fpmad"="false" "no-frame-pointe
 
 !llvm.ident = !{!0}
 
-!0 = metadata !{metadata !"clang version 3.4.2 (tags/RELEASE_34/dot2-final)"}
+!0 = !{!"clang version 3.4.2 (tags/RELEASE_34/dot2-final)"}
@@ -0,0 +1,21 @@
+int counter = 0;
+
+int clamp(int v) {
+    if (v > 10) {
+        v = 10;
+    }
+    counter = counter + 1;
+    return v;
+}
+
+int twice(int v) {
+    return v + v;
+}
+
+int main() {
+    int a = 3, b = 20, x, y, z;
+    x = clamp(a);
+    y = clamp(b);
+    z = twice(a) + twice(a);
+    return 0;
+}
@@ -0,0 +1,67 @@
+; ModuleID = 'test/test6.c'
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+@counter = global i32 0, align 4
+
+; Function Attrs: nounwind uwtable
+define i32 @clamp(i32 %v) #0 {
+  %1 = alloca i32, align 4
+  store i32 %v, i32* %1, align 4
+  %2 = load i32, i32* %1, align 4
+  %3 = icmp sgt i32 %2, 10
+  br i1 %3, label %4, label %5
+
+; <label>:4                                       ; preds = %0
+  store i32 10, i32* %1, align 4
+  br label %5
+
+; <label>:5                                       ; preds = %4, %0
+  %6 = load i32, i32* @counter, align 4
+  %7 = add nsw i32 %6, 1
+  store i32 %7, i32* @counter, align 4
+  %8 = load i32, i32* %1, align 4
+  ret i32 %8
+}
+
+; Function Attrs: nounwind uwtable
+define i32 @twice(i32 %v) #0 {
+  %1 = alloca i32, align 4
+  store i32 %v, i32* %1, align 4
+  %2 = load i32, i32* %1, align 4
+  %3 = load i32, i32* %1, align 4
+  %4 = add nsw i32 %2, %3
+  ret i32 %4
+}
+
+; Function Attrs: nounwind uwtable
+define i32 @main() #0 {
+  %1 = alloca i32, align 4
+  %a = alloca i32, align 4
+  %b = alloca i32, align 4
+  %x = alloca i32, align 4
+  %y = alloca i32, align 4
+  %z = alloca i32, align 4
+  store i32 0, i32* %1
+  store i32 3, i32* %a, align 4
+  store i32 20, i32* %b, align 4
+  %2 = load i32, i32* %a, align 4
+  %3 = call i32 @clamp(i32 %2)
+  store i32 %3, i32* %x, align 4
+  %4 = load i32, i32* %b, align 4
+  %5 = call i32 @clamp(i32 %4)
+  store i32 %5, i32* %y, align 4
+  %6 = load i32, i32* %a, align 4
+  %7 = call i32 @twice(i32 %6)
+  %8 = load i32, i32* %a, align 4
+  %9 = call i32 @twice(i32 %8)
+  %10 = add nsw i32 %7, %9
+  store i32 %10, i32* %z, align 4
+  ret i32 0
+}
+
+attributes #0 = { nounwind uwtable "less-precise-fpmad"="false" "no-frame-pointer-elim"="true" "no-frame-pointer-elim-non-leaf" "no-infs-fp-math"="false" "no-nans-fp-math"="false" "stack-protector-buffer-size"="8" "unsafe-fp-math"="false" "use-soft-float"="false" }
+
+!llvm.ident = !{!0}
+
+!0 = !{!"clang version 3.4.2 (tags/RELEASE_34/dot2-final)"}
@@ -0,0 +1,11 @@
+int main() {
+    int x = 0;
+    int y = 0;
+    while (x < 100) {
+        if (x > 5) {
+            y = x + 1;
+        }
+        x = x + 1;
+    }
+    return y;
+}
@@ -0,0 +1,37 @@
+; ModuleID = 'test7.c'
+source_filename = "test7.c"
+
+define i32 @main() {
+entry:
+  %x = alloca i32, align 4
+  %y = alloca i32, align 4
+  store i32 0, i32* %x, align 4
+  store i32 0, i32* %y, align 4
+  br label %loop
+
+loop:
+  %0 = load i32, i32* %x, align 4
+  %cmp = icmp slt i32 %0, 100
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %1 = load i32, i32* %x, align 4
+  %cmp1 = icmp sgt i32 %1, 5
+  br i1 %cmp1, label %then, label %latch
+
+then:
+  %2 = load i32, i32* %x, align 4
+  %add = add nsw i32 %2, 1
+  store i32 %add, i32* %y, align 4
+  br label %latch
+
+latch:
+  %3 = load i32, i32* %x, align 4
+  %inc = add nsw i32 %3, 1
+  store i32 %inc, i32* %x, align 4
+  br label %loop
+
+exit:
+  %4 = load i32, i32* %y, align 4
+  ret i32 %4
+}
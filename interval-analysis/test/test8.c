@@ -0,0 +1,6 @@
+int g = 5;
+
+int main() {
+    int x = g + 1;
+    return x;
+}
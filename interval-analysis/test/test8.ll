@@ -0,0 +1,14 @@
+; ModuleID = 'test8.c'
+source_filename = "test8.c"
+
+@g = global i32 5, align 4
+
+define i32 @main() {
+entry:
+  %x = alloca i32, align 4
+  %0 = load i32, i32* @g, align 4
+  %add = add nsw i32 %0, 1
+  store i32 %add, i32* %x, align 4
+  %1 = load i32, i32* %x, align 4
+  ret i32 %1
+}
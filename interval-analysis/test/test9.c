@@ -0,0 +1,11 @@
+int main() {
+    int c;
+    long a = 1;
+    if (c > 0) {
+        a = 6000000000000000000;
+    }
+    long s = a + 6000000000000000000;
+    long m = a * 2;
+    long d = a - 1;
+    return 0;
+}
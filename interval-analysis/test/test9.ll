@@ -0,0 +1,31 @@
+; ModuleID = 'test9.c'
+source_filename = "test9.c"
+
+define i32 @main() {
+entry:
+  %c = alloca i32, align 4
+  %a = alloca i64, align 8
+  %s = alloca i64, align 8
+  %m = alloca i64, align 8
+  %d = alloca i64, align 8
+  store i64 1, i64* %a, align 8
+  %0 = load i32, i32* %c, align 4
+  %cmp = icmp sgt i32 %0, 0
+  br i1 %cmp, label %if.then, label %if.end
+
+if.then:
+  store i64 6000000000000000000, i64* %a, align 8
+  br label %if.end
+
+if.end:
+  %1 = load i64, i64* %a, align 8
+  %add = add nsw i64 %1, 6000000000000000000
+  store i64 %add, i64* %s, align 8
+  %2 = load i64, i64* %a, align 8
+  %mul = mul nsw i64 %2, 2
+  store i64 %mul, i64* %m, align 8
+  %3 = load i64, i64* %a, align 8
+  %sub = sub nsw i64 %3, 1
+  store i64 %sub, i64* %d, align 8
+  ret i32 0
+}
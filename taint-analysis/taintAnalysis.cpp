@@ -1,6 +1,10 @@
 #include <cstdio>
 #include <iostream>
 #include <set>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <cstring>
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Function.h"
@@ -9,24 +13,58 @@
 #include "llvm/IRReader/IRReader.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/IR/Value.h"
+#include "../common/IRInput.h"
+#include "../common/CFG.h"
+#include "../common/ResultFormat.h"
+#include "../common/Stats.h"
 
 using namespace llvm;
 using namespace std;
 
 void generateCFG(BasicBlock* BB, int &counter, set<Value*> sourceVars, set<Value*> &finalVars);
+void solveMerged(Function &F, int &counter, set<Value*> &finalVars);
 
 int main(int argc, char **argv)
 {
-    // Read the IR file.
-    LLVMContext &Context = getGlobalContext();
+    // Read the IR file, textual or bitcode; "-" reads standard input. The
+    // context is owned by this run, so runs on other threads never share one.
+    LLVMContext Context;
     SMDiagnostic Err;
-    Module *M = ParseIRFile(argv[1], Err, Context);
+    auto parseStart = chrono::steady_clock::now();
+    Module *M = loadModule(argv[1], Err, Context);
+    auto parseTime = chrono::steady_clock::now() - parseStart;
     if (M == nullptr)
     {
         fprintf(stderr, "error: failed to load LLVM IR file \"%s\"", argv[1]);
         return EXIT_FAILURE;
     }
 
+    // --merge joins taint sets where paths meet instead of walking every path.
+    // The report changes with it: each reachable block is printed once, in
+    // layout order, with the union over all of its paths, where the walker
+    // prints a block again on every path through it. The final "Tainted
+    // Variables" line is the same union either way.
+    // --stats reports phase times and counters after the results (see
+    // common/Stats.h), as the loop analyses do.
+    bool merge = false;
+    bool wantStats = false;
+    for (int i = 2; i < argc; ++i) {
+        if (strcmp(argv[i], "--merge") == 0) {
+            merge = true;
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            wantStats = true;
+        } else {
+            fprintf(stderr, "error: unknown option \"%s\"\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    AnalysisStats stats;
+    activeStats() = wantStats ? &stats : nullptr;
+    if (wantStats) {
+        stats.addTime("parse", parseTime);
+    }
+
     // tainted variable set
     set<Value*> sourceVars;
     set<Value*> finalVars;
@@ -34,8 +72,25 @@ int main(int argc, char **argv)
     int counter = 1;
     for (auto &F: *M)
         if (strncmp(F.getName().str().c_str(), "main", 4) == 0) {
-            BasicBlock* BB = dyn_cast<BasicBlock>(F.begin());
-            generateCFG(BB, counter, sourceVars, finalVars);
+            {
+                PhaseTimer timer("parse");
+                if (!materialize(F)) {
+                    return EXIT_FAILURE;
+                }
+            }
+            int startCount = counter;
+            {
+                PhaseTimer timer("solve");
+                if (merge) {
+                    solveMerged(F, counter, finalVars);
+                } else {
+                    BasicBlock* BB = dyn_cast<BasicBlock>(F.begin());
+                    generateCFG(BB, counter, sourceVars, finalVars);
+                }
+            }
+            if (wantStats) {
+                stats.addIterations(F.getName().str(), counter - startCount);
+            }
             cout << "Tainted Variables: {";
             for (auto i = finalVars.begin(); i != finalVars.end(); ++i) {
                 if((*i)->hasName())
@@ -43,13 +98,23 @@ int main(int argc, char **argv)
             }
             cout << "}" << endl;
         }
+
+    if (wantStats) {
+        stats.print(ResultPrinter("taintAnalysis"));
+        activeStats() = nullptr;
+    }
     return 0;
 }
 
 
 set<Value*> checkTainted(BasicBlock* BB, set<Value*> sinkVars)
 {
+    PhaseTimer timer("transfer");
+    AnalysisStats *stats = activeStats();
     for (auto &I: *BB) {
+        if (stats != nullptr) {
+            stats->countOpcode(I.getOpcodeName());
+        }
         if (strncmp(I.getName().str().c_str(), "source", 6) == 0)
             sinkVars.insert(dyn_cast<Value>(&I));
 
@@ -86,17 +151,24 @@ void generateCFG(BasicBlock* BB, int &counter, set<Value*> sourceVars, set<Value
 
     cout << "Block " << counter << ": {";
     set<Value*> sinkVars = checkTainted(BB, sourceVars);
+    countStat("block visits");
     // Print out the tainted variables
-    for (auto i = sinkVars.begin(); i != sinkVars.end(); ++i) {
-        if((*i)->hasName())
-            cout << (*i)->getName().str().c_str() << ", ";
+    {
+        PhaseTimer timer("print");
+        for (auto i = sinkVars.begin(); i != sinkVars.end(); ++i) {
+            if((*i)->hasName())
+                cout << (*i)->getName().str().c_str() << ", ";
+        }
+        cout << "}" << endl;
     }
-    cout << "}" << endl;
     ++counter;
-    const TerminatorInst *TInst = BB->getTerminator();
+    const Terminator *TInst = BB->getTerminator();
     unsigned int NSucc = TInst->getNumSuccessors();
     for (unsigned i = 0; i < NSucc; ++i) {
         BasicBlock *Succ = TInst->getSuccessor(i);
+        if (AnalysisStats *stats = activeStats()) {
+            stats->countEdge(BB, Succ);
+        }
         generateCFG(Succ, counter, sinkVars, finalVars);
     }
 
@@ -104,3 +176,62 @@ void generateCFG(BasicBlock* BB, int &counter, set<Value*> sourceVars, set<Value
         finalVars.insert(sinkVars.begin(), sinkVars.end());
     }
 }
+
+void solveMerged(Function &F, int &counter, set<Value*> &finalVars)
+{
+    vector<BasicBlock*> order = reversePostOrder(F);
+    map<BasicBlock*, unsigned> rpoIndex;
+    for (unsigned i = 0; i < order.size(); ++i)
+        rpoIndex[order[i]] = i;
+
+    // Taint only grows at a merge and checkTainted is gen/kill, so a block is
+    // re-queued only when its input gains a variable and the loop terminates.
+    map<BasicBlock*, set<Value*>> inVars;
+    map<BasicBlock*, set<Value*>> outVars;
+    set<unsigned> worklist;
+    inVars[order[0]];
+    worklist.insert(0);
+
+    while (!worklist.empty()) {
+        BasicBlock *BB = order[*worklist.begin()];
+        worklist.erase(worklist.begin());
+
+        set<Value*> &sinkVars = outVars[BB];
+        sinkVars = checkTainted(BB, inVars[BB]);
+        countStat("block visits");
+
+        const Terminator *TInst = BB->getTerminator();
+        unsigned int NSucc = TInst->getNumSuccessors();
+        for (unsigned i = 0; i < NSucc; ++i) {
+            BasicBlock *Succ = TInst->getSuccessor(i);
+            if (AnalysisStats *stats = activeStats()) {
+                stats->countEdge(BB, Succ);
+            }
+            bool firstVisit = inVars.find(Succ) == inVars.end();
+            set<Value*> &succVars = inVars[Succ];
+            size_t before = succVars.size();
+            succVars.insert(sinkVars.begin(), sinkVars.end());
+            if (firstVisit || succVars.size() != before)
+                worklist.insert(rpoIndex[Succ]);
+        }
+    }
+
+    // Report in layout order so block numbers follow the IR listing.
+    PhaseTimer timer("print");
+    for (auto &B: F) {
+        BasicBlock *BB = &B;
+        if (outVars.find(BB) == outVars.end())
+            continue;
+        set<Value*> &sinkVars = outVars[BB];
+        cout << "Block " << counter << ": {";
+        for (auto i = sinkVars.begin(); i != sinkVars.end(); ++i) {
+            if((*i)->hasName())
+                cout << (*i)->getName().str().c_str() << ", ";
+        }
+        cout << "}" << endl;
+        ++counter;
+
+        if (BB->getTerminator()->getNumSuccessors() == 0)
+            finalVars.insert(sinkVars.begin(), sinkVars.end());
+    }
+}
@@ -1,6 +1,14 @@
 #include <cstdio>
 #include <iostream>
 #include <set>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <sstream>
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Function.h"
@@ -9,42 +17,254 @@
 #include "llvm/IRReader/IRReader.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/IR/Value.h"
+#include "../common/IRInput.h"
+#include "../common/CFG.h"
+#include "../common/ResultCache.h"
+#include "../common/OutputRedirect.h"
+#include "../common/ResultFormat.h"
+#include "../common/Trace.h"
+#include "../common/Arena.h"
+#include "../common/Stats.h"
+#include "../common/AnalysisTools.h"
+
+// Bump whenever the printed result for the same IR and options changes.
+#define RESULT_VERSION 1
 
 using namespace llvm;
 using namespace std;
 
-void generateCFG(BasicBlock* BB, int &counter, set<Value*> &sourceVars, set<BasicBlock *> &traversalBlocks);
-bool compareSets(set<Value*> a, set<Value*> b);
+namespace taint {
+
+class TaintBits {
+    public:
+        TaintBits() {}
+        explicit TaintBits(unsigned numBits): words((numBits + 63) / 64, 0) {}
+
+        bool test(unsigned i) const
+        {
+            return (words[i / 64] >> (i % 64)) & 1;
+        }
+
+        void set(unsigned i)
+        {
+            words[i / 64] |= uint64_t(1) << (i % 64);
+        }
+
+        void reset(unsigned i)
+        {
+            words[i / 64] &= ~(uint64_t(1) << (i % 64));
+        }
+
+        // A word-wide loop over contiguous storage, left for the compiler to vectorize.
+        bool operator==(const TaintBits &rhs) const
+        {
+            uint64_t diff = 0;
+            for (size_t w = 0; w < words.size(); ++w)
+                diff |= words[w] ^ rhs.words[w];
+            return diff == 0;
+        }
+
+        bool operator!=(const TaintBits &rhs) const
+        {
+            return !(*this == rhs);
+        }
+
+    private:
+        ArenaVector<uint64_t> words;
+};
+
+// An instruction with its name check and operands resolved to dense ids.
+struct TaintInst {
+    const char *opcode;
+    unsigned id;
+    bool isSource;
+    bool isStore;
+    bool storeToSource;
+    ArenaVector<unsigned> operands;
+};
 
-int main(int argc, char **argv)
+// Dense per-function numbering. Ids follow pointer order, so walking the
+// bits visits values in the same order as iterating a set<Value*>.
+struct ValueNumbering {
+    ArenaMap<Value*, unsigned> ids;
+    ArenaVector<Value*> values;
+    ArenaMap<BasicBlock*, ArenaVector<TaintInst>> blocks;
+};
+
+void generateCFG(
+    BasicBlock* BB,
+    int &counter,
+    ArenaSet<Value*> &sourceVars,
+    set<BasicBlock *> &traversalBlocks,
+    const ResultPrinter &printer);
+bool compareSets(ArenaSet<Value*> a, ArenaSet<Value*> b);
+vector<ResultItem> setItems(const ArenaSet<Value*> &vars);
+ValueNumbering numberValues(Function &F);
+void generateCFGBits(
+    BasicBlock* BB,
+    int &counter,
+    TaintBits &sourceBits,
+    set<BasicBlock*> &traversalBlocks,
+    const ValueNumbering &numbering,
+    const ResultPrinter &printer);
+vector<ResultItem> bitsItems(const TaintBits &bits, const ValueNumbering &numbering);
+
+int runLoopAnalysis(int argc, char **argv)
 {
-    // Read the IR file.
-    LLVMContext &Context = getGlobalContext();
+    // Read the IR file, textual or bitcode; "-" reads standard input. The
+    // context is owned by this run, so runs on other threads never share one.
+    LLVMContext Context;
     SMDiagnostic Err;
-    Module *M = ParseIRFile(argv[1], Err, Context);
+    auto parseStart = chrono::steady_clock::now();
+    Module *M = loadModule(argv[1], Err, Context);
+    auto parseTime = chrono::steady_clock::now() - parseStart;
     if (M == nullptr)
     {
         fprintf(stderr, "error: failed to load LLVM IR file \"%s\"", argv[1]);
         return EXIT_FAILURE;
     }
 
-    // tainted variable set
-    set<Value*> sourceVars;
-    set<BasicBlock*> traversalBlocks;
+    // --sets runs the original set<Value*> lattice instead of the bit vectors.
+    // --cache-dir DIR reuses results of unchanged functions from earlier runs.
+    // --format text|jsonl|binary picks how results are written (see
+    // common/ResultFormat.h); text is the default.
+    // --trace off|summary|block|instruction picks how much of the solving is
+    // shown besides the results (see common/Trace.h); block is the default.
+    // --stats reports phase times and solver counters after the results
+    // (see common/Stats.h).
+    traceLevel() = TRACE_DEFAULT;
+    bool useSets = false;
+    bool wantStats = false;
+    ResultCache resultCache("taintLoopAnalysis", RESULT_VERSION);
+    ResultPrinter printer("taintLoopAnalysis");
+    for (int i = 2; i < argc; ++i) {
+        if (strcmp(argv[i], "--sets") == 0) {
+            useSets = true;
+            resultCache.addOption(argv[i]);
+        } else if (strcmp(argv[i], "--cache-dir") == 0 && i + 1 < argc) {
+            if (!resultCache.open(argv[++i])) {
+                fprintf(stderr, "error: cannot create cache directory \"%s\"\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            if (!printer.setFormat(argv[++i])) {
+                fprintf(stderr, "error: unknown format \"%s\"\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+            resultCache.addOption(argv[i - 1]);
+            resultCache.addOption(argv[i]);
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            if (!parseTraceLevel(argv[++i], traceLevel())) {
+                fprintf(stderr, "error: unknown trace level \"%s\"\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+            resultCache.addOption(argv[i - 1]);
+            resultCache.addOption(argv[i]);
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            wantStats = true;
+        } else {
+            fprintf(stderr, "error: unknown option \"%s\"\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // The report comes after all functions, so it never enters the cache.
+    AnalysisStats stats;
+    activeStats() = wantStats ? &stats : nullptr;
+    if (wantStats) {
+        stats.addTime("parse", parseTime);
+    }
+    printer.begin();
+
     int counter = 1;
     for (auto &F: *M)
         if (strncmp(F.getName().str().c_str(), "main", 4) == 0) {
+            // The sets, bit vectors and numbering of F come from one arena
+            // freed at the end of the iteration. Both lattices start every
+            // function untainted, so --sets reports what the bits do.
+            ArenaScope arena;
+            {
+                PhaseTimer timer("parse");
+                if (!materialize(F)) {
+                    return EXIT_FAILURE;
+                }
+            }
+            printer.function = F.getName().str();
+            string key;
+            if (resultCache.enabled()) {
+                key = resultCache.key(F, to_string(counter));
+                string carriedOut, cached;
+                if (resultCache.lookup(key, carriedOut, cached)) {
+                    counter = atoi(carriedOut.c_str());
+                    cout << cached;
+                    continue;
+                }
+            }
+            ostringstream captured;
+            streambuf *uncaptured = nullptr;
+            if (resultCache.enabled()) {
+                uncaptured = redirectOutput(captured.rdbuf());
+            }
+
             BasicBlock* BB = dyn_cast<BasicBlock>(F.begin());
-            cout << "Start collecting the blocks to traverse over..." << endl;
-            generateCFG(BB, counter, sourceVars, traversalBlocks);
+            TRACE(TRACE_SUMMARY, if (printer.text())
+                cout << "Start collecting the blocks to traverse over...\n");
+            int startCount = counter;
+            set<BasicBlock*> traversalBlocks;
+            if (useSets) {
+                ArenaSet<Value*> sourceVars;
+                PhaseTimer timer("solve");
+                generateCFG(BB, counter, sourceVars, traversalBlocks, printer);
+            } else {
+                ValueNumbering numbering;
+                {
+                    PhaseTimer timer("numbering");
+                    numbering = numberValues(F);
+                }
+                TaintBits sourceBits(numbering.values.size());
+                PhaseTimer timer("solve");
+                generateCFGBits(BB, counter, sourceBits, traversalBlocks, numbering, printer);
+            }
+            if (wantStats) {
+                stats.addIterations(F.getName().str(), counter - startCount);
+            }
+
+            if (resultCache.enabled()) {
+                redirectOutput(uncaptured);
+                resultCache.store(key, to_string(counter), captured.str());
+                cout << captured.str();
+            }
         }
+
+    if (resultCache.enabled()) {
+        if (printer.text()) {
+            cout << "Result cache: " << resultCache.hits << " hits, "
+                 << resultCache.misses << " misses\n";
+        } else {
+            vector<ResultItem> items;
+            items.push_back(ResultItem::count("hits", resultCache.hits));
+            items.push_back(ResultItem::count("misses", resultCache.misses));
+            printer.function.clear();
+            printer.write("result-cache", 0, items);
+        }
+    }
+    if (wantStats) {
+        printer.function.clear();
+        stats.print(printer);
+        activeStats() = nullptr;
+    }
     return 0;
 }
 
 
-set<Value*> checkTainted(BasicBlock* BB, set<Value*> sinkVars)
+ArenaSet<Value*> checkTainted(BasicBlock* BB, ArenaSet<Value*> sinkVars)
 {
+    PhaseTimer timer("transfer");
+    AnalysisStats *stats = activeStats();
     for (auto &I: *BB) {
+        if (stats != nullptr) {
+            stats->countOpcode(I.getOpcodeName());
+        }
         if (strncmp(I.getName().str().c_str(), "source", 6) == 0)
             sinkVars.insert(dyn_cast<Value>(&I));
 
@@ -77,12 +297,19 @@ set<Value*> checkTainted(BasicBlock* BB, set<Value*> sinkVars)
 
 
 
-void generateCFG(BasicBlock* BB, int &counter, set<Value*> &sourceVars, set<BasicBlock*> &traversalBlocks)
+void generateCFG(
+    BasicBlock* BB,
+    int &counter,
+    ArenaSet<Value*> &sourceVars,
+    set<BasicBlock*> &traversalBlocks,
+    const ResultPrinter &printer)
 {
 
-    set<Value*> sinkVars = checkTainted(BB, sourceVars);
+    ArenaSet<Value*> sinkVars = checkTainted(BB, sourceVars);
+    countStat("block visits");
 
     if (traversalBlocks.find(BB) != traversalBlocks.end() && compareSets(sinkVars, sourceVars)) {
+        countStat("fixpoint hits");
         return;
     }
 
@@ -90,36 +317,50 @@ void generateCFG(BasicBlock* BB, int &counter, set<Value*> &sourceVars, set<Basi
     traversalBlocks.insert(BB);
 
     // Print out the tainted variables
-    cout << "Block " << counter << ": {";
-    for (auto i = sourceVars.begin(); i != sourceVars.end(); ++i) {
+    TRACE(TRACE_BLOCK,
+        PhaseTimer timer("print");
+        if (printer.text()) {
+            cout << "Block " << counter << ": {";
+            for (auto i = sourceVars.begin(); i != sourceVars.end(); ++i) {
 
-        if((*i)->hasName())
-            cout << (*i)->getName().str().c_str() << ", ";
-    }
-    cout << "}" << endl;
+                if((*i)->hasName())
+                    cout << (*i)->getName().str().c_str() << ", ";
+            }
+            cout << "}\n";
+        } else {
+            printer.write("block", counter, setItems(sourceVars));
+        });
     ++counter;
 
-    const TerminatorInst *TInst = BB->getTerminator();
+    const Terminator *TInst = BB->getTerminator();
     unsigned int NSucc = TInst->getNumSuccessors();
     for (unsigned i = 0; i < NSucc; ++i) {
         BasicBlock *Succ = TInst->getSuccessor(i);
-        generateCFG(Succ, counter, sourceVars, traversalBlocks);
+        if (AnalysisStats *stats = activeStats()) {
+            stats->countEdge(BB, Succ);
+        }
+        generateCFG(Succ, counter, sourceVars, traversalBlocks, printer);
     }
 
     if (NSucc == 0) {
-        cout << "Tainted Variables: {";
-        for (auto i = sourceVars.begin(); i != sourceVars.end(); ++i) {
+        if (printer.text()) {
+            cout << "Tainted Variables: {";
+            for (auto i = sourceVars.begin(); i != sourceVars.end(); ++i) {
 
-            if((*i)->hasName())
-                cout << (*i)->getName().str().c_str() << ", ";
+                if((*i)->hasName())
+                    cout << (*i)->getName().str().c_str() << ", ";
+            }
+            cout << "}\n";
+        } else {
+            printer.write("final", 0, setItems(sourceVars));
         }
-        cout << "}" << endl;
     }
 
 }
 
-bool compareSets(set<Value*> a, set<Value*> b)
+bool compareSets(ArenaSet<Value*> a, ArenaSet<Value*> b)
 {
+    PhaseTimer timer("fixpoint check");
     for (auto e: a) {
         if (b.find(e) == b.end()) return false;
     }
@@ -128,3 +369,162 @@ bool compareSets(set<Value*> a, set<Value*> b)
     else
         return false;
 }
+
+vector<ResultItem> setItems(const ArenaSet<Value*> &vars)
+{
+    vector<ResultItem> items;
+    for (auto v: vars) {
+        if (v->hasName()) {
+            ResultItem item;
+            item.id = resultId(v);
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+ValueNumbering numberValues(Function &F)
+{
+    ValueNumbering numbering;
+    ArenaSet<Value*> seen;
+    for (auto &BB: F) {
+        for (auto &I: BB) {
+            seen.insert(dyn_cast<Value>(&I));
+            for (unsigned x = 0; x < I.getNumOperands(); ++x)
+                seen.insert(I.getOperand(x));
+        }
+    }
+    numbering.values.assign(seen.begin(), seen.end());
+    for (unsigned i = 0; i < numbering.values.size(); ++i)
+        numbering.ids[numbering.values[i]] = i;
+
+    for (auto &BB: F) {
+        ArenaVector<TaintInst> &insts = numbering.blocks[&BB];
+        for (auto &I: BB) {
+            TaintInst inst;
+            inst.opcode = I.getOpcodeName();
+            inst.id = numbering.ids[dyn_cast<Value>(&I)];
+            inst.isSource = strncmp(I.getName().str().c_str(), "source", 6) == 0;
+            inst.isStore = isa<StoreInst>(I);
+            inst.storeToSource = inst.isStore &&
+                strncmp(I.getOperand(1)->getName().str().c_str(), "source", 6) == 0;
+            for (unsigned x = 0; x < I.getNumOperands(); ++x)
+                inst.operands.push_back(numbering.ids[I.getOperand(x)]);
+            insts.push_back(inst);
+        }
+    }
+    return numbering;
+}
+
+void checkTaintedBits(const ArenaVector<TaintInst> &insts, TaintBits &sinkBits)
+{
+    PhaseTimer timer("transfer");
+    AnalysisStats *stats = activeStats();
+    for (auto &inst: insts) {
+        if (stats != nullptr) {
+            stats->countOpcode(inst.opcode);
+        }
+        if (inst.isSource)
+            sinkBits.set(inst.id);
+
+        if (inst.isStore) {
+            // Check store instructions
+            unsigned storeFrom = inst.operands[0];
+            unsigned storeTo = inst.operands[1];
+            if (sinkBits.test(storeFrom))
+                sinkBits.set(storeTo);
+            else if (!inst.storeToSource)
+                sinkBits.reset(storeTo);
+        } else {
+            // Check all other instructions
+            for (auto v: inst.operands) {
+                if (sinkBits.test(v))
+                    sinkBits.set(inst.id);
+            }
+        }
+    }
+}
+
+void printBits(const TaintBits &bits, const ValueNumbering &numbering)
+{
+    for (unsigned i = 0; i < numbering.values.size(); ++i) {
+        Value *v = numbering.values[i];
+        if (bits.test(i) && v->hasName())
+            cout << v->getName().str().c_str() << ", ";
+    }
+}
+
+vector<ResultItem> bitsItems(const TaintBits &bits, const ValueNumbering &numbering)
+{
+    vector<ResultItem> items;
+    for (unsigned i = 0; i < numbering.values.size(); ++i) {
+        Value *v = numbering.values[i];
+        if (bits.test(i) && v->hasName()) {
+            ResultItem item;
+            item.id = resultId(v);
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+void generateCFGBits(
+    BasicBlock* BB,
+    int &counter,
+    TaintBits &sourceBits,
+    set<BasicBlock*> &traversalBlocks,
+    const ValueNumbering &numbering,
+    const ResultPrinter &printer)
+{
+    // numberValues covers every block of the function and successors stay
+    // in it, so this only guards against a block from somewhere else.
+    auto insts = numbering.blocks.find(BB);
+    if (insts == numbering.blocks.end()) {
+        return;
+    }
+    TaintBits sinkBits = sourceBits;
+    checkTaintedBits(insts->second, sinkBits);
+    countStat("block visits");
+
+    if (traversalBlocks.find(BB) != traversalBlocks.end() && sinkBits == sourceBits) {
+        countStat("fixpoint hits");
+        return;
+    }
+
+    sourceBits = sinkBits; // Update the tainted varaiable set
+    traversalBlocks.insert(BB);
+
+    // Print out the tainted variables
+    TRACE(TRACE_BLOCK,
+        PhaseTimer timer("print");
+        if (printer.text()) {
+            cout << "Block " << counter << ": {";
+            printBits(sourceBits, numbering);
+            cout << "}\n";
+        } else {
+            printer.write("block", counter, bitsItems(sourceBits, numbering));
+        });
+    ++counter;
+
+    const Terminator *TInst = BB->getTerminator();
+    unsigned int NSucc = TInst->getNumSuccessors();
+    for (unsigned i = 0; i < NSucc; ++i) {
+        BasicBlock *Succ = TInst->getSuccessor(i);
+        if (AnalysisStats *stats = activeStats()) {
+            stats->countEdge(BB, Succ);
+        }
+        generateCFGBits(Succ, counter, sourceBits, traversalBlocks, numbering, printer);
+    }
+
+    if (NSucc == 0) {
+        if (printer.text()) {
+            cout << "Tainted Variables: {";
+            printBits(sourceBits, numbering);
+            cout << "}\n";
+        } else {
+            printer.write("final", 0, bitsItems(sourceBits, numbering));
+        }
+    }
+}
+
+}
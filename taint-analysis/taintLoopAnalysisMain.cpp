@@ -0,0 +1,7 @@
+#include "../common/AnalysisTools.h"
+
+// The analysis itself is in taintLoopAnalysis.cpp, part of analysiscore.
+int main(int argc, char **argv)
+{
+    return runAnalysisMain(taint::runLoopAnalysis, argc, argv);
+}
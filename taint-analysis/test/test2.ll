@@ -11,24 +11,24 @@ define i32 @main() #0 {
   %sink = alloca i32, align 4
   %source = alloca i32, align 4
   store i32 0, i32* %1
-  %2 = load i32* %a, align 4
+  %2 = load i32, i32* %a, align 4
   %3 = icmp sgt i32 %2, 0
   br i1 %3, label %4, label %6
 
 ; <label>:4                                       ; preds = %0
-  %5 = load i32* %source, align 4
+  %5 = load i32, i32* %source, align 4
   store i32 %5, i32* %b, align 4
   br label %8
 
 ; <label>:6                                       ; preds = %0
-  %7 = load i32* %b, align 4
+  %7 = load i32, i32* %b, align 4
   store i32 %7, i32* %c, align 4
   br label %8
 
 ; <label>:8                                       ; preds = %6, %4
-  %9 = load i32* %c, align 4
+  %9 = load i32, i32* %c, align 4
   store i32 %9, i32* %sink, align 4
-  %10 = load i32* %1
+  %10 = load i32, i32* %1
   ret i32 %10
 }
 
@@ -36,4 +36,4 @@ attributes #0 = { nounwind uwtable "less-precise-fpmad"="false" "no-frame-pointe
 
 !llvm.ident = !{!0}
 
-!0 = metadata !{metadata !"clang version 3.4.2 (tags/RELEASE_34/dot2-final)"}
+!0 = !{!"clang version 3.4.2 (tags/RELEASE_34/dot2-final)"}
@@ -16,35 +16,35 @@ define i32 @main() #0 {
   br label %2
 
 ; <label>:2                                       ; preds = %14, %0
-  %3 = load i32* %i, align 4
-  %4 = load i32* %N, align 4
+  %3 = load i32, i32* %i, align 4
+  %4 = load i32, i32* %N, align 4
   %5 = icmp slt i32 %3, %4
   br i1 %5, label %6, label %17
 
 ; <label>:6                                       ; preds = %2
-  %7 = load i32* %i, align 4
+  %7 = load i32, i32* %i, align 4
   %8 = srem i32 %7, 2
   %9 = icmp eq i32 %8, 0
   br i1 %9, label %10, label %12
 
 ; <label>:10                                      ; preds = %6
-  %11 = load i32* %source, align 4
+  %11 = load i32, i32* %source, align 4
   store i32 %11, i32* %b, align 4
   br label %14
 
 ; <label>:12                                      ; preds = %6
-  %13 = load i32* %b, align 4
+  %13 = load i32, i32* %b, align 4
   store i32 %13, i32* %c, align 4
   br label %14
 
 ; <label>:14                                      ; preds = %12, %10
-  %15 = load i32* %i, align 4
+  %15 = load i32, i32* %i, align 4
   %16 = add nsw i32 %15, 1
   store i32 %16, i32* %i, align 4
   br label %2
 
 ; <label>:17                                      ; preds = %2
-  %18 = load i32* %c, align 4
+  %18 = load i32, i32* %c, align 4
   store i32 %18, i32* %sink, align 4
   ret i32 0
 }
@@ -53,4 +53,4 @@ attributes #0 = { nounwind uwtable "less-precise-fpmad"="false" "no-frame-pointe
 
 !llvm.ident = !{!0}
 
-!0 = metadata !{metadata !"clang version 3.4.2 (tags/RELEASE_34/dot2-final)"}
+!0 = !{!"clang version 3.4.2 (tags/RELEASE_34/dot2-final)"}
@@ -11,17 +11,17 @@ define i32 @main() #0 {
   %source = alloca i32, align 4
   store i32 0, i32* %1
   store i32 2000, i32* %source, align 4
-  %2 = load i32* %source, align 4
+  %2 = load i32, i32* %source, align 4
   store i32 %2, i32* %a, align 4
-  %3 = load i32* %a, align 4
+  %3 = load i32, i32* %a, align 4
   store i32 %3, i32* %b, align 4
-  %4 = load i32* %a, align 4
-  %5 = load i32* %b, align 4
+  %4 = load i32, i32* %a, align 4
+  %5 = load i32, i32* %b, align 4
   %6 = icmp sgt i32 %4, %5
   br i1 %6, label %7, label %10
 
 ; <label>:7                                       ; preds = %0
-  %8 = load i32* %b, align 4
+  %8 = load i32, i32* %b, align 4
   %9 = add nsw i32 %8, 1
   store i32 %9, i32* %b, align 4
   br label %11
@@ -31,9 +31,9 @@ define i32 @main() #0 {
   br label %11
 
 ; <label>:11                                      ; preds = %10, %7
-  %12 = load i32* %b, align 4
+  %12 = load i32, i32* %b, align 4
   store i32 %12, i32* %sink, align 4
-  %13 = load i32* %1
+  %13 = load i32, i32* %1
   ret i32 %13
 }
 
@@ -41,4 +41,4 @@ attributes #0 = { nounwind uwtable "less-precise-fpmad"="false" "no-frame-pointe
 
 !llvm.ident = !{!0}
 
-!0 = metadata !{metadata !"clang version 3.4.2 (tags/RELEASE_34/dot2-final)"}
+!0 = !{!"clang version 3.4.2 (tags/RELEASE_34/dot2-final)"}
@@ -0,0 +1,18 @@
+int main() {
+    int a, b, sink, source;
+    // read source from input
+    b = source;
+    if (a > 0)
+        sink = b;
+    return 0;
+}
+
+int main1() {
+    int a, b, sink;
+    b = a;
+    while (a > 0) {
+        sink = b;
+        a = a - 1;
+    }
+    return 0;
+}
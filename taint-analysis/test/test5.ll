@@ -0,0 +1,55 @@
+; ModuleID = 'test5.c'
+source_filename = "test5.c"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+define dso_local i32 @main() {
+entry:
+  %retval = alloca i32, align 4
+  %a = alloca i32, align 4
+  %b = alloca i32, align 4
+  %sink = alloca i32, align 4
+  %source = alloca i32, align 4
+  store i32 0, i32* %retval, align 4
+  %0 = load i32, i32* %source, align 4
+  store i32 %0, i32* %b, align 4
+  %1 = load i32, i32* %a, align 4
+  %cmp = icmp sgt i32 %1, 0
+  br i1 %cmp, label %if.then, label %if.end
+
+if.then:                                          ; preds = %entry
+  %2 = load i32, i32* %b, align 4
+  store i32 %2, i32* %sink, align 4
+  br label %if.end
+
+if.end:                                           ; preds = %if.then, %entry
+  ret i32 0
+}
+
+define dso_local i32 @main1() {
+entry:
+  %retval = alloca i32, align 4
+  %a = alloca i32, align 4
+  %b = alloca i32, align 4
+  %sink = alloca i32, align 4
+  store i32 0, i32* %retval, align 4
+  %0 = load i32, i32* %a, align 4
+  store i32 %0, i32* %b, align 4
+  br label %while.cond
+
+while.cond:                                       ; preds = %while.body, %entry
+  %1 = load i32, i32* %a, align 4
+  %cmp = icmp sgt i32 %1, 0
+  br i1 %cmp, label %while.body, label %while.end
+
+while.body:                                       ; preds = %while.cond
+  %2 = load i32, i32* %b, align 4
+  store i32 %2, i32* %sink, align 4
+  %3 = load i32, i32* %a, align 4
+  %sub = sub nsw i32 %3, 1
+  store i32 %sub, i32* %a, align 4
+  br label %while.cond
+
+while.end:                                        ; preds = %while.cond
+  ret i32 0
+}
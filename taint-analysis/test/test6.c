@@ -0,0 +1,10 @@
+int main() {
+    int a, b, c, sink, source;
+    // read source from input
+    if (a > 0)
+        b = source;
+    else
+        c = a;
+    sink = b;
+    return 0;
+}
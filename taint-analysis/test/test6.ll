@@ -0,0 +1,33 @@
+; ModuleID = 'test6.c'
+source_filename = "test6.c"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+define dso_local i32 @main() {
+entry:
+  %retval = alloca i32, align 4
+  %a = alloca i32, align 4
+  %b = alloca i32, align 4
+  %c = alloca i32, align 4
+  %sink = alloca i32, align 4
+  %source = alloca i32, align 4
+  store i32 0, i32* %retval, align 4
+  %0 = load i32, i32* %a, align 4
+  %cmp = icmp sgt i32 %0, 0
+  br i1 %cmp, label %if.then, label %if.else
+
+if.then:                                          ; preds = %entry
+  %1 = load i32, i32* %source, align 4
+  store i32 %1, i32* %b, align 4
+  br label %if.end
+
+if.else:                                          ; preds = %entry
+  %2 = load i32, i32* %a, align 4
+  store i32 %2, i32* %c, align 4
+  br label %if.end
+
+if.end:                                           ; preds = %if.else, %if.then
+  %3 = load i32, i32* %b, align 4
+  store i32 %3, i32* %sink, align 4
+  ret i32 0
+}